@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <ltc/vmap.hpp>
+
+// Batched find_many against one find per probe key, for maps of 1K and 1M elements.
+// Larger sizes can be given on the command line, e.g. bench_find_many 100000000.
+
+namespace
+{
+    const size_t probe_count = 100000;
+
+    template <class Fn> double run(Fn fn)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() * 1e9 / probe_count;
+    }
+
+    void bench(size_t size)
+    {
+        using map_t = ltc::vmap<uint64_t, uint64_t>;
+        std::vector<map_t::value_type> values;
+        values.reserve(size);
+        for (uint64_t i = 0; i < size; ++i)
+            values.emplace_back(i * 2, i);
+        const map_t m(ltc::sorted_unique, std::move(values));
+
+        // Half of the probes hit
+        std::mt19937_64 rng(size);
+        std::uniform_int_distribution<uint64_t> dist(0, size * 2 - 1);
+        std::vector<uint64_t> probes(probe_count);
+        for (auto &p : probes)
+            p = dist(rng);
+
+        uint64_t single_sum = 0;
+        const auto single = run([&]() {
+            for (const auto key : probes)
+            {
+                const auto it = m.find(key);
+                if (it != m.end()) single_sum += it->second;
+            }
+        });
+
+        uint64_t batch_sum = 0;
+        const auto batch = run([&]() {
+            std::vector<map_t::value_type> found;
+            m.find_many(probes.begin(), probes.end(), std::back_inserter(found));
+            for (const auto &v : found)
+                batch_sum += v.second;
+        });
+
+        std::cout << size << "\tfind " << single << " ns/key\tfind_many " << batch
+                  << " ns/key\tspeedup " << single / batch << std::endl;
+        // find_many reports each distinct key once
+        if (batch_sum > single_sum) std::cout << "checksum mismatch" << std::endl;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bench(1000);
+    bench(1000000);
+    for (int i = 1; i < argc; ++i)
+        bench(std::strtoull(argv[i], nullptr, 10));
+    return 0;
+}
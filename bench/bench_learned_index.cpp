@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ltc/learned_index.hpp>
+#include <ltc/vset.hpp>
+
+// Learned index lookups against binary search in a vset of uniform, lognormal and clustered
+// keys, for 1M keys. Larger sizes can be given on the command line, e.g.
+// bench_learned_index 100000000.
+
+namespace
+{
+    const size_t probe_count = 1000000;
+
+    template <class Fn> double run(Fn fn)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() * 1e9 / probe_count;
+    }
+
+    std::vector<uint64_t> make_keys(const char *distribution, size_t size, std::mt19937_64 &rng)
+    {
+        std::vector<uint64_t> keys(size);
+        const std::string name = distribution;
+        if (name == "uniform")
+        {
+            std::uniform_int_distribution<uint64_t> dist(0, uint64_t(1) << 48);
+            for (auto &k : keys)
+                k = dist(rng);
+        }
+        else if (name == "lognormal")
+        {
+            std::lognormal_distribution<double> dist(0, 2);
+            for (auto &k : keys)
+                k = uint64_t(dist(rng) * 1e9);
+        }
+        else // 64 dense clusters spread over the key space
+        {
+            for (auto &k : keys)
+                k = (rng() % 64) * (uint64_t(1) << 40) + rng() % (size * 16);
+        }
+        return keys;
+    }
+
+    void bench(const char *distribution, size_t size, size_t epsilon)
+    {
+        std::mt19937_64 rng(size);
+        const auto keys = make_keys(distribution, size, rng);
+        const ltc::vset<uint64_t> s(keys.begin(), keys.end());
+        const ltc::learned_index<uint64_t> index(s, epsilon);
+
+        // Probes are keys of the set, so the model is exercised where it has data
+        std::vector<uint64_t> probes(probe_count);
+        for (auto &p : probes)
+            p = keys[rng() % keys.size()];
+
+        uint64_t binary_sum = 0;
+        const auto binary = run([&]() {
+            for (const auto key : probes)
+                binary_sum += s.lower_bound(key) - s.begin();
+        });
+
+        uint64_t learned_sum = 0;
+        const auto learned = run([&]() {
+            for (const auto key : probes)
+                learned_sum += index.lower_bound(s, key) - s.begin();
+        });
+
+        std::cout << distribution << "\t" << s.size() << "\teps " << epsilon << "\tsegments "
+                  << index.segment_count() << "\tmodel " << index.model_bytes()
+                  << " B\twindow " << index.average_window() << "\tbinary " << binary
+                  << " ns\tlearned " << learned << " ns\tspeedup " << binary / learned
+                  << std::endl;
+        if (binary_sum != learned_sum) std::cout << "checksum mismatch" << std::endl;
+    }
+
+    void bench_all(size_t size)
+    {
+        for (const auto distribution : { "uniform", "lognormal", "clustered" })
+            for (const size_t epsilon : { 16, 64 })
+                bench(distribution, size, epsilon);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bench_all(1000000);
+    for (int i = 1; i < argc; ++i)
+        bench_all(std::strtoull(argv[i], nullptr, 10));
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include <ltc/range.hpp>
+#include <ltc/vmap.hpp>
+
+// Time of a filter | transform | take pipeline against the equivalent hand-written loop,
+// over a std::vector and a vmap. With optimization both should compile to the same loop.
+
+namespace
+{
+    const size_t elements = 1 << 20;
+    const int repeats = 20;
+
+    template <class Fn> double run(Fn fn, uint64_t &result)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+            result += fn();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() * 1e9 / (double(repeats) * elements);
+    }
+
+    void report(const char *name, double hand, double pipeline)
+    {
+        std::cout << name << "\thand-written " << hand << " ns/elem\tpipeline " << pipeline
+                  << " ns/elem\tratio " << pipeline / hand << std::endl;
+    }
+} // namespace
+
+int main()
+{
+    using namespace ltc;
+
+    std::vector<uint64_t> v(elements);
+    std::iota(v.begin(), v.end(), 0);
+    const size_t limit = elements / 4;
+    uint64_t sink = 0;
+
+    const auto odd = [](uint64_t x) { return x % 2 == 1; };
+    const auto square = [](uint64_t x) { return x * x; };
+
+    const auto vector_hand = run(
+        [&]() {
+            uint64_t sum = 0;
+            size_t taken = 0;
+            for (auto x : v)
+            {
+                if (!odd(x)) continue;
+                if (taken++ == limit) break;
+                sum += square(x);
+            }
+            return sum;
+        },
+        sink);
+    const auto vector_pipeline = run(
+        [&]() {
+            uint64_t sum = 0;
+            for (auto x : v | filter(odd) | transform(square) | take(limit))
+                sum += x;
+            return sum;
+        },
+        sink);
+    report("vector", vector_hand, vector_pipeline);
+
+    vmap<uint64_t, uint64_t> m;
+    for (auto x : v)
+        m.insert(std::make_pair(x, x));
+    using value_type = vmap<uint64_t, uint64_t>::value_type;
+    const auto odd_key = [](const value_type &p) { return p.first % 2 == 1; };
+    const auto square_value = [](const value_type &p) { return p.second * p.second; };
+
+    const auto vmap_hand = run(
+        [&]() {
+            uint64_t sum = 0;
+            for (const auto &p : m)
+                if (odd_key(p)) sum += square_value(p);
+            return sum;
+        },
+        sink);
+    const auto vmap_pipeline = run(
+        [&]() {
+            uint64_t sum = 0;
+            for (auto x : m | filter(odd_key) | transform(square_value))
+                sum += x;
+            return sum;
+        },
+        sink);
+    report("vmap", vmap_hand, vmap_pipeline);
+
+    std::cout << "checksum " << sink << std::endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <ltc/sharded_vmap.hpp>
+#include <ltc/vmap.hpp>
+
+// Throughput of a mixed insert/find workload on one mutex-guarded vmap versus a
+// sharded_vmap, for 1 to 64 threads.
+
+namespace
+{
+    const int ops_per_thread = 100000;
+    const uint64_t key_space = 1 << 16;
+
+    template <class Op> double run(int threads, Op op)
+    {
+        std::vector<std::thread> workers;
+        const auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([t, &op]() {
+                std::mt19937_64 rng(t);
+                std::uniform_int_distribution<uint64_t> dist(0, key_space - 1);
+                for (int i = 0; i < ops_per_thread; ++i)
+                    op(dist(rng), i % 4 == 0);
+            });
+        }
+        for (auto &w : workers)
+            w.join();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return threads * ops_per_thread / elapsed.count() / 1e6;
+    }
+} // namespace
+
+int main()
+{
+    std::cout << "threads  locked_vmap(Mops/s)  sharded_vmap<64>(Mops/s)\n";
+    for (int threads = 1; threads <= 64; threads *= 2)
+    {
+        ltc::vmap<uint64_t, uint64_t> locked;
+        std::mutex mutex;
+        const auto locked_rate = run(threads, [&](uint64_t key, bool write) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (write)
+                locked.insert(std::make_pair(key, key));
+            else
+                locked.contains(key);
+        });
+
+        ltc::sharded_vmap<uint64_t, uint64_t, 64> sharded;
+        const auto sharded_rate = run(threads, [&](uint64_t key, bool write) {
+            if (write)
+                sharded.insert(std::make_pair(key, key));
+            else
+                sharded.contains(key);
+        });
+
+        std::cout << threads << "\t " << locked_rate << "\t\t      " << sharded_rate << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <ltc/amap.hpp>
+#include <ltc/btree.hpp>
+#include <ltc/range.hpp>
+#include <ltc/vmap.hpp>
+
+namespace ltc
+{
+    // A sorted map that picks its representation by size. It starts as an amap of N inline
+    // elements, moves to a vmap when a key beyond N is inserted, and to a B+tree once the
+    // vmap holds tree_threshold() elements, where shifting the tail on every insert costs
+    // more than the tree's slower lookups save. It never moves back, except on clear().
+    //
+    // Iterators behave like those of the current representation. A promotion invalidates
+    // all iterators, as a reallocation of a vmap does.
+    template <class Key, class T, class Compare = std::less<Key>, size_t N = 16>
+    class adaptive_map
+    {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = Compare;
+        using small_type = amap<Key, T, N, Compare>;
+        using flat_type = vmap<Key, T, Compare>;
+        using tree_type = basic_btree<Key, T, Compare>;
+
+        enum class layout
+        {
+            inline_array, // amap
+            flat,         // vmap
+            tree          // basic_btree
+        };
+
+        static constexpr size_type default_tree_threshold = 8192;
+        static constexpr size_type default_tree_order = 64;
+
+        // Bidirectional iterator over any of the representations
+        template <bool Const>
+        class basic_iterator
+        : public iterator_facade<basic_iterator<Const>,
+                                 std::bidirectional_iterator_tag,
+                                 std::conditional_t<Const, const value_type &, value_type &>>
+        {
+            friend class adaptive_map;
+            friend iterator_access;
+            template <bool> friend class basic_iterator;
+
+            using element_pointer = std::conditional_t<Const, const value_type *, value_type *>;
+            using tree_iterator = std::conditional_t<Const,
+                                                     typename tree_type::const_iterator,
+                                                     typename tree_type::iterator>;
+
+        public:
+            basic_iterator() = default;
+
+            // iterator converts to const_iterator
+            template <bool C, class = std::enable_if_t<Const && !C>>
+            basic_iterator(const basic_iterator<C> &other)
+            : m_ptr(other.m_ptr), m_tree_it(other.m_tree_it), m_in_tree(other.m_in_tree)
+            {
+            }
+
+        private:
+            explicit basic_iterator(element_pointer ptr) : m_ptr(ptr) {}
+            explicit basic_iterator(tree_iterator it) : m_tree_it(it), m_in_tree(true) {}
+
+            decltype(auto) dereference() const { return m_in_tree ? *m_tree_it : *m_ptr; }
+
+            void increment()
+            {
+                if (m_in_tree)
+                    ++m_tree_it;
+                else
+                    ++m_ptr;
+            }
+
+            void decrement()
+            {
+                if (m_in_tree)
+                    --m_tree_it;
+                else
+                    --m_ptr;
+            }
+
+            bool equal(const basic_iterator &o) const
+            {
+                return m_in_tree ? m_tree_it == o.m_tree_it : m_ptr == o.m_ptr;
+            }
+
+            element_pointer m_ptr = nullptr;
+            tree_iterator m_tree_it;
+            bool m_in_tree = false;
+        };
+
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        // Construction
+        explicit adaptive_map(size_type tree_threshold = default_tree_threshold,
+                              const Compare &comp = Compare())
+        : m_small(comp), m_flat(comp), m_key_comp(comp),
+          m_tree_threshold(std::max<size_type>(tree_threshold, N + 1))
+        {
+        }
+
+        adaptive_map(std::initializer_list<value_type> init,
+                     size_type tree_threshold = default_tree_threshold,
+                     const Compare &comp = Compare())
+        : adaptive_map(tree_threshold, comp)
+        {
+            insert(init.begin(), init.end());
+        }
+
+        template <class InputIt>
+        adaptive_map(InputIt first,
+                     InputIt last,
+                     size_type tree_threshold = default_tree_threshold,
+                     const Compare &comp = Compare())
+        : adaptive_map(tree_threshold, comp)
+        {
+            insert(first, last);
+        }
+
+        adaptive_map(const adaptive_map &other)
+        : m_small(other.m_small), m_flat(other.m_flat),
+          m_tree(other.m_tree ? new tree_type(*other.m_tree) : nullptr), m_layout(other.m_layout),
+          m_key_comp(other.m_key_comp), m_tree_threshold(other.m_tree_threshold)
+        {
+        }
+
+        adaptive_map(adaptive_map &&other)
+        : m_small(other.m_key_comp), m_flat(other.m_key_comp), m_key_comp(other.m_key_comp),
+          m_tree_threshold(other.m_tree_threshold)
+        {
+            swap(other);
+        }
+
+        adaptive_map &operator=(const adaptive_map &other)
+        {
+            if (this != &other)
+            {
+                adaptive_map tmp(other);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        adaptive_map &operator=(adaptive_map &&other)
+        {
+            swap(other);
+            return *this;
+        }
+
+        // Element access
+        mapped_type &at(const key_type &key)
+        {
+            const auto it = find(key);
+            if (it == end()) throw std::out_of_range("key");
+            return it->second;
+        }
+
+        const mapped_type &at(const key_type &key) const
+        {
+            const auto it = find(key);
+            if (it == end()) throw std::out_of_range("key");
+            return it->second;
+        }
+
+        mapped_type &operator[](const key_type &key)
+        {
+            make_room(key);
+            return apply([&](auto &c) -> mapped_type & { return c[key]; });
+        }
+
+        // Iterators
+        iterator begin()
+        {
+            return apply([this](auto &c) { return this->wrap(c, c.begin()); });
+        }
+
+        const_iterator begin() const
+        {
+            return apply([this](const auto &c) { return this->wrap(c, c.begin()); });
+        }
+
+        const_iterator cbegin() const { return begin(); }
+
+        iterator end()
+        {
+            return apply([this](auto &c) { return this->wrap(c, c.end()); });
+        }
+
+        const_iterator end() const
+        {
+            return apply([this](const auto &c) { return this->wrap(c, c.end()); });
+        }
+
+        const_iterator cend() const { return end(); }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        // Capacity
+        bool empty() const { return size() == 0; }
+
+        size_type size() const
+        {
+            return apply([](const auto &c) { return size_type(c.size()); });
+        }
+
+        layout current_layout() const { return m_layout; }
+        size_type inline_capacity() const { return N; }
+        size_type tree_threshold() const { return m_tree_threshold; }
+
+        // Modifiers
+
+        // Removes all elements and returns to the inline representation
+        void clear()
+        {
+            m_small.clear();
+            flat_type(m_key_comp).swap(m_flat);
+            m_tree.reset();
+            m_layout = layout::inline_array;
+        }
+
+        std::pair<iterator, bool> insert(const value_type &value)
+        {
+            return insert(value_type(value));
+        }
+
+        std::pair<iterator, bool> insert(value_type &&value)
+        {
+            make_room(value.first);
+            return apply([&](auto &c) {
+                const auto r = c.insert(std::move(value));
+                return std::make_pair(this->wrap(c, r.first), r.second);
+            });
+        }
+
+        template <class InputIt> void insert(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+                insert(value_type(*first));
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        size_type erase(const key_type &key)
+        {
+            return apply([&](auto &c) { return size_type(c.erase(key)); });
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            switch (m_layout)
+            {
+            case layout::inline_array:
+                return wrap(m_small, m_small.erase(m_small.begin() + offset(m_small, pos)));
+            case layout::flat:
+                return wrap(m_flat, m_flat.erase(m_flat.begin() + offset(m_flat, pos)));
+            default:
+                return wrap(*m_tree, m_tree->erase(pos.m_tree_it));
+            }
+        }
+
+        void swap(adaptive_map &other)
+        {
+            using std::swap;
+            m_small.swap(other.m_small);
+            m_flat.swap(other.m_flat);
+            swap(m_tree, other.m_tree);
+            swap(m_layout, other.m_layout);
+            swap(m_key_comp, other.m_key_comp);
+            swap(m_tree_threshold, other.m_tree_threshold);
+        }
+
+        // Lookup
+        size_type count(const key_type &key) const { return find(key) != end() ? 1 : 0; }
+        bool contains(const key_type &key) const { return count(key) == 1; }
+
+        iterator find(const key_type &key)
+        {
+            return apply([&](auto &c) { return this->wrap(c, c.find(key)); });
+        }
+
+        const_iterator find(const key_type &key) const
+        {
+            return apply([&](const auto &c) { return this->wrap(c, c.find(key)); });
+        }
+
+        iterator lower_bound(const key_type &key)
+        {
+            return apply([&](auto &c) { return this->wrap(c, c.lower_bound(key)); });
+        }
+
+        const_iterator lower_bound(const key_type &key) const
+        {
+            return apply([&](const auto &c) { return this->wrap(c, c.lower_bound(key)); });
+        }
+
+        iterator upper_bound(const key_type &key)
+        {
+            return apply([&](auto &c) { return this->wrap(c, c.upper_bound(key)); });
+        }
+
+        const_iterator upper_bound(const key_type &key) const
+        {
+            return apply([&](const auto &c) { return this->wrap(c, c.upper_bound(key)); });
+        }
+
+        std::pair<iterator, iterator> equal_range(const key_type &key)
+        {
+            return std::make_pair(lower_bound(key), upper_bound(key));
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const
+        {
+            return std::make_pair(lower_bound(key), upper_bound(key));
+        }
+
+        // Observers
+        key_compare key_comp() const { return m_key_comp; }
+
+    private:
+        // Calls fn with the current representation
+        template <class Fn> decltype(auto) apply(Fn fn)
+        {
+            switch (m_layout)
+            {
+            case layout::inline_array:
+                return fn(m_small);
+            case layout::flat:
+                return fn(m_flat);
+            default:
+                return fn(*m_tree);
+            }
+        }
+
+        template <class Fn> decltype(auto) apply(Fn fn) const
+        {
+            switch (m_layout)
+            {
+            case layout::inline_array:
+                return fn(m_small);
+            case layout::flat:
+                return fn(m_flat);
+            default:
+                return fn(static_cast<const tree_type &>(*m_tree));
+            }
+        }
+
+        // Turns an iterator of a representation into one of the map. The arrays are walked
+        // by pointer, so the inline and flat layouts share one iterator state.
+        template <class Flat> static iterator wrap(Flat &c, typename Flat::iterator it)
+        {
+            return iterator(c.data() + (it - c.begin()));
+        }
+
+        template <class Flat>
+        static const_iterator wrap(const Flat &c, typename Flat::const_iterator it)
+        {
+            return const_iterator(c.data() + (it - c.begin()));
+        }
+
+        static iterator wrap(tree_type &, typename tree_type::iterator it) { return iterator(it); }
+
+        static const_iterator wrap(const tree_type &, typename tree_type::const_iterator it)
+        {
+            return const_iterator(it);
+        }
+
+        template <class Flat> static difference_type offset(const Flat &c, const_iterator pos)
+        {
+            return pos.m_ptr - c.data();
+        }
+
+        // Promotes the representation if inserting key would outgrow it
+        void make_room(const key_type &key)
+        {
+            switch (m_layout)
+            {
+            case layout::inline_array:
+                if (m_small.size() == N && !m_small.contains(key)) promote_to_flat();
+                break;
+            case layout::flat:
+                if (m_flat.size() >= m_tree_threshold && !m_flat.contains(key)) promote_to_tree();
+                break;
+            default:
+                break;
+            }
+        }
+
+        void promote_to_flat()
+        {
+            typename flat_type::storage_type storage;
+            storage.reserve(2 * N);
+            storage.assign(std::make_move_iterator(m_small.begin()),
+                           std::make_move_iterator(m_small.end()));
+            m_flat.adopt_sorted(std::move(storage));
+            m_small.clear();
+            m_layout = layout::flat;
+        }
+
+        void promote_to_tree()
+        {
+            std::unique_ptr<tree_type> tree(new tree_type(default_tree_order, m_key_comp));
+            // Keys arrive in order, so every insert lands in the rightmost leaf
+            for (auto &v : m_flat)
+                tree->insert(std::move(v));
+            m_tree = std::move(tree);
+            flat_type(m_key_comp).swap(m_flat);
+            m_layout = layout::tree;
+        }
+
+        small_type m_small;
+        flat_type m_flat;
+        std::unique_ptr<tree_type> m_tree;
+        layout m_layout = layout::inline_array;
+        key_compare m_key_comp;
+        size_type m_tree_threshold;
+    };
+
+    template <class Key, class T, class Compare, size_t N>
+    void swap(adaptive_map<Key, T, Compare, N> &a, adaptive_map<Key, T, Compare, N> &b)
+    {
+        a.swap(b);
+    }
+} // namespace ltc
@@ -5,13 +5,13 @@
 
 namespace ltc
 {
-    template <class Key, class T, size_t N, class Compare = std::less<Key>>
-    class amap : public vmap_base<avector<std::pair<Key, T>, N>, Compare>
+    template <class Key, class T, size_t N, class Compare = std::less<Key>, class Stats = no_stats>
+    class amap : public vmap_base<avector<std::pair<Key, T>, N>, Compare, Stats>
     {
+    public:
         using storage_type = avector<std::pair<Key, T>, N>;
-        using base_type = vmap_base<storage_type, Compare>;
+        using base_type = vmap_base<storage_type, Compare, Stats>;
 
-    public:
         amap() : base_type() {}
 
         explicit amap(const Compare &comp) : base_type(comp) {}
@@ -31,6 +31,17 @@ namespace ltc
         {
         }
 
+        amap(sorted_unique_t, storage_type &&storage, const Compare &comp = Compare())
+        : base_type(sorted_unique, comp, std::move(storage))
+        {
+        }
+
+        template <class InputIt>
+        amap(sorted_unique_t, InputIt first, InputIt last, const Compare &comp = Compare())
+        : base_type(sorted_unique, comp, storage_type(first, last))
+        {
+        }
+
         amap &operator=(const amap &other)
         {
             *(static_cast<base_type *>(this)) = other;
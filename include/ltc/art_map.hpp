@@ -0,0 +1,980 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <ltc/radix_sort.hpp>
+#include <ltc/range.hpp>
+
+namespace ltc
+{
+    // Describes keys an art_map can hold, as byte strings that compare like the keys do
+    // under std::less. Integers and std::string qualify.
+    template <class Key, class = void> struct art_key_traits
+    {
+        static constexpr bool enabled = false;
+    };
+
+    // Integers are stored big endian after the sign flip of radix_key_traits
+    template <class Key>
+    struct art_key_traits<Key,
+                          std::enable_if_t<std::is_integral<Key>::value &&
+                                           !std::is_same<Key, bool>::value>>
+    {
+        static constexpr bool enabled = true;
+
+        class bytes
+        {
+        public:
+            explicit bytes(Key key)
+            {
+                auto bits = radix_key_traits<Key, std::less<Key>>::bits(key);
+                for (std::size_t i = sizeof(Key); i-- > 0; bits = bits >> 8)
+                    m_bytes[i] = static_cast<unsigned char>(bits & 0xff);
+            }
+
+            const unsigned char *data() const { return m_bytes; }
+            std::size_t size() const { return sizeof(Key); }
+
+        private:
+            unsigned char m_bytes[sizeof(Key)];
+        };
+    };
+
+    template <> struct art_key_traits<std::string>
+    {
+        static constexpr bool enabled = true;
+
+        class bytes
+        {
+        public:
+            explicit bytes(const std::string &key) : m_key(&key) {}
+
+            const unsigned char *data() const
+            {
+                return reinterpret_cast<const unsigned char *>(m_key->data());
+            }
+            std::size_t size() const { return m_key->size(); }
+
+        private:
+            const std::string *m_key;
+        };
+    };
+
+    // An ordered map on an adaptive radix tree. Lookups walk the key a byte at a time, so
+    // they take O(key length) regardless of size and never compare whole keys on the way
+    // down. Inner nodes grow from 4 to 16, 48 and 256 children as they fill and shrink
+    // back as they empty, and store the bytes their children share as a prefix. Leaves
+    // hold the values and form a list in key order, so iteration is a list walk and
+    // iterators and references stay valid until their element is erased.
+    //
+    // Keys are integers or std::string, ordered as std::less orders them.
+    template <class Key, class T> class art_map
+    {
+        static_assert(art_key_traits<Key>::enabled, "art_map keys are integers or std::string");
+        using bytes = typename art_key_traits<Key>::bytes;
+
+        enum class kind : uint8_t
+        {
+            leaf,
+            node4,
+            node16,
+            node48,
+            node256
+        };
+
+        struct node
+        {
+            explicit node(kind k) : type(k) {}
+            kind type;
+        };
+
+        struct inner;
+
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<const Key, T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+
+    private:
+        struct leaf : node
+        {
+            template <class... Args>
+            explicit leaf(Args &&... args) : node(kind::leaf), value(std::forward<Args>(args)...)
+            {
+            }
+            value_type value;
+            leaf *prev = nullptr;
+            leaf *next = nullptr;
+        };
+
+    public:
+        template <bool Const>
+        class basic_iterator final
+        : public iterator_facade<basic_iterator<Const>,
+                                 std::bidirectional_iterator_tag,
+                                 std::conditional_t<Const, const value_type &, value_type &>>
+        {
+            friend class art_map;
+            friend iterator_access;
+
+        public:
+            basic_iterator() = default;
+            // A mutable iterator converts to a const one
+            template <bool C, class = std::enable_if_t<Const && !C>>
+            basic_iterator(const basic_iterator<C> &other)
+            : m_map(other.m_map), m_leaf(other.m_leaf)
+            {
+            }
+
+        private:
+            template <bool> friend class basic_iterator;
+
+            basic_iterator(const art_map *map, leaf *l) : m_map(map), m_leaf(l) {}
+
+            std::conditional_t<Const, const value_type &, value_type &> dereference() const
+            {
+                return m_leaf->value;
+            }
+            void increment() { m_leaf = m_leaf->next; }
+            void decrement() { m_leaf = m_leaf ? m_leaf->prev : m_map->m_tail; }
+            bool equal(const basic_iterator &o) const { return m_leaf == o.m_leaf; }
+
+            const art_map *m_map = nullptr;
+            leaf *m_leaf = nullptr;
+        };
+
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+        // Construction
+        art_map() = default;
+
+        art_map(std::initializer_list<value_type> init) : art_map(init.begin(), init.end()) {}
+
+        // Later duplicates of a key are ignored
+        template <class InputIt> art_map(InputIt first, InputIt last) { insert(first, last); }
+
+        art_map(const art_map &other) { insert(other.begin(), other.end()); }
+
+        art_map(art_map &&other) noexcept { swap(other); }
+
+        art_map &operator=(art_map other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~art_map() { clear(); }
+
+        // Iterators
+        iterator begin() { return iterator(this, m_head); }
+        const_iterator begin() const { return const_iterator(this, m_head); }
+        const_iterator cbegin() const { return begin(); }
+        iterator end() { return iterator(this, nullptr); }
+        const_iterator end() const { return const_iterator(this, nullptr); }
+        const_iterator cend() const { return end(); }
+
+        // Capacity
+        bool empty() const { return m_size == 0; }
+        size_type size() const { return m_size; }
+
+        // Modifiers
+        void clear()
+        {
+            destroy(m_root);
+            m_root = nullptr;
+            while (m_head)
+                delete std::exchange(m_head, m_head->next);
+            m_tail = nullptr;
+            m_size = 0;
+        }
+
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(const key_type &key, Args &&... args)
+        {
+            const bytes k(key);
+            leaf *next = lower_bound_leaf(k);
+            if (next && equal_key(next, k)) return std::make_pair(iterator(this, next), false);
+            std::unique_ptr<leaf> l(new leaf(std::piecewise_construct, std::forward_as_tuple(key),
+                                             std::forward_as_tuple(std::forward<Args>(args)...)));
+            attach(l.get());
+            link(l.get(), next);
+            ++m_size;
+            return std::make_pair(iterator(this, l.release()), true);
+        }
+
+        std::pair<iterator, bool> insert(const value_type &value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type &&value)
+        {
+            return try_emplace(value.first, std::move(value.second));
+        }
+
+        template <class InputIt> void insert(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+                insert(*first);
+        }
+
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        template <class M> std::pair<iterator, bool> insert_or_assign(const key_type &key, M &&obj)
+        {
+            auto r = try_emplace(key, std::forward<M>(obj));
+            if (!r.second) r.first->second = std::forward<M>(obj);
+            return r;
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            leaf *next = pos.m_leaf->next;
+            erase(pos->first);
+            return iterator(this, next);
+        }
+
+        size_type erase(const key_type &key)
+        {
+            const bytes k(key);
+            leaf *l = detach(m_root, k, 0);
+            if (!l) return 0;
+            (l->prev ? l->prev->next : m_head) = l->next;
+            (l->next ? l->next->prev : m_tail) = l->prev;
+            delete l;
+            --m_size;
+            return 1;
+        }
+
+        void swap(art_map &other) noexcept
+        {
+            std::swap(m_root, other.m_root);
+            std::swap(m_head, other.m_head);
+            std::swap(m_tail, other.m_tail);
+            std::swap(m_size, other.m_size);
+        }
+
+        // Element access
+        mapped_type &at(const key_type &key)
+        {
+            const auto it = find(key);
+            if (it == end()) throw std::out_of_range("key");
+            return it->second;
+        }
+
+        const mapped_type &at(const key_type &key) const
+        {
+            const auto it = find(key);
+            if (it == end()) throw std::out_of_range("key");
+            return it->second;
+        }
+
+        mapped_type &operator[](const key_type &key) { return try_emplace(key).first->second; }
+
+        // Lookup
+        size_type count(const key_type &key) const { return contains(key) ? 1 : 0; }
+        bool contains(const key_type &key) const { return find_leaf(bytes(key)) != nullptr; }
+
+        iterator find(const key_type &key) { return iterator(this, find_leaf(bytes(key))); }
+        const_iterator find(const key_type &key) const
+        {
+            return const_iterator(this, find_leaf(bytes(key)));
+        }
+
+        iterator lower_bound(const key_type &key)
+        {
+            return iterator(this, lower_bound_leaf(bytes(key)));
+        }
+        const_iterator lower_bound(const key_type &key) const
+        {
+            return const_iterator(this, lower_bound_leaf(bytes(key)));
+        }
+
+        iterator upper_bound(const key_type &key)
+        {
+            return iterator(this, upper_bound_leaf(bytes(key)));
+        }
+        const_iterator upper_bound(const key_type &key) const
+        {
+            return const_iterator(this, upper_bound_leaf(bytes(key)));
+        }
+
+        std::pair<iterator, iterator> equal_range(const key_type &key)
+        {
+            return std::make_pair(lower_bound(key), upper_bound(key));
+        }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const
+        {
+            return std::make_pair(lower_bound(key), upper_bound(key));
+        }
+
+        // The elements whose keys start with prefix, found by walking the prefix and taking
+        // the subtree below it
+        template <class K = Key, class = std::enable_if_t<std::is_same<K, std::string>::value>>
+        std::pair<iterator, iterator> prefix_range(const std::string &prefix)
+        {
+            const auto r = prefix_leaves(bytes(prefix));
+            return std::make_pair(iterator(this, r.first), iterator(this, r.second));
+        }
+
+        template <class K = Key, class = std::enable_if_t<std::is_same<K, std::string>::value>>
+        std::pair<const_iterator, const_iterator> prefix_range(const std::string &prefix) const
+        {
+            const auto r = prefix_leaves(bytes(prefix));
+            return std::make_pair(const_iterator(this, r.first), const_iterator(this, r.second));
+        }
+
+    private:
+        // Inner nodes. value is the leaf whose key ends at this node, if any.
+        struct inner : node
+        {
+            using node::node;
+            std::string prefix;
+            leaf *value = nullptr;
+            uint16_t count = 0;
+        };
+
+        struct node4 : inner
+        {
+            node4() : inner(kind::node4) {}
+            unsigned char keys[4] = {};
+            node *children[4] = {};
+        };
+
+        struct node16 : inner
+        {
+            node16() : inner(kind::node16) {}
+            unsigned char keys[16] = {};
+            node *children[16] = {};
+        };
+
+        struct node48 : inner
+        {
+            node48() : inner(kind::node48) {}
+            unsigned char index[256] = {}; // slot + 1 of each byte's child, 0 for none
+            node *children[48] = {};
+        };
+
+        struct node256 : inner
+        {
+            node256() : inner(kind::node256) {}
+            node *children[256] = {};
+        };
+
+        // Nodes shrink to the next smaller kind at these counts
+        static constexpr uint16_t node16_min = 3;
+        static constexpr uint16_t node48_min = 12;
+        static constexpr uint16_t node256_min = 36;
+
+        static int compare(const unsigned char *a, std::size_t an, const bytes &b)
+        {
+            const auto n = an < b.size() ? an : b.size();
+            const int r = n ? std::memcmp(a, b.data(), n) : 0;
+            if (r != 0) return r;
+            return an < b.size() ? -1 : an > b.size() ? 1 : 0;
+        }
+
+        static int compare(const leaf *l, const bytes &b)
+        {
+            const bytes a(l->value.first);
+            return compare(a.data(), a.size(), b);
+        }
+
+        static bool equal_key(const leaf *l, const bytes &b) { return compare(l, b) == 0; }
+
+        // The number of bytes of prefix that match k from depth
+        static std::size_t match(const std::string &prefix, const bytes &k, std::size_t depth)
+        {
+            std::size_t m = 0;
+            while (m < prefix.size() && depth + m < k.size() &&
+                   static_cast<unsigned char>(prefix[m]) == k.data()[depth + m])
+                ++m;
+            return m;
+        }
+
+        static unsigned lowest_bit(unsigned mask)
+        {
+#if defined(__GNUC__)
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+            unsigned i = 0;
+            for (; !(mask & 1); mask >>= 1)
+                ++i;
+            return i;
+#endif
+        }
+
+        static node **find_child(inner *in, unsigned char c)
+        {
+            switch (in->type)
+            {
+            case kind::node4:
+            {
+                auto *n = static_cast<node4 *>(in);
+                for (unsigned i = 0; i < n->count; ++i)
+                    if (n->keys[i] == c) return &n->children[i];
+                return nullptr;
+            }
+            case kind::node16:
+            {
+                auto *n = static_cast<node16 *>(in);
+#if defined(__SSE2__) || defined(_M_X64)
+                // Compares all 16 keys at once
+                const auto keys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(n->keys));
+                const auto eq = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(c)), keys);
+                const auto mask =
+                    static_cast<unsigned>(_mm_movemask_epi8(eq)) & ((1u << n->count) - 1);
+                return mask ? &n->children[lowest_bit(mask)] : nullptr;
+#else
+                for (unsigned i = 0; i < n->count; ++i)
+                    if (n->keys[i] == c) return &n->children[i];
+                return nullptr;
+#endif
+            }
+            case kind::node48:
+            {
+                auto *n = static_cast<node48 *>(in);
+                return n->index[c] ? &n->children[n->index[c] - 1] : nullptr;
+            }
+            default:
+            {
+                auto *n = static_cast<node256 *>(in);
+                return n->children[c] ? &n->children[c] : nullptr;
+            }
+            }
+        }
+
+        // The child with the smallest byte of at least from, or null. Sets byte to its byte.
+        static node *child_from(const inner *in, unsigned from, unsigned char &byte)
+        {
+            const auto sorted = [&](const unsigned char *keys, node *const *children) -> node * {
+                for (unsigned i = 0; i < in->count; ++i)
+                    if (keys[i] >= from)
+                    {
+                        byte = keys[i];
+                        return children[i];
+                    }
+                return nullptr;
+            };
+            switch (in->type)
+            {
+            case kind::node4:
+            {
+                auto *n = static_cast<const node4 *>(in);
+                return sorted(n->keys, n->children);
+            }
+            case kind::node16:
+            {
+                auto *n = static_cast<const node16 *>(in);
+                return sorted(n->keys, n->children);
+            }
+            case kind::node48:
+            {
+                auto *n = static_cast<const node48 *>(in);
+                for (unsigned b = from; b < 256; ++b)
+                    if (n->index[b])
+                    {
+                        byte = static_cast<unsigned char>(b);
+                        return n->children[n->index[b] - 1];
+                    }
+                return nullptr;
+            }
+            default:
+            {
+                auto *n = static_cast<const node256 *>(in);
+                for (unsigned b = from; b < 256; ++b)
+                    if (n->children[b])
+                    {
+                        byte = static_cast<unsigned char>(b);
+                        return n->children[b];
+                    }
+                return nullptr;
+            }
+            }
+        }
+
+        static node *last_child(const inner *in)
+        {
+            switch (in->type)
+            {
+            case kind::node4:
+                return in->count ? static_cast<const node4 *>(in)->children[in->count - 1]
+                                 : nullptr;
+            case kind::node16:
+                return in->count ? static_cast<const node16 *>(in)->children[in->count - 1]
+                                 : nullptr;
+            case kind::node48:
+            {
+                auto *n = static_cast<const node48 *>(in);
+                for (unsigned b = 256; b-- > 0;)
+                    if (n->index[b]) return n->children[n->index[b] - 1];
+                return nullptr;
+            }
+            default:
+            {
+                auto *n = static_cast<const node256 *>(in);
+                for (unsigned b = 256; b-- > 0;)
+                    if (n->children[b]) return n->children[b];
+                return nullptr;
+            }
+            }
+        }
+
+        // A key ending at a node is a prefix of, and so smaller than, every key below it
+        static leaf *min_leaf(node *n)
+        {
+            while (n->type != kind::leaf)
+            {
+                auto *in = static_cast<inner *>(n);
+                if (in->value) return in->value;
+                unsigned char byte;
+                n = child_from(in, 0, byte);
+            }
+            return static_cast<leaf *>(n);
+        }
+
+        static leaf *max_leaf(node *n)
+        {
+            while (n->type != kind::leaf)
+            {
+                auto *in = static_cast<inner *>(n);
+                node *last = last_child(in);
+                if (!last) return in->value;
+                n = last;
+            }
+            return static_cast<leaf *>(n);
+        }
+
+        template <class N> static void insert_sorted(N *n, unsigned char c, node *child)
+        {
+            unsigned i = n->count;
+            for (; i > 0 && n->keys[i - 1] > c; --i)
+            {
+                n->keys[i] = n->keys[i - 1];
+                n->children[i] = n->children[i - 1];
+            }
+            n->keys[i] = c;
+            n->children[i] = child;
+            ++n->count;
+        }
+
+        template <class N> static void erase_sorted(N *n, unsigned char c)
+        {
+            unsigned i = 0;
+            while (n->keys[i] != c)
+                ++i;
+            for (--n->count; i < n->count; ++i)
+            {
+                n->keys[i] = n->keys[i + 1];
+                n->children[i] = n->children[i + 1];
+            }
+            n->children[n->count] = nullptr;
+        }
+
+        // Moves the prefix, value and count of from into to, which replaces it at ref
+        static void replace(node *&ref, inner *from, inner *to)
+        {
+            to->prefix.swap(from->prefix);
+            to->value = from->value;
+            to->count = from->count;
+            destroy_node(from);
+            ref = to;
+        }
+
+        // Adds child under byte c to the inner node at ref, growing it when it is full
+        static void add_child(node *&ref, unsigned char c, node *child)
+        {
+            switch (ref->type)
+            {
+            case kind::node4:
+            {
+                auto *n = static_cast<node4 *>(ref);
+                if (n->count < 4) return insert_sorted(n, c, child);
+                auto *grown = new node16();
+                std::copy(n->keys, n->keys + 4, grown->keys);
+                std::copy(n->children, n->children + 4, grown->children);
+                replace(ref, n, grown);
+                return insert_sorted(grown, c, child);
+            }
+            case kind::node16:
+            {
+                auto *n = static_cast<node16 *>(ref);
+                if (n->count < 16) return insert_sorted(n, c, child);
+                auto *grown = new node48();
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    grown->index[n->keys[i]] = static_cast<unsigned char>(i + 1);
+                    grown->children[i] = n->children[i];
+                }
+                replace(ref, n, grown);
+                return add_child(ref, c, child);
+            }
+            case kind::node48:
+            {
+                auto *n = static_cast<node48 *>(ref);
+                if (n->count < 48)
+                {
+                    unsigned slot = 0;
+                    while (n->children[slot])
+                        ++slot;
+                    n->children[slot] = child;
+                    n->index[c] = static_cast<unsigned char>(slot + 1);
+                    ++n->count;
+                    return;
+                }
+                auto *grown = new node256();
+                for (unsigned b = 0; b < 256; ++b)
+                    if (n->index[b]) grown->children[b] = n->children[n->index[b] - 1];
+                replace(ref, n, grown);
+                return add_child(ref, c, child);
+            }
+            default:
+            {
+                auto *n = static_cast<node256 *>(ref);
+                n->children[c] = child;
+                ++n->count;
+            }
+            }
+        }
+
+        // Removes the child under byte c from the inner node at ref, shrinking it when it
+        // has few children left
+        static void remove_child(node *&ref, unsigned char c)
+        {
+            switch (ref->type)
+            {
+            case kind::node4:
+                return erase_sorted(static_cast<node4 *>(ref), c);
+            case kind::node16:
+            {
+                auto *n = static_cast<node16 *>(ref);
+                erase_sorted(n, c);
+                if (n->count > node16_min) return;
+                auto *shrunk = new node4();
+                std::copy(n->keys, n->keys + n->count, shrunk->keys);
+                std::copy(n->children, n->children + n->count, shrunk->children);
+                return replace(ref, n, shrunk);
+            }
+            case kind::node48:
+            {
+                auto *n = static_cast<node48 *>(ref);
+                n->children[n->index[c] - 1] = nullptr;
+                n->index[c] = 0;
+                if (--n->count > node48_min) return;
+                auto *shrunk = new node16();
+                for (unsigned b = 0, i = 0; b < 256; ++b)
+                    if (n->index[b])
+                    {
+                        shrunk->keys[i] = static_cast<unsigned char>(b);
+                        shrunk->children[i++] = n->children[n->index[b] - 1];
+                    }
+                return replace(ref, n, shrunk);
+            }
+            default:
+            {
+                auto *n = static_cast<node256 *>(ref);
+                n->children[c] = nullptr;
+                if (--n->count > node256_min) return;
+                auto *shrunk = new node48();
+                for (unsigned b = 0, slot = 0; b < 256; ++b)
+                    if (n->children[b])
+                    {
+                        shrunk->children[slot] = n->children[b];
+                        shrunk->index[b] = static_cast<unsigned char>(++slot);
+                    }
+                return replace(ref, n, shrunk);
+            }
+            }
+        }
+
+        static void destroy_node(inner *in)
+        {
+            switch (in->type)
+            {
+            case kind::node4:
+                delete static_cast<node4 *>(in);
+                break;
+            case kind::node16:
+                delete static_cast<node16 *>(in);
+                break;
+            case kind::node48:
+                delete static_cast<node48 *>(in);
+                break;
+            default:
+                delete static_cast<node256 *>(in);
+            }
+        }
+
+        // Frees the inner nodes below n; leaves are freed through the list
+        static void destroy(node *n)
+        {
+            if (!n || n->type == kind::leaf) return;
+            auto *in = static_cast<inner *>(n);
+            unsigned char byte;
+            for (node *child = child_from(in, 0, byte); child;
+                 child = byte < 255 ? child_from(in, byte + 1u, byte) : nullptr)
+                destroy(child);
+            destroy_node(in);
+        }
+
+        // Puts l, whose key has depth bytes matched, under the new node n
+        static void place(node *&n, leaf *l, const bytes &k, std::size_t depth)
+        {
+            if (k.size() == depth)
+                static_cast<inner *>(n)->value = l;
+            else
+                add_child(n, k.data()[depth], l);
+        }
+
+        // Adds l to the tree; its key must not be present
+        void attach(leaf *l)
+        {
+            const bytes k(l->value.first);
+            node **ref = &m_root;
+            std::size_t depth = 0;
+            for (;;)
+            {
+                node *n = *ref;
+                if (!n)
+                {
+                    *ref = l;
+                    return;
+                }
+                if (n->type == kind::leaf)
+                {
+                    // Two keys below one node, which holds the bytes they share
+                    auto *other = static_cast<leaf *>(n);
+                    const bytes o(other->value.first);
+                    auto d = depth;
+                    while (d < k.size() && d < o.size() && k.data()[d] == o.data()[d])
+                        ++d;
+                    node *split = new node4();
+                    static_cast<inner *>(split)->prefix.assign(
+                        reinterpret_cast<const char *>(k.data()) + depth, d - depth);
+                    place(split, other, o, d);
+                    place(split, l, k, d);
+                    *ref = split;
+                    return;
+                }
+                auto *in = static_cast<inner *>(n);
+                const auto m = match(in->prefix, k, depth);
+                if (m < in->prefix.size())
+                {
+                    // The key leaves the prefix at m, which splits the node there
+                    auto *split = new node4();
+                    split->prefix = in->prefix.substr(0, m);
+                    const auto c = static_cast<unsigned char>(in->prefix[m]);
+                    in->prefix.erase(0, m + 1);
+                    node *s = split;
+                    add_child(s, c, in);
+                    place(s, l, k, depth + m);
+                    *ref = s;
+                    return;
+                }
+                depth += m;
+                if (depth == k.size())
+                {
+                    in->value = l;
+                    return;
+                }
+                if (node **child = find_child(in, k.data()[depth]))
+                {
+                    ref = child;
+                    ++depth;
+                    continue;
+                }
+                add_child(*ref, k.data()[depth], l);
+                return;
+            }
+        }
+
+        // Links l into the list before next, or last when next is null
+        void link(leaf *l, leaf *next)
+        {
+            l->next = next;
+            l->prev = next ? next->prev : m_tail;
+            (l->prev ? l->prev->next : m_head) = l;
+            (next ? next->prev : m_tail) = l;
+        }
+
+        // Removes the leaf of k below ref and returns it, or null if k is not present
+        static leaf *detach(node *&ref, const bytes &k, std::size_t depth)
+        {
+            node *n = ref;
+            if (!n) return nullptr;
+            if (n->type == kind::leaf)
+            {
+                auto *l = static_cast<leaf *>(n);
+                if (!equal_key(l, k)) return nullptr;
+                ref = nullptr;
+                return l;
+            }
+            auto *in = static_cast<inner *>(n);
+            if (match(in->prefix, k, depth) < in->prefix.size()) return nullptr;
+            depth += in->prefix.size();
+            leaf *found = nullptr;
+            if (depth == k.size())
+            {
+                found = std::exchange(in->value, nullptr);
+            }
+            else
+            {
+                const auto c = k.data()[depth];
+                node **child = find_child(in, c);
+                if (!child) return nullptr;
+                found = detach(*child, k, depth + 1);
+                if (found && !*child) remove_child(ref, c);
+            }
+            if (found) collapse(ref);
+            return found;
+        }
+
+        // Replaces an inner node left with one entry by that entry
+        static void collapse(node *&ref)
+        {
+            auto *in = static_cast<inner *>(ref);
+            if (in->count == 0)
+            {
+                ref = in->value;
+                destroy_node(in);
+            }
+            else if (in->count == 1 && !in->value)
+            {
+                unsigned char byte;
+                node *child = child_from(in, 0, byte);
+                if (child->type != kind::leaf)
+                {
+                    auto *below = static_cast<inner *>(child);
+                    std::string prefix = in->prefix;
+                    prefix += static_cast<char>(byte);
+                    prefix += below->prefix;
+                    below->prefix.swap(prefix);
+                }
+                ref = child;
+                destroy_node(in);
+            }
+        }
+
+        leaf *find_leaf(const bytes &k) const
+        {
+            node *n = m_root;
+            std::size_t depth = 0;
+            while (n)
+            {
+                if (n->type == kind::leaf)
+                {
+                    auto *l = static_cast<leaf *>(n);
+                    return equal_key(l, k) ? l : nullptr;
+                }
+                auto *in = static_cast<inner *>(n);
+                if (match(in->prefix, k, depth) < in->prefix.size()) return nullptr;
+                depth += in->prefix.size();
+                if (depth == k.size()) return in->value;
+                node **child = find_child(in, k.data()[depth++]);
+                n = child ? *child : nullptr;
+            }
+            return nullptr;
+        }
+
+        // Once a subtree is known to hold only keys smaller than k, the answer is the leaf
+        // after its largest
+        leaf *lower_bound_leaf(const bytes &k) const
+        {
+            node *n = m_root;
+            std::size_t depth = 0;
+            while (n)
+            {
+                if (n->type == kind::leaf)
+                {
+                    auto *l = static_cast<leaf *>(n);
+                    return compare(l, k) >= 0 ? l : l->next;
+                }
+                auto *in = static_cast<inner *>(n);
+                const auto m = match(in->prefix, k, depth);
+                if (m < in->prefix.size())
+                {
+                    const bool greater =
+                        depth + m == k.size() ||
+                        static_cast<unsigned char>(in->prefix[m]) > k.data()[depth + m];
+                    return greater ? min_leaf(in) : max_leaf(in)->next;
+                }
+                depth += m;
+                if (depth == k.size()) return min_leaf(in);
+                const auto c = k.data()[depth++];
+                if (node **child = find_child(in, c))
+                {
+                    n = *child;
+                    continue;
+                }
+                unsigned char byte;
+                node *after = c < 255 ? child_from(in, c + 1u, byte) : nullptr;
+                return after ? min_leaf(after) : max_leaf(in)->next;
+            }
+            return nullptr;
+        }
+
+        leaf *upper_bound_leaf(const bytes &k) const
+        {
+            leaf *l = lower_bound_leaf(k);
+            return l && equal_key(l, k) ? l->next : l;
+        }
+
+        std::pair<leaf *, leaf *> prefix_leaves(const bytes &p) const
+        {
+            node *n = m_root;
+            std::size_t depth = 0;
+            while (n)
+            {
+                if (n->type == kind::leaf)
+                {
+                    auto *l = static_cast<leaf *>(n);
+                    const bytes k(l->value.first);
+                    if (k.size() >= p.size() && std::memcmp(k.data(), p.data(), p.size()) == 0)
+                        return std::make_pair(l, l->next);
+                    break;
+                }
+                auto *in = static_cast<inner *>(n);
+                const auto m = match(in->prefix, p, depth);
+                // Every key below a node whose path covers the prefix starts with it
+                if (depth + m == p.size()) return std::make_pair(min_leaf(in), max_leaf(in)->next);
+                if (m < in->prefix.size()) break;
+                depth += m;
+                node **child = find_child(in, p.data()[depth++]);
+                n = child ? *child : nullptr;
+            }
+            leaf *l = lower_bound_leaf(p);
+            return std::make_pair(l, l);
+        }
+
+        node *m_root = nullptr;
+        leaf *m_head = nullptr;
+        leaf *m_tail = nullptr;
+        size_type m_size = 0;
+    };
+
+    template <class Key, class T> void swap(art_map<Key, T> &a, art_map<Key, T> &b) noexcept
+    {
+        a.swap(b);
+    }
+} // namespace ltc
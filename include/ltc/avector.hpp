@@ -4,13 +4,23 @@
 #include <array>
 #include <assert.h>
 #include <cstddef>
+#include <cstring>
 #include <functional>
 #include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <ltc/stats.hpp>
 
 namespace ltc
 {
 
-    template <typename T, size_t N> class avector
+    // A vector with a fixed capacity of N inline elements, like a static_vector. The storage
+    // never reallocates; growing past N throws std::length_error, or fails quietly through
+    // the try_ functions. Stats is a compile-time stats policy, see stats.hpp.
+    template <typename T, size_t N, class Stats = no_stats>
+    class avector : public stats_holder<Stats>
     {
     public:
         using size_type = typename std::array<T, N>::size_type;
@@ -37,7 +47,7 @@ namespace ltc
             m_end = std::move(init.begin(), init.end(), m_storage.begin());
         }
 
-        avector(const avector &other) : m_storage(other.m_storage)
+        avector(const avector &other) : stats_holder<Stats>(other), m_storage(other.m_storage)
         {
             m_end = begin() + other.size();
         }
@@ -67,6 +77,10 @@ namespace ltc
             return *this;
         }
 
+        // Element access
+        T *data() noexcept { return m_storage.data(); }
+        const T *data() const noexcept { return m_storage.data(); }
+
         // Iterators
         iterator begin() noexcept { return m_storage.begin(); }
         const_iterator begin() const noexcept { return m_storage.begin(); }
@@ -86,7 +100,7 @@ namespace ltc
         size_type max_size() const noexcept { return m_storage.max_size(); }
         void reserve(size_type new_cap)
         {
-            if (new_cap > m_storage.max_size()) throw std::length_error("new_cap");
+            if (new_cap > N) throw std::length_error("reserve");
         }
         size_type capacity() const noexcept { return N; }
         void shrink_to_fit()
@@ -94,8 +108,16 @@ namespace ltc
         }
 
         // Element access
-        reference at(size_type pos) { return m_storage[pos]; }
-        const_reference at(size_type pos) const { return m_storage[pos]; }
+        reference at(size_type pos)
+        {
+            if (pos >= size()) throw std::out_of_range("at");
+            return m_storage[pos];
+        }
+        const_reference at(size_type pos) const
+        {
+            if (pos >= size()) throw std::out_of_range("at");
+            return m_storage[pos];
+        }
         reference operator[](size_type pos) { return m_storage[pos]; }
         const_reference operator[](size_type pos) const { return m_storage[pos]; }
 
@@ -111,13 +133,16 @@ namespace ltc
             m_end = m_storage.begin();
         }
 
-        template <class InputIt> iterator insert(const_iterator pos, InputIt first, InputIt last)
+        // Integer arguments go to the count overload
+        template <class InputIt, class = std::enable_if_t<!std::is_integral<InputIt>::value>>
+        iterator insert(const_iterator pos, InputIt first, InputIt last)
         {
             assert(pos >= m_storage.begin() && pos <= m_end);
             const auto count = last - first;
             if (size() + count > N) throw std::length_error("insert");
             iterator it = m_storage.begin() + (pos - m_storage.begin());
-            std::move_backward(it, m_end, m_end + count);
+            this->stats().on_insert(count, m_end - it, false);
+            open_gap(it, count);
             std::copy(first, last, it);
             m_end += count;
             return it;
@@ -127,9 +152,12 @@ namespace ltc
         {
             assert(pos >= m_storage.begin() && pos <= m_end);
             if (size() == N) throw std::length_error("insert");
+            // Copied first, as value may be an element that is about to move
+            T copy(value);
             iterator it = m_storage.begin() + (pos - m_storage.begin());
-            std::move_backward(it, m_end, m_end + 1);
-            *it = value;
+            this->stats().on_insert(1, m_end - it, false);
+            open_gap(it, 1);
+            *it = std::move(copy);
             ++m_end;
             return it;
         }
@@ -139,7 +167,8 @@ namespace ltc
             assert(pos >= m_storage.begin() && pos <= m_end);
             if (size() == N) throw std::length_error("insert");
             iterator it = m_storage.begin() + (pos - m_storage.begin());
-            std::move_backward(it, m_end, m_end + 1);
+            this->stats().on_insert(1, m_end - it, false);
+            open_gap(it, 1);
             *it = std::move(value);
             ++m_end;
             return it;
@@ -149,9 +178,11 @@ namespace ltc
         {
             assert(pos >= m_storage.begin() && pos <= m_end);
             if (size() + count > N) throw std::length_error("insert");
+            const T copy(value);
             iterator it = m_storage.begin() + (pos - m_storage.begin());
-            std::move_backward(it, m_end, m_end + count);
-            std::fill(it, it + count, value);
+            this->stats().on_insert(count, m_end - it, false);
+            open_gap(it, count);
+            std::fill(it, it + count, copy);
             m_end += count;
             return it;
         }
@@ -163,27 +194,46 @@ namespace ltc
 
         template <class... Args> iterator emplace(const_iterator pos, Args &&... args)
         {
-            assert(pos >= m_storage.begin() && pos < m_end);
+            assert(pos >= m_storage.begin() && pos <= m_end);
+            if (size() == N) throw std::length_error("emplace");
+            // Built first, as args may refer to elements that are about to move
+            T value(std::forward<Args>(args)...);
             iterator it = m_storage.begin() + (pos - m_storage.begin());
-            it->~T();
-            new (it) T(args...);
+            this->stats().on_insert(1, m_end - it, false);
+            open_gap(it, 1);
+            *it = std::move(value);
+            ++m_end;
             return it;
         }
 
         template <class... Args> reference emplace_back(Args &&... args)
         {
             if (size() == N) throw std::length_error("emplace_back");
-            iterator it = m_end++;
-            it->~T();
-            new (it) T(args...);
-            return *it;
+            return unchecked_emplace_back(std::forward<Args>(args)...);
+        }
+
+        // Returns the new element, or null when the vector is full
+        template <class... Args> T *try_emplace_back(Args &&... args)
+        {
+            if (size() == N) return nullptr;
+            return &unchecked_emplace_back(std::forward<Args>(args)...);
+        }
+
+        // For callers that have checked size() < N
+        template <class... Args> reference unchecked_emplace_back(Args &&... args)
+        {
+            assert(size() < N);
+            *m_end = T(std::forward<Args>(args)...);
+            this->stats().on_insert(1, 0, false);
+            return *m_end++;
         }
 
         iterator erase(const_iterator pos)
         {
             assert(pos >= m_storage.begin() && pos <= m_end);
             iterator it = m_storage.begin() + (pos - m_storage.begin());
-            std::move(it + 1, m_end, it);
+            this->stats().on_erase(1, m_end - it - 1);
+            close_gap(it, 1);
             pop_back();
             return it;
         }
@@ -197,7 +247,8 @@ namespace ltc
             if (first != last)
             {
                 const auto count = last - first;
-                std::move(it + count, m_end, it);
+                this->stats().on_erase(count, m_end - it - count);
+                close_gap(it, count);
                 m_end -= count;
             }
             return it;
@@ -206,15 +257,43 @@ namespace ltc
         void push_back(const T &value)
         {
             if (size() == N) throw std::length_error("push_back");
-            iterator it = m_end++;
-            *it = value;
+            unchecked_push_back(value);
         }
 
         void push_back(T &&value)
         {
             if (size() == N) throw std::length_error("push_back");
-            iterator it = m_end++;
-            *it = std::move(value);
+            unchecked_push_back(std::move(value));
+        }
+
+        // Return the new element, or null when the vector is full
+        T *try_push_back(const T &value)
+        {
+            if (size() == N) return nullptr;
+            unchecked_push_back(value);
+            return &back();
+        }
+
+        T *try_push_back(T &&value)
+        {
+            if (size() == N) return nullptr;
+            unchecked_push_back(std::move(value));
+            return &back();
+        }
+
+        // For callers that have checked size() < N
+        void unchecked_push_back(const T &value)
+        {
+            assert(size() < N);
+            this->stats().on_insert(1, 0, false);
+            *m_end++ = value;
+        }
+
+        void unchecked_push_back(T &&value)
+        {
+            assert(size() < N);
+            this->stats().on_insert(1, 0, false);
+            *m_end++ = std::move(value);
         }
 
         void pop_back()
@@ -249,6 +328,35 @@ namespace ltc
         void swap(avector &other) noexcept { std::swap(*this, other); }
 
     private:
+        // Shifts [it, end()) up by count; the elements in the gap are left to be assigned
+        void open_gap(iterator it, size_type count)
+        {
+            const size_type from = it - begin();
+            relocate(from, from + count, size() - from, std::is_trivially_copyable<T>());
+        }
+
+        // Shifts [it + count, end()) down by count, over [it, it + count)
+        void close_gap(iterator it, size_type count)
+        {
+            const size_type to = it - begin();
+            relocate(to + count, to, size() - to - count, std::is_trivially_copyable<T>());
+        }
+
+        // Trivially copyable elements move with one memmove, whatever the iterator type
+        void relocate(size_type from, size_type to, size_type count, std::true_type)
+        {
+            if (count) std::memmove(data() + to, data() + from, count * sizeof(T));
+        }
+
+        void relocate(size_type from, size_type to, size_type count, std::false_type)
+        {
+            T *p = data();
+            if (to > from)
+                std::move_backward(p + from, p + from + count, p + to + count);
+            else
+                std::move(p + from, p + from + count, p + to);
+        }
+
         iterator m_end;
         storage_type m_storage;
     };
@@ -1,7 +1,20 @@
+#pragma once
+
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include <ltc/stats.hpp>
+
 namespace ltc
 {
     // https://hur.st/bloomfilter/?n=40000000000&p=1.0E-6&m=&k=30
@@ -15,11 +28,13 @@ namespace ltc
         {
         }
 
+        // items and probability are the targets the filter is sized for; setting either
+        // derives bits and hashes from them. Setting bits keeps items and derives hashes and
+        // the probability those bits give.
         uint64_t items() const { return m_items; }
         void items(uint64_t i)
         {
             m_items = i;
-            calc_p();
             calc_m();
             calc_k();
         }
@@ -28,7 +43,6 @@ namespace ltc
         void probability(double p)
         {
             m_probability = p;
-            calc_n();
             calc_m();
             calc_k();
         }
@@ -37,33 +51,53 @@ namespace ltc
         void bits(size_t bits)
         {
             m_bits = bits;
-            calc_n();
-            calc_p();
             calc_k();
+            calc_p();
         }
 
+        uint8_t hashes() const { return m_hashes; }
+
+        // The items a filter of bits and hashes holds at probability:
+        // n = -m ln(1 - p^(1/k)) / k
         static inline uint64_t calc_items(size_t bits, uint8_t hashes, double probability)
         {
-            return std::ceil(bits / (-hashes / std::log(1 - std::exp(std::log(probability) / hashes))));
+            check_probability(probability);
+            if (hashes == 0) return 0;
+            const double k = hashes;
+            const double n = -double(bits) * std::log1p(-std::pow(probability, 1 / k)) / k;
+            return uint64_t(std::floor(n));
         }
 
+        // p = (1 - e^(-kn/m))^k
         static inline double calc_probability(size_t bits, uint8_t hashes, uint64_t items)
         {
-            return std::pow(1 - std::exp(-hashes / (bits / items)), hashes);
+            if (items == 0) return 0.0;
+            if (bits == 0) return 1.0;
+            return std::pow(1 - std::exp(-double(hashes) * double(items) / double(bits)), hashes);
         }
 
+        // m = -n ln p / (ln 2)^2
         static inline size_t calc_bits(uint64_t items, double probability)
         {
-            return std::ceil((items * std::log(probability)) / std::log(1 / std::pow(2, std::log(2))));
+            check_probability(probability);
+            const double ln2 = std::log(2.0);
+            return size_t(std::ceil(-double(items) * std::log(probability) / (ln2 * ln2)));
         }
 
+        // k = m / n ln 2, at least 1 and at most 255
         static inline uint8_t calc_hashes(size_t bits, uint64_t items)
         {
-            return std::round((bits / items) * std::log(2));
+            if (items == 0) return 1;
+            const double k = std::round(double(bits) / double(items) * std::log(2.0));
+            return uint8_t(std::min(std::max(k, 1.0), 255.0));
         }
 
     private:
-        void calc_n() { m_items = calc_items(m_bits, m_hashes, m_probability); }
+        static void check_probability(double p)
+        {
+            if (!(p > 0 && p < 1)) throw std::invalid_argument("probability");
+        }
+
         void calc_p() { m_probability = calc_probability(m_bits, m_hashes, m_items); }
         void calc_m() { m_bits = calc_bits(m_items, m_probability); }
         void calc_k() { m_hashes = calc_hashes(m_bits, m_items); }
@@ -74,67 +108,240 @@ namespace ltc
         uint8_t m_hashes;
     };
 
-    template <typename Key, typename Hash = std::hash<Key>> class bloom_filter
+    namespace detail
+    {
+        // The splitmix64 finalizer. Spreads std::hash, which is the identity for integers,
+        // over all 64 bits.
+        inline uint64_t mix64(uint64_t z)
+        {
+            z += 0x9e3779b97f4a7c15ull;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        inline unsigned popcount(uint64_t w)
+        {
+#if defined(__GNUC__)
+            return static_cast<unsigned>(__builtin_popcountll(w));
+#else
+            w = w - ((w >> 1) & 0x5555555555555555ull);
+            w = (w & 0x3333333333333333ull) + ((w >> 2) & 0x3333333333333333ull);
+            w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0full;
+            return static_cast<unsigned>((w * 0x0101010101010101ull) >> 56);
+#endif
+        }
+
+        // a[i] |= b[i], two words at a time where SSE2 is available
+        inline void or_words(uint64_t *a, const uint64_t *b, std::size_t n)
+        {
+            std::size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            for (; i + 2 <= n; i += 2)
+            {
+                const auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+                const auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(a + i), _mm_or_si128(va, vb));
+            }
+#endif
+            for (; i < n; ++i)
+                a[i] |= b[i];
+        }
+
+        inline void and_words(uint64_t *a, const uint64_t *b, std::size_t n)
+        {
+            std::size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+            for (; i + 2 <= n; i += 2)
+            {
+                const auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+                const auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(a + i), _mm_and_si128(va, vb));
+            }
+#endif
+            for (; i < n; ++i)
+                a[i] &= b[i];
+        }
+    } // namespace detail
+
+    // Stats is a compile-time stats policy, see stats.hpp. Adds count as inserts and
+    // possibly_contains as finds, hit when the key may be present.
+    //
+    // The bits are kept in 64 bit words, so filters of the same size, hash count and seed
+    // combine word by word: merge gives the filter of the union of their keys, intersect
+    // one that holds at least their common keys.
+    template <typename Key, typename Hash = std::hash<Key>, class Stats = no_stats>
+    class bloom_filter : public stats_holder<Stats>
     {
     public:
-        bloom_filter(size_t size, uint8_t num_hashes) : m_bits(size), m_num_hashes(num_hashes) {}
+        bloom_filter(size_t size, uint8_t num_hashes, uint64_t seed = 0)
+        : m_words((size + 63) / 64), m_size(size), m_num_hashes(num_hashes), m_seed(seed)
+        {
+        }
+
+        // A filter sized by bloom_calculator for items keys at false positive probability
+        // fpp. The bits are rounded up to whole blocks of block_bits, so the words merge
+        // without a scalar tail, and the hash count is chosen for the rounded size.
+        static bloom_filter make_for(uint64_t items, double fpp, uint64_t seed = 0)
+        {
+            const auto bits = bloom_calculator::calc_bits(std::max<uint64_t>(items, 1), fpp);
+            const auto blocks = std::max<size_t>(1, (bits + block_bits - 1) / block_bits);
+            const auto size = blocks * block_bits;
+            return bloom_filter(size, bloom_calculator::calc_hashes(size, items), seed);
+        }
 
         void add(const Key &key)
         {
-            const Hash hasher{};
-            const auto size = m_bits.size();
-            auto hash = hasher(key);
-            for (auto n = 0; n < m_num_hashes; ++n, hash = hash ^ ((hash + n) << 1))
+            auto p = probe(key);
+            for (auto n = 0; n < m_num_hashes; ++n)
             {
-                m_bits[hash % size] = true;
+                set(p.next(m_size));
             }
             ++m_count;
+            this->stats().on_insert(1, 0, false);
         }
 
         bool try_add(const Key &key)
         {
-            const Hash hasher{};
-            const auto size = m_bits.size();
-            auto hash = hasher(key);
+            auto p = probe(key);
             bool added = false;
-            for (auto n = 0; n < m_num_hashes; ++n, hash = hash ^ ((hash + n) << 1))
+            for (auto n = 0; n < m_num_hashes; ++n)
             {
-                const auto idx = hash % size;
-                if (!m_bits[idx])
+                const auto idx = p.next(m_size);
+                if (!test(idx))
                 {
                     added = true;
                 }
-                m_bits[idx] = true;
+                set(idx);
             }
             if (added)
             {
                 ++m_count;
             }
+            this->stats().on_insert(added ? 1 : 0, 0, false);
             return added;
         }
 
         bool possibly_contains(const Key &key) const
         {
-            const Hash hasher{};
-            const auto size = m_bits.size();
-            auto hash = hasher(key);
-            for (auto n = 0; n < m_num_hashes; ++n, hash = hash ^ ((hash + n) << 1))
+            auto p = probe(key);
+            for (auto n = 0; n < m_num_hashes; ++n)
             {
-                if (!m_bits[hash % size])
+                if (!test(p.next(m_size)))
                 {
+                    this->stats().on_find(false);
                     return false;
                 }
             }
+            this->stats().on_find(true);
             return true;
         }
 
-        size_t size() const { return m_bits.size(); }
+        // Filters combine when they have the same size, hash count and seed
+        bool compatible(const bloom_filter &other) const
+        {
+            return m_size == other.m_size && m_num_hashes == other.m_num_hashes &&
+                   m_seed == other.m_seed;
+        }
+
+        // Adds the keys of other. count() becomes the sum of the counts, which overstates
+        // the union when the filters share keys; see estimated_cardinality.
+        void merge(const bloom_filter &other)
+        {
+            check_compatible(other);
+            detail::or_words(m_words.data(), other.m_words.data(), m_words.size());
+            m_count += other.m_count;
+        }
+
+        // Keeps the bits set in both filters. Every key added to both still passes, and
+        // count() becomes the smaller of the counts. The result has more false positives
+        // than a filter built from the common keys alone.
+        void intersect(const bloom_filter &other)
+        {
+            check_compatible(other);
+            detail::and_words(m_words.data(), other.m_words.data(), m_words.size());
+            m_count = std::min(m_count, other.m_count);
+        }
+
+        size_t size() const { return m_size; }
         size_t count() const { return m_count; }
+        uint8_t hashes() const { return m_num_hashes; }
+        uint64_t seed() const { return m_seed; }
+
+        // Fraction of the bits that are set. Scans the filter.
+        double fill_ratio() const { return double(set_bits()) / m_size; }
+
+        // Distinct keys added, estimated from the set bits as -m/k ln(1 - X/m) (Swamidass
+        // and Baldi). Unlike count() it does not count a key twice, so after merge it
+        // estimates the size of the union. Infinite once every bit is set.
+        double estimated_cardinality() const
+        {
+            const double m = double(m_size);
+            const double x = double(set_bits());
+            if (x >= m) return std::numeric_limits<double>::infinity();
+            return -m / m_num_hashes * std::log1p(-x / m);
+        }
+
+        // False positive probability as the filter stands: the chance that all k probed
+        // bits are set, fill_ratio()^k. Scans the filter.
+        double estimated_fpp() const { return std::pow(fill_ratio(), m_num_hashes); }
+
+        // The counters of the stats policy with the fill ratio and estimated FPP filled in
+        stats_snapshot snapshot() const
+        {
+            auto s = this->stats().snapshot();
+            s.fill_ratio = fill_ratio();
+            s.estimated_fpp = estimated_fpp();
+            return s;
+        }
+
+        // make_for sizes filters in blocks of one 64 byte cache line
+        static constexpr size_t block_bits = 512;
 
     private:
-        std::vector<bool> m_bits;
+        // The bits of a key are h1 + n * h2 for n = 0 .. hashes - 1 (Kirsch and
+        // Mitzenmacher), both halves of one mixed and seeded hash
+        struct bit_sequence
+        {
+            uint64_t hash;
+            uint64_t step;
+
+            size_t next(size_t size)
+            {
+                const auto bit = static_cast<size_t>(hash % size);
+                hash += step;
+                return bit;
+            }
+        };
+
+        bit_sequence probe(const Key &key) const
+        {
+            const Hash hasher{};
+            const auto h = detail::mix64(static_cast<uint64_t>(hasher(key)) ^ m_seed);
+            return bit_sequence{ h, (h >> 32 | h << 32) | 1 };
+        }
+
+        void set(size_t bit) { m_words[bit >> 6] |= uint64_t(1) << (bit & 63); }
+        bool test(size_t bit) const { return (m_words[bit >> 6] >> (bit & 63)) & 1; }
+
+        size_t set_bits() const
+        {
+            size_t bits = 0;
+            for (const auto w : m_words)
+                bits += detail::popcount(w);
+            return bits;
+        }
+
+        void check_compatible(const bloom_filter &other) const
+        {
+            if (!compatible(other)) throw std::invalid_argument("incompatible bloom filters");
+        }
+
+        std::vector<uint64_t> m_words;
+        size_t m_size;
         size_t m_count{ 0 };
         const uint8_t m_num_hashes;
+        uint64_t m_seed;
     };
 
 } // namespace ltc
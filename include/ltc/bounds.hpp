@@ -0,0 +1,23 @@
+#pragma once
+
+namespace ltc
+{
+    // Which ends of an interval [lo, hi] a range query includes.
+    enum class bounds
+    {
+        closed,     // [lo, hi]
+        right_open, // [lo, hi)
+        left_open,  // (lo, hi]
+        open        // (lo, hi)
+    };
+
+    constexpr bool includes_lower(bounds b)
+    {
+        return b == bounds::closed || b == bounds::right_open;
+    }
+
+    constexpr bool includes_upper(bounds b)
+    {
+        return b == bounds::closed || b == bounds::left_open;
+    }
+} // namespace ltc
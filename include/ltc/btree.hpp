@@ -2,108 +2,890 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <memory>
+#include <numeric>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <ltc/bounds.hpp>
+#include <ltc/range.hpp>
+#include <ltc/stats.hpp>
+
 namespace ltc
 {
-
-    struct btree
+    // A B+tree map. All values live in the leaves, which are chained in key order so that
+    // scans never go back up the tree; inner nodes only hold separator keys. A node holds at
+    // most order entries and, except for the root, at least order / 2.
+    //
+    // With Counted, inner nodes also keep the size of each child's subtree, which makes the
+    // order statistics rank, select, nth_key and count_range O(log n) at the cost of updating
+    // the counts on the way down for every insert and erase.
+    //
+    // Stats is a compile-time stats policy, see stats.hpp. A search counts the comparisons
+    // from the root to the leaf, and node splits count as reallocations.
+    template <class Key,
+              class T,
+              class Compare = std::less<Key>,
+              bool Counted = false,
+              class Stats = no_stats>
+    class basic_btree : public stats_holder<Stats>
     {
-        using key_type = std::string;
-        using key_compare = std::less<key_type>;
-        using mapped_type = std::string;
-        using value_type = std::pair<key_type,mapped_type>;
-        using values_type = std::vector<value_type>;
-        using node_iterator = values_type::iterator;
-        using size_type = values_type::size_type;
+        struct node;
+        struct leaf_node;
+        struct inner_node;
 
-        struct iterator;
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = Compare;
 
-        struct value_compare
+        class value_compare
         {
+            key_compare m_key_comp;
+
+        public:
             value_compare(const key_compare &key_comp) : m_key_comp(key_comp) {}
+
             bool operator()(const value_type &a, const value_type &b) const
             {
                 return m_key_comp(a.first, b.first);
             }
-            const key_compare m_key_comp;
         };
 
-        struct node
+        // Bidirectional iterator over the leaf chain
+        template <bool Const> class basic_iterator
         {
-            node(size_type order)
+            friend class basic_btree;
+
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = typename basic_btree::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+            using reference = std::conditional_t<Const, const value_type &, value_type &>;
+
+            basic_iterator() = default;
+
+            // iterator converts to const_iterator
+            template <bool C, class = std::enable_if_t<Const && !C>>
+            basic_iterator(const basic_iterator<C> &other)
+            : m_leaf(other.m_leaf), m_index(other.m_index)
             {
-                _values.reserve(order);
             }
 
-            node_iterator begin() { return _values.begin(); }
-            node_iterator end() { return _values.end(); }
-            bool is_full() const { return _values.size() == _values.capacity(); }
-            node_iterator insert(node_iterator it, const value_type &v) { return _values.insert(it, v); }
+            reference operator*() const { return m_leaf->values[m_index]; }
+            pointer operator->() const { return &m_leaf->values[m_index]; }
+
+            basic_iterator &operator++()
+            {
+                if (++m_index == m_leaf->values.size() && m_leaf->next)
+                {
+                    m_leaf = m_leaf->next;
+                    m_index = 0;
+                }
+                return *this;
+            }
+            basic_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            basic_iterator &operator--()
+            {
+                if (m_index == 0)
+                {
+                    m_leaf = m_leaf->prev;
+                    m_index = m_leaf->values.size();
+                }
+                --m_index;
+                return *this;
+            }
+            basic_iterator operator--(int)
+            {
+                auto tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            bool operator==(const basic_iterator &o) const
+            {
+                return m_leaf == o.m_leaf && m_index == o.m_index;
+            }
+            bool operator!=(const basic_iterator &o) const { return !(*this == o); }
 
         private:
-            values_type _values;            
+            template <bool> friend class basic_iterator;
+
+            basic_iterator(leaf_node *leaf, size_type index) : m_leaf(leaf), m_index(index) {}
+
+            leaf_node *m_leaf = nullptr;
+            size_type m_index = 0;
         };
 
-        struct iterator
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        // Walks the leaf chain from a start key, optionally up to an end key. Unlike an
+        // iterator a cursor survives modifications of the tree: it remembers the key it is
+        // at and, if the tree changed since, seeks back to the first key not less than it.
+        class cursor
         {
-            using value_type = std::pair<node&,node_iterator>; 
-            iterator(node &node, node_iterator it) : _node(node), _it(it) {}
-            bool operator==(iterator const& other) const { return _it == other._it; }
-            bool operator!=(iterator const& other) const { return _it != other._it; }  
-            value_type operator*() const { return value_type(_node,_it); }
+            friend class basic_btree;
 
-            iterator& operator++()
+        public:
+            bool done() const
             {
-                _it++;
+                sync();
+                if (m_it == m_tree->end()) return true;
+                if (!m_has_hi) return false;
+                const auto &key = m_it->first;
+                return m_hi_inclusive ? m_tree->m_key_comp(m_hi, key)
+                                      : !m_tree->m_key_comp(key, m_hi);
+            }
+            explicit operator bool() const { return !done(); }
+
+            const value_type &operator*() const
+            {
+                sync();
+                return *m_it;
+            }
+            const value_type *operator->() const { return &**this; }
+
+            cursor &operator++()
+            {
+                sync();
+                ++m_it;
+                remember();
                 return *this;
             }
 
         private:
-            std::vector<node*> _stack;
-            node& _node;
-            node_iterator _it; 
+            cursor(const basic_btree *tree, const_iterator it, const key_type *hi, bool inclusive)
+            : m_tree(tree), m_it(it), m_has_hi(hi != nullptr), m_hi_inclusive(inclusive)
+            {
+                if (hi) m_hi = *hi;
+                remember();
+            }
+
+            void remember()
+            {
+                m_version = m_tree->m_version;
+                m_at_end = m_it == m_tree->end();
+                if (!m_at_end) m_key = m_it->first;
+            }
+
+            // Re-seeks after the tree was modified
+            void sync() const
+            {
+                if (m_version == m_tree->m_version) return;
+                m_it = m_at_end ? m_tree->end() : m_tree->lower_bound(m_key);
+                m_version = m_tree->m_version;
+            }
+
+            const basic_btree *m_tree;
+            mutable const_iterator m_it;
+            mutable std::uint64_t m_version = 0;
+            key_type m_key{};
+            bool m_at_end = true;
+            key_type m_hi{};
+            bool m_has_hi;
+            bool m_hi_inclusive;
         };
 
-        btree(size_type order) : _order(order), _root(order), _key_comp(key_compare()), _value_comp(key_compare()) 
+        // Construction
+        explicit basic_btree(size_type order = 64, const Compare &comp = Compare())
+        : m_order(std::max<size_type>(order, 3)), m_key_comp(comp), m_value_comp(comp)
         {
+            init();
         }
 
-        iterator begin() { return iterator(_root, _root.begin()); }
-        iterator end() { return iterator(_root, _root.end()); }
+        basic_btree(std::initializer_list<value_type> init,
+                    size_type order = 64,
+                    const Compare &comp = Compare())
+        : basic_btree(order, comp)
+        {
+            insert(init.begin(), init.end());
+        }
 
-        iterator find(const key_type &key)
+        basic_btree(const basic_btree &other)
+        : stats_holder<Stats>(other), m_order(other.m_order), m_key_comp(other.m_key_comp),
+          m_value_comp(other.m_key_comp)
+        {
+            init();
+            insert(other.begin(), other.end());
+        }
+
+        basic_btree(basic_btree &&other)
+        : m_order(other.m_order), m_key_comp(other.m_key_comp), m_value_comp(other.m_key_comp)
+        {
+            init();
+            swap(other);
+        }
+
+        basic_btree &operator=(const basic_btree &other)
+        {
+            if (this != &other)
+            {
+                basic_btree tmp(other);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        basic_btree &operator=(basic_btree &&other)
+        {
+            swap(other);
+            return *this;
+        }
+
+        // Element access
+        mapped_type &at(const key_type &key)
         {
-            auto it = std::lower_bound(_root.begin(), _root.end(),
-                                       value_type(key, mapped_type()), _value_comp);
-            if (it != _root.end() && !_key_comp(key, it->first)) return iterator(_root, it);
-            return end();
+            const auto it = find(key);
+            if (it == end()) throw std::out_of_range("key");
+            return it->second;
         }
 
-        mapped_type const& at(key_type const& key) const
+        const mapped_type &at(const key_type &key) const
         {
-            throw std::out_of_range("key");
+            const auto it = find(key);
+            if (it == end()) throw std::out_of_range("key");
+            return it->second;
+        }
+
+        mapped_type &operator[](const key_type &key)
+        {
+            return insert(value_type(key, mapped_type())).first->second;
+        }
+
+        // Iterators
+        iterator begin() { return iterator(m_head, 0); }
+        const_iterator begin() const { return const_iterator(m_head, 0); }
+        const_iterator cbegin() const { return begin(); }
+        iterator end() { return iterator(m_tail, m_tail->values.size()); }
+        const_iterator end() const { return const_iterator(m_tail, m_tail->values.size()); }
+        const_iterator cend() const { return end(); }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        // Capacity
+        bool empty() const { return m_size == 0; }
+        size_type size() const { return m_size; }
+        size_type order() const { return m_order; }
+
+        // Number of levels, 1 for a tree that is a single leaf
+        size_type height() const
+        {
+            size_type h = 1;
+            for (const node *n = m_root.get(); !n->leaf; n = as_inner(n)->children.front().get())
+                ++h;
+            return h;
+        }
+
+        // Modifiers
+        void clear()
+        {
+            init();
+            m_size = 0;
+            ++m_version;
         }
 
         std::pair<iterator, bool> insert(const value_type &value)
         {
-            auto it = find(value.first);
-            if ((*it).first.is_full())
+            return insert_value(value_type(value));
+        }
+
+        std::pair<iterator, bool> insert(value_type &&value)
+        {
+            return insert_value(std::move(value));
+        }
+
+        template <class InputIt> void insert(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+                insert(value_type(*first));
+        }
+
+        size_type erase(const key_type &key)
+        {
+            std::vector<step> path;
+            size_t comparisons = 0;
+            auto leaf = descend(key, path, comparisons);
+            const auto pos = leaf_lower_bound(leaf, key, comparisons);
+            this->stats().on_search(comparisons);
+            if (pos == leaf->values.size() || m_key_comp(key, leaf->values[pos].first))
+                return 0;
+            this->stats().on_erase(1, leaf->values.size() - pos - 1);
+            leaf->values.erase(leaf->values.begin() + pos);
+            --m_size;
+            ++m_version;
+            if (Counted)
+                for (const auto &s : path)
+                    --s.node->counts[s.index];
+            rebalance_leaf(leaf, path);
+            return 1;
+        }
+
+        // Removes the element at pos and returns an iterator to the one after it
+        iterator erase(const_iterator pos)
+        {
+            // Rebalancing may move elements between leaves, so find the successor by key
+            const auto key = pos->first;
+            auto next = pos;
+            ++next;
+            if (next == end())
+            {
+                erase(key);
+                return end();
+            }
+            const auto next_key = next->first;
+            erase(key);
+            return lower_bound(next_key);
+        }
+
+        void swap(basic_btree &other)
+        {
+            using std::swap;
+            swap(m_root, other.m_root);
+            swap(m_head, other.m_head);
+            swap(m_tail, other.m_tail);
+            swap(m_size, other.m_size);
+            swap(m_order, other.m_order);
+            swap(m_key_comp, other.m_key_comp);
+            swap(m_value_comp, other.m_value_comp);
+            ++m_version;
+            ++other.m_version;
+        }
+
+        // Lookup
+        size_type count(const key_type &key) const { return find(key) != end() ? 1 : 0; }
+        bool contains(const key_type &key) const { return count(key) == 1; }
+
+        iterator find(const key_type &key)
+        {
+            const auto it = lower_bound(key);
+            const bool hit = it != end() && !m_key_comp(key, it->first);
+            this->stats().on_find(hit);
+            return hit ? it : end();
+        }
+
+        const_iterator find(const key_type &key) const
+        {
+            const auto it = lower_bound(key);
+            const bool hit = it != end() && !m_key_comp(key, it->first);
+            this->stats().on_find(hit);
+            return hit ? it : end();
+        }
+
+        iterator lower_bound(const key_type &key) { return bound(key, false); }
+        const_iterator lower_bound(const key_type &key) const { return bound(key, false); }
+        iterator upper_bound(const key_type &key) { return bound(key, true); }
+        const_iterator upper_bound(const key_type &key) const { return bound(key, true); }
+
+        std::pair<iterator, iterator> equal_range(const key_type &key)
+        {
+            return std::make_pair(lower_bound(key), upper_bound(key));
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const
+        {
+            return std::make_pair(lower_bound(key), upper_bound(key));
+        }
+
+        // The elements with keys between lo and hi, which ends included as given by b
+        subrange<const_iterator> range(const key_type &lo,
+                                       const key_type &hi,
+                                       bounds b = bounds::right_open) const
+        {
+            const auto first = includes_lower(b) ? lower_bound(lo) : upper_bound(lo);
+            if (first == end() || m_key_comp(hi, first->first))
+                return subrange<const_iterator>(first, first);
+            const auto last = includes_upper(b) ? upper_bound(hi) : lower_bound(hi);
+            return subrange<const_iterator>(first, last);
+        }
+
+        // Cursor over all keys not less than lo
+        cursor seek(const key_type &lo) const
+        {
+            return cursor(this, lower_bound(lo), nullptr, false);
+        }
+
+        // Cursor over the keys between lo and hi, which ends included as given by b
+        cursor seek(const key_type &lo, const key_type &hi, bounds b = bounds::right_open) const
+        {
+            const auto first = includes_lower(b) ? lower_bound(lo) : upper_bound(lo);
+            return cursor(this, first, &hi, includes_upper(b));
+        }
+
+        // Order statistics, for counted trees only. Positions count elements in key order,
+        // from 0.
+
+        // Number of elements with keys less than key
+        size_type rank(const key_type &key) const { return rank(key, false); }
+
+        // The element at position i, or end() if there is none
+        iterator select(size_type i)
+        {
+            static_assert(Counted, "select needs a counted btree");
+            if (i >= m_size) return end();
+            node *n = m_root.get();
+            while (!n->leaf)
             {
-                // split node
-                
-                throw std::runtime_error("node full");
+                auto inner = as_inner(n);
+                size_type c = 0;
+                while (i >= inner->counts[c])
+                    i -= inner->counts[c++];
+                n = inner->children[c].get();
             }
-            return std::make_pair(iterator(_root, _root.insert((*it).second, value)), true);
+            return iterator(as_leaf(n), i);
         }
 
+        const_iterator select(size_type i) const
+        {
+            return const_cast<basic_btree *>(this)->select(i);
+        }
+
+        const key_type &nth_key(size_type i) const
+        {
+            if (i >= m_size) throw std::out_of_range("index");
+            return select(i)->first;
+        }
+
+        // Number of elements with keys between lo and hi, which ends included as given by b
+        size_type count_range(const key_type &lo,
+                              const key_type &hi,
+                              bounds b = bounds::right_open) const
+        {
+            const auto first = rank(lo, !includes_lower(b));
+            const auto last = rank(hi, includes_upper(b));
+            return last > first ? last - first : 0;
+        }
+
+        // Observers
+        key_compare key_comp() const { return m_key_comp; }
+        value_compare value_comp() const { return m_value_comp; }
+
     private:
-        node _root;
-        size_type _order;
-        key_compare _key_comp;
-        value_compare _value_comp;
+        struct node
+        {
+            explicit node(bool is_leaf) : leaf(is_leaf) {}
+            virtual ~node() = default;
+
+            const bool leaf;
+        };
+
+        struct leaf_node final : node
+        {
+            leaf_node() : node(true) {}
+
+            std::vector<value_type> values;
+            leaf_node *prev = nullptr;
+            leaf_node *next = nullptr;
+        };
+
+        // children[i] holds the keys in [keys[i - 1], keys[i]). In a counted tree counts[i]
+        // is the number of elements below children[i]; otherwise counts stays empty.
+        struct inner_node final : node
+        {
+            inner_node() : node(false) {}
+
+            std::vector<key_type> keys;
+            std::vector<std::unique_ptr<node>> children;
+            std::vector<size_type> counts;
+        };
+
+        // An inner node on the way down and the index of the child taken
+        struct step
+        {
+            inner_node *node;
+            size_type index;
+        };
+
+        static leaf_node *as_leaf(node *n) { return static_cast<leaf_node *>(n); }
+        static const leaf_node *as_leaf(const node *n) { return static_cast<const leaf_node *>(n); }
+        static inner_node *as_inner(node *n) { return static_cast<inner_node *>(n); }
+        static const inner_node *as_inner(const node *n)
+        {
+            return static_cast<const inner_node *>(n);
+        }
+
+        size_type min_fill() const { return m_order / 2; }
+
+        static size_type subtree_size(const node *n)
+        {
+            if (n->leaf) return as_leaf(n)->values.size();
+            const auto &counts = as_inner(n)->counts;
+            return std::accumulate(counts.begin(), counts.end(), size_type(0));
+        }
+
+        // Refreshes the count of children[i] from the child itself
+        static void recount(inner_node *n, size_type i)
+        {
+            if (Counted) n->counts[i] = subtree_size(n->children[i].get());
+        }
+
+        // Number of elements less than (or, if inclusive, not greater than) key
+        size_type rank(const key_type &key, bool inclusive) const
+        {
+            static_assert(Counted, "rank needs a counted btree");
+            size_type r = 0;
+            size_t comparisons = 0;
+            const node *n = m_root.get();
+            while (!n->leaf)
+            {
+                auto inner = as_inner(n);
+                // Keys equal to a separator live right of it, also when inclusive
+                const auto c = child_index(inner, key, comparisons);
+                r = std::accumulate(inner->counts.begin(), inner->counts.begin() + c, r);
+                n = inner->children[c].get();
+            }
+            auto leaf = as_leaf(n);
+            r += inclusive ? leaf_upper_bound(leaf, key, comparisons)
+                           : leaf_lower_bound(leaf, key, comparisons);
+            this->stats().on_search(comparisons);
+            return r;
+        }
+
+        void init()
+        {
+            std::unique_ptr<leaf_node> leaf(new leaf_node);
+            m_head = m_tail = leaf.get();
+            m_root = std::move(leaf);
+        }
+
+        // The search helpers add the comparisons they make to comparisons
+        size_type child_index(const inner_node *n, const key_type &key, size_t &comparisons) const
+        {
+            const auto less = [this, &comparisons](const key_type &a, const key_type &b) {
+                ++comparisons;
+                return m_key_comp(a, b);
+            };
+            return std::upper_bound(n->keys.begin(), n->keys.end(), key, less) - n->keys.begin();
+        }
+
+        size_type
+        leaf_lower_bound(const leaf_node *leaf, const key_type &key, size_t &comparisons) const
+        {
+            const auto less = [this, &comparisons](const value_type &v, const key_type &k) {
+                ++comparisons;
+                return m_key_comp(v.first, k);
+            };
+            return std::lower_bound(leaf->values.begin(), leaf->values.end(), key, less) -
+                   leaf->values.begin();
+        }
+
+        size_type
+        leaf_upper_bound(const leaf_node *leaf, const key_type &key, size_t &comparisons) const
+        {
+            const auto greater = [this, &comparisons](const key_type &k, const value_type &v) {
+                ++comparisons;
+                return m_key_comp(k, v.first);
+            };
+            return std::upper_bound(leaf->values.begin(), leaf->values.end(), key, greater) -
+                   leaf->values.begin();
+        }
+
+        leaf_node *
+        descend(const key_type &key, std::vector<step> &path, size_t &comparisons) const
+        {
+            node *n = m_root.get();
+            while (!n->leaf)
+            {
+                auto inner = as_inner(n);
+                const auto i = child_index(inner, key, comparisons);
+                path.push_back(step{ inner, i });
+                n = inner->children[i].get();
+            }
+            return as_leaf(n);
+        }
+
+        leaf_node *descend(const key_type &key, size_t &comparisons) const
+        {
+            node *n = m_root.get();
+            while (!n->leaf)
+            {
+                auto inner = as_inner(n);
+                n = inner->children[child_index(inner, key, comparisons)].get();
+            }
+            return as_leaf(n);
+        }
+
+        // First element not less than (or, if upper, greater than) key
+        iterator bound(const key_type &key, bool upper) const
+        {
+            size_t comparisons = 0;
+            auto leaf = descend(key, comparisons);
+            const auto pos = upper ? leaf_upper_bound(leaf, key, comparisons)
+                                   : leaf_lower_bound(leaf, key, comparisons);
+            this->stats().on_search(comparisons);
+            // The answer can be the first element of the next leaf
+            if (pos == leaf->values.size() && leaf->next) return iterator(leaf->next, 0);
+            return iterator(leaf, pos);
+        }
+
+        std::pair<iterator, bool> insert_value(value_type &&value)
+        {
+            std::vector<step> path;
+            size_t comparisons = 0;
+            auto leaf = descend(value.first, path, comparisons);
+            auto pos = leaf_lower_bound(leaf, value.first, comparisons);
+            this->stats().on_search(comparisons);
+            if (pos < leaf->values.size() && !m_key_comp(value.first, leaf->values[pos].first))
+                return std::make_pair(iterator(leaf, pos), false);
+
+            const auto moved = leaf->values.size() - pos;
+            leaf->values.insert(leaf->values.begin() + pos, std::move(value));
+            ++m_size;
+            ++m_version;
+            if (Counted)
+                for (const auto &s : path)
+                    ++s.node->counts[s.index];
+            if (leaf->values.size() <= m_order)
+            {
+                this->stats().on_insert(1, moved, false);
+                return std::make_pair(iterator(leaf, pos), true);
+            }
+
+            // Split the leaf and hand the first key of the right half to the parent
+            std::unique_ptr<leaf_node> right(new leaf_node);
+            const auto half = leaf->values.size() / 2;
+            this->stats().on_insert(1, moved + leaf->values.size() - half, true);
+            right->values.assign(std::make_move_iterator(leaf->values.begin() + half),
+                                 std::make_move_iterator(leaf->values.end()));
+            leaf->values.erase(leaf->values.begin() + half, leaf->values.end());
+            right->next = leaf->next;
+            right->prev = leaf;
+            if (leaf->next)
+                leaf->next->prev = right.get();
+            else
+                m_tail = right.get();
+            leaf->next = right.get();
+
+            const iterator result = pos < half ? iterator(leaf, pos)
+                                               : iterator(right.get(), pos - half);
+            key_type separator = right->values.front().first;
+            insert_into_parent(path, std::move(separator), std::move(right));
+            return std::make_pair(result, true);
+        }
+
+        // Adds child as the right neighbour of the node at the end of path, splitting inner
+        // nodes up the path as needed.
+        void insert_into_parent(std::vector<step> &path,
+                                key_type separator,
+                                std::unique_ptr<node> child)
+        {
+            while (!path.empty())
+            {
+                const auto s = path.back();
+                path.pop_back();
+                auto parent = s.node;
+                parent->keys.insert(parent->keys.begin() + s.index, std::move(separator));
+                parent->children.insert(parent->children.begin() + s.index + 1, std::move(child));
+                if (Counted)
+                {
+                    parent->counts.insert(parent->counts.begin() + s.index + 1, 0);
+                    recount(parent, s.index);
+                    recount(parent, s.index + 1);
+                }
+                if (parent->keys.size() <= m_order) return;
+
+                // The middle key moves up; the keys right of it go to a new node
+                std::unique_ptr<inner_node> right(new inner_node);
+                this->stats().on_reallocate();
+                const auto mid = parent->keys.size() / 2;
+                separator = std::move(parent->keys[mid]);
+                right->keys.assign(std::make_move_iterator(parent->keys.begin() + mid + 1),
+                                   std::make_move_iterator(parent->keys.end()));
+                right->children.assign(std::make_move_iterator(parent->children.begin() + mid + 1),
+                                       std::make_move_iterator(parent->children.end()));
+                parent->keys.erase(parent->keys.begin() + mid, parent->keys.end());
+                parent->children.erase(parent->children.begin() + mid + 1, parent->children.end());
+                if (Counted)
+                {
+                    right->counts.assign(parent->counts.begin() + mid + 1, parent->counts.end());
+                    parent->counts.erase(parent->counts.begin() + mid + 1, parent->counts.end());
+                }
+                child = std::move(right);
+            }
+
+            // The root split
+            std::unique_ptr<inner_node> root(new inner_node);
+            this->stats().on_reallocate();
+            root->keys.push_back(std::move(separator));
+            root->children.push_back(std::move(m_root));
+            root->children.push_back(std::move(child));
+            if (Counted)
+            {
+                root->counts.assign(2, 0);
+                recount(root.get(), 0);
+                recount(root.get(), 1);
+            }
+            m_root = std::move(root);
+        }
+
+        // Refills an underfull leaf from a sibling, or merges it into one
+        void rebalance_leaf(leaf_node *leaf, std::vector<step> &path)
+        {
+            if (path.empty() || leaf->values.size() >= min_fill()) return;
+
+            const auto s = path.back();
+            auto parent = s.node;
+            auto left = s.index > 0 ? as_leaf(parent->children[s.index - 1].get()) : nullptr;
+            auto right = s.index + 1 < parent->children.size()
+                             ? as_leaf(parent->children[s.index + 1].get())
+                             : nullptr;
+
+            if (left && left->values.size() > min_fill())
+            {
+                leaf->values.insert(leaf->values.begin(), std::move(left->values.back()));
+                left->values.pop_back();
+                parent->keys[s.index - 1] = leaf->values.front().first;
+                recount(parent, s.index - 1);
+                recount(parent, s.index);
+                return;
+            }
+            if (right && right->values.size() > min_fill())
+            {
+                leaf->values.push_back(std::move(right->values.front()));
+                right->values.erase(right->values.begin());
+                parent->keys[s.index] = right->values.front().first;
+                recount(parent, s.index);
+                recount(parent, s.index + 1);
+                return;
+            }
+
+            // Merge the right one of the pair into the left one
+            const auto index = left ? s.index - 1 : s.index;
+            auto into = as_leaf(parent->children[index].get());
+            auto from = as_leaf(parent->children[index + 1].get());
+            into->values.insert(into->values.end(), std::make_move_iterator(from->values.begin()),
+                                std::make_move_iterator(from->values.end()));
+            into->next = from->next;
+            if (from->next)
+                from->next->prev = into;
+            else
+                m_tail = into;
+            parent->keys.erase(parent->keys.begin() + index);
+            parent->children.erase(parent->children.begin() + index + 1);
+            if (Counted)
+            {
+                parent->counts.erase(parent->counts.begin() + index + 1);
+                recount(parent, index);
+            }
+
+            path.pop_back();
+            rebalance_inner(parent, path);
+        }
+
+        void rebalance_inner(inner_node *n, std::vector<step> &path)
+        {
+            if (path.empty())
+            {
+                // The root shrinks once it has a single child
+                if (n->keys.empty()) m_root = std::move(n->children.front());
+                return;
+            }
+            if (n->keys.size() >= min_fill()) return;
+
+            const auto s = path.back();
+            auto parent = s.node;
+            auto left = s.index > 0 ? as_inner(parent->children[s.index - 1].get()) : nullptr;
+            auto right = s.index + 1 < parent->children.size()
+                             ? as_inner(parent->children[s.index + 1].get())
+                             : nullptr;
+
+            // Borrowing rotates a key through the parent
+            if (left && left->keys.size() > min_fill())
+            {
+                n->keys.insert(n->keys.begin(), std::move(parent->keys[s.index - 1]));
+                n->children.insert(n->children.begin(), std::move(left->children.back()));
+                parent->keys[s.index - 1] = std::move(left->keys.back());
+                left->keys.pop_back();
+                left->children.pop_back();
+                if (Counted)
+                {
+                    n->counts.insert(n->counts.begin(), left->counts.back());
+                    left->counts.pop_back();
+                    recount(parent, s.index - 1);
+                    recount(parent, s.index);
+                }
+                return;
+            }
+            if (right && right->keys.size() > min_fill())
+            {
+                n->keys.push_back(std::move(parent->keys[s.index]));
+                n->children.push_back(std::move(right->children.front()));
+                parent->keys[s.index] = std::move(right->keys.front());
+                right->keys.erase(right->keys.begin());
+                right->children.erase(right->children.begin());
+                if (Counted)
+                {
+                    n->counts.push_back(right->counts.front());
+                    right->counts.erase(right->counts.begin());
+                    recount(parent, s.index);
+                    recount(parent, s.index + 1);
+                }
+                return;
+            }
+
+            // Merging pulls the separator down between the two key lists
+            const auto index = left ? s.index - 1 : s.index;
+            auto into = as_inner(parent->children[index].get());
+            auto from = as_inner(parent->children[index + 1].get());
+            into->keys.push_back(std::move(parent->keys[index]));
+            into->keys.insert(into->keys.end(), std::make_move_iterator(from->keys.begin()),
+                              std::make_move_iterator(from->keys.end()));
+            into->children.insert(into->children.end(),
+                                  std::make_move_iterator(from->children.begin()),
+                                  std::make_move_iterator(from->children.end()));
+            into->counts.insert(into->counts.end(), from->counts.begin(), from->counts.end());
+            parent->keys.erase(parent->keys.begin() + index);
+            parent->children.erase(parent->children.begin() + index + 1);
+            if (Counted)
+            {
+                parent->counts.erase(parent->counts.begin() + index + 1);
+                recount(parent, index);
+            }
+
+            path.pop_back();
+            rebalance_inner(parent, path);
+        }
+
+        std::unique_ptr<node> m_root;
+        leaf_node *m_head = nullptr;
+        leaf_node *m_tail = nullptr;
+        size_type m_size = 0;
+        size_type m_order;
+        key_compare m_key_comp;
+        value_compare m_value_comp;
+        // Bumped by every modification, so cursors know to re-seek
+        std::uint64_t m_version = 0;
     };
 
-} // namespace ltc
\ No newline at end of file
+    template <class Key, class T, class Compare, bool Counted, class Stats>
+    void swap(basic_btree<Key, T, Compare, Counted, Stats> &a,
+              basic_btree<Key, T, Compare, Counted, Stats> &b)
+    {
+        a.swap(b);
+    }
+
+    using btree = basic_btree<std::string, std::string>;
+
+    template <class Key, class T, class Compare = std::less<Key>>
+    using counted_btree = basic_btree<Key, T, Compare, true>;
+} // namespace ltc
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+
+namespace ltc
+{
+    // lower_bound that searches outward from first: probes first[1], first[2], first[4]...
+    // until it passes value, then binary searches the last gap. Costs O(log d) comparisons
+    // for an answer d positions from first, which makes it cheap to walk a sorted range
+    // with sorted probes.
+    template <class RandomIt, class T, class Compare>
+    RandomIt exponential_lower_bound(RandomIt first, RandomIt last, const T &value, Compare comp)
+    {
+        using difference_type = typename std::iterator_traits<RandomIt>::difference_type;
+        const difference_type n = last - first;
+        if (n == 0 || !comp(*first, value)) return first;
+
+        // first[lo] < value; the answer is in (lo, hi]
+        difference_type lo = 0;
+        difference_type hi = 1;
+        while (hi < n && comp(first[hi], value))
+        {
+            lo = hi;
+            hi *= 2;
+        }
+        if (hi > n) hi = n;
+        return std::lower_bound(first + lo + 1, first + hi, value, comp);
+    }
+} // namespace ltc
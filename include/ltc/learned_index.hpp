@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ltc
+{
+    // A learned index over the sorted, unique integer keys of a frozen vset, vmap or amap.
+    // Keys are split into segments, each a line through its first key that predicts the
+    // position of every key in it to within epsilon, as in the PGM index. A lookup binary
+    // searches the few segment starts, which stay in cache, evaluates the line and then
+    // searches only the 2 epsilon + 3 positions around the prediction instead of the whole
+    // container. Every answer is checked against the edges of that window and falls back to
+    // a full binary search if the container no longer matches the model. Keys must be in
+    // ascending order of <.
+    template <class Key> class learned_index
+    {
+    public:
+        static_assert(std::is_integral<Key>::value, "learned_index needs integer keys");
+
+        using key_type = Key;
+        using size_type = std::size_t;
+
+        static constexpr size_type default_epsilon = 32;
+
+        learned_index() = default;
+
+        template <class Container>
+        explicit learned_index(const Container &c, size_type epsilon = default_epsilon)
+        : learned_index(c.begin(), c.end(), projection<Container>(), epsilon)
+        {
+        }
+
+        // Models the keys proj(*it) of [first, last)
+        template <class RandomIt, class Proj>
+        learned_index(RandomIt first, RandomIt last, Proj proj, size_type epsilon)
+        : m_size(static_cast<size_type>(last - first)), m_epsilon(epsilon)
+        {
+            build(first, proj);
+        }
+
+        // Positions [first, second) that hold the lower bound of key
+        std::pair<size_type, size_type> window(const key_type &key) const
+        {
+            const auto s = std::upper_bound(m_segments.begin(), m_segments.end(), key,
+                                            [](const key_type &k, const segment &seg) {
+                                                return k < seg.key;
+                                            });
+            if (s == m_segments.begin()) return std::make_pair(size_type(0), size_type(0));
+            const auto &seg = *(s - 1);
+            const double end = s == m_segments.end() ? double(m_size) : double(s->pos);
+            const double p = std::min(double(seg.pos) + seg.slope * distance(seg.key, key), end);
+            const auto pos = static_cast<size_type>(p);
+            const auto lo = pos > m_epsilon + 1 ? pos - m_epsilon - 1 : 0;
+            return std::make_pair(lo, std::min(m_size, pos + m_epsilon + 2));
+        }
+
+        // lower_bound over the keys proj(*it) of [first, last) the index was built from
+        template <class RandomIt, class Proj>
+        RandomIt lower_bound(RandomIt first, RandomIt last, const key_type &key, Proj proj) const
+        {
+            const auto less = [&proj](const auto &v, const key_type &k) { return proj(v) < k; };
+            const auto n = static_cast<size_type>(last - first);
+            if (n != m_size) return std::lower_bound(first, last, key, less);
+            const auto w = window(key);
+            const auto lo = first + w.first;
+            const auto hi = first + w.second;
+            const auto it = std::lower_bound(lo, hi, key, less);
+            if ((it == lo && w.first > 0 && !less(*(lo - 1), key)) ||
+                (it == hi && w.second < n && less(*hi, key)))
+                return std::lower_bound(first, last, key, less);
+            return it;
+        }
+
+        template <class Container>
+        typename Container::const_iterator lower_bound(const Container &c,
+                                                       const key_type &key) const
+        {
+            return lower_bound(c.begin(), c.end(), key, projection<Container>());
+        }
+
+        template <class Container>
+        typename Container::const_iterator find(const Container &c, const key_type &key) const
+        {
+            const auto proj = projection<Container>();
+            const auto it = lower_bound(c.begin(), c.end(), key, proj);
+            return it != c.end() && !(key < proj(*it)) ? it : c.end();
+        }
+
+        // Number of keys modelled
+        size_type size() const { return m_size; }
+        size_type epsilon() const { return m_epsilon; }
+        size_type segment_count() const { return m_segments.size(); }
+        size_type model_bytes() const { return m_segments.size() * sizeof(segment); }
+
+        // Mean number of positions searched when looking up the modelled keys
+        double average_window() const { return m_average_window; }
+
+    private:
+        struct segment
+        {
+            key_type key;  // first key
+            size_type pos; // its position
+            double slope;  // positions per key
+        };
+
+        struct identity_key
+        {
+            template <class K> const K &operator()(const K &k) const { return k; }
+        };
+
+        struct first_key
+        {
+            template <class P> const auto &operator()(const P &p) const { return p.first; }
+        };
+
+        template <class Container>
+        using projection = std::conditional_t<
+            std::is_same<typename Container::value_type, typename Container::key_type>::value,
+            identity_key,
+            first_key>;
+
+        // from <= to; exact for any two keys as the difference fits the unsigned type
+        static double distance(const key_type &from, const key_type &to)
+        {
+            using unsigned_type = std::make_unsigned_t<key_type>;
+            return double(static_cast<unsigned_type>(to) - static_cast<unsigned_type>(from));
+        }
+
+        // Greedy shrinking cone: a segment keeps the slopes that put every key so far within
+        // epsilon of its position, and ends at the first key that leaves none.
+        template <class RandomIt, class Proj> void build(RandomIt first, Proj proj)
+        {
+            if (m_size == 0) return;
+            const double eps = double(m_epsilon);
+            const double inf = std::numeric_limits<double>::infinity();
+            size_type start = 0;
+            double lo = 0;
+            double hi = inf;
+            const auto close = [&]() {
+                const double slope = hi == inf ? 0 : (lo + hi) / 2;
+                m_segments.push_back(segment{ proj(first[start]), start, slope });
+            };
+            for (size_type i = 1; i < m_size; ++i)
+            {
+                const key_type &x0 = proj(first[start]);
+                const key_type &x = proj(first[i]);
+                const double dy = double(i - start);
+                const double a = x0 < x ? (dy - eps) / distance(x0, x) : inf;
+                const double b = x0 < x ? (dy + eps) / distance(x0, x) : -inf;
+                if (std::max(lo, a) > std::min(hi, b))
+                {
+                    close();
+                    start = i;
+                    lo = 0;
+                    hi = inf;
+                    continue;
+                }
+                lo = std::max(lo, a);
+                hi = std::min(hi, b);
+            }
+            close();
+
+            double total = 0;
+            for (size_type i = 0; i < m_size; ++i)
+            {
+                const auto w = window(proj(first[i]));
+                total += double(w.second - w.first);
+            }
+            m_average_window = total / double(m_size);
+        }
+
+        std::vector<segment> m_segments;
+        size_type m_size = 0;
+        size_type m_epsilon = default_epsilon;
+        double m_average_window = 0;
+    };
+} // namespace ltc
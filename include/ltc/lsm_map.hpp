@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <ltc/bloom.hpp>
+#include <ltc/merge_view.hpp>
+#include <ltc/vmap.hpp>
+
+namespace ltc
+{
+    // A log-structured sorted map. Writes go to a small vmap memtable which is flushed to an
+    // immutable sorted run when full. Runs are compacted size-tiered: a run is merged with the
+    // run below it as long as that one is less than growth_factor times larger, so run sizes
+    // grow geometrically and a key is rewritten O(log n) times. Lookups check the memtable
+    // and then the runs newest first, skipping runs whose bloom filter excludes the key.
+    template <class Key, class T, class Compare = std::less<Key>, class Hash = std::hash<Key>>
+    class lsm_map
+    {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using size_type = std::size_t;
+        using key_compare = Compare;
+
+        explicit lsm_map(size_type memtable_limit = 4096,
+                         size_type growth_factor = 4,
+                         const Compare &comp = Compare())
+        : m_memtable(comp), m_memtable_limit(std::max<size_type>(memtable_limit, 1)),
+          m_growth_factor(std::max<size_type>(growth_factor, 2)), m_key_comp(comp)
+        {
+        }
+
+        // Modifiers
+        void insert_or_assign(const key_type &key, const mapped_type &value)
+        {
+            m_memtable[key] = entry{ value, false };
+            maybe_flush();
+        }
+
+        void insert_or_assign(key_type &&key, mapped_type &&value)
+        {
+            m_memtable[std::move(key)] = entry{ std::move(value), false };
+            maybe_flush();
+        }
+
+        // Records a tombstone for key. Older values are dropped when runs are compacted.
+        void erase(const key_type &key)
+        {
+            m_memtable[key] = entry{ mapped_type(), true };
+            maybe_flush();
+        }
+
+        void clear()
+        {
+            m_memtable.clear();
+            m_runs.clear();
+        }
+
+        // Moves the memtable into a new run, compacting runs as needed.
+        void flush()
+        {
+            if (m_memtable.empty()) return;
+            std::vector<record> records(std::make_move_iterator(m_memtable.begin()),
+                                        std::make_move_iterator(m_memtable.end()));
+            m_memtable.clear();
+            m_runs.push_back(make_run(std::move(records)));
+            while (m_runs.size() > 1 && m_runs[m_runs.size() - 2]->records.size() <
+                                        m_runs.back()->records.size() * m_growth_factor)
+            {
+                merge_last_two();
+            }
+        }
+
+        // Flushes and merges all runs into a single run without tombstones.
+        void compact()
+        {
+            flush();
+            while (m_runs.size() > 1)
+                merge_last_two();
+        }
+
+        // Lookup
+        bool find(const key_type &key, mapped_type &value) const
+        {
+            const auto it = m_memtable.find(key);
+            if (it != m_memtable.end())
+            {
+                if (it->second.erased) return false;
+                value = it->second.value;
+                return true;
+            }
+            for (auto run = m_runs.rbegin(); run != m_runs.rend(); ++run)
+            {
+                if (!(*run)->filter.possibly_contains(key)) continue;
+                const auto &records = (*run)->records;
+                const auto rec = std::lower_bound(records.begin(), records.end(), key,
+                                                  [this](const record &r, const key_type &k) {
+                                                      return m_key_comp(r.first, k);
+                                                  });
+                if (rec != records.end() && !m_key_comp(key, rec->first))
+                {
+                    if (rec->second.erased) return false;
+                    value = rec->second.value;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        mapped_type at(const key_type &key) const
+        {
+            mapped_type value;
+            if (!find(key, value)) throw std::out_of_range("key");
+            return value;
+        }
+
+        bool contains(const key_type &key) const
+        {
+            mapped_type value;
+            return find(key, value);
+        }
+
+        // Calls fn(const key_type&, const mapped_type&) for every live element in key order,
+        // merging the memtable and all runs. The newest version of a key wins.
+        template <class Fn> void for_each(Fn fn) const
+        {
+            using const_iterator = typename std::vector<record>::const_iterator;
+
+            // Newest first, so keep_first yields the newest version of each key
+            std::vector<std::pair<const_iterator, const_iterator>> runs;
+            // The memtable erases immediately, so its storage holds no tombstones to skip
+            runs.emplace_back(m_memtable.begin().base(), m_memtable.end().base());
+            for (auto run = m_runs.rbegin(); run != m_runs.rend(); ++run)
+                runs.emplace_back((*run)->records.begin(), (*run)->records.end());
+            for (const auto &r : merge_runs(std::move(runs), keep_first(), m_key_comp))
+                if (!r.second.erased) fn(r.first, r.second.value);
+        }
+
+        // Capacity
+        size_type memtable_size() const { return m_memtable.size(); }
+        size_type run_count() const { return m_runs.size(); }
+
+        // Number of records in all runs and the memtable, including shadowed versions and
+        // tombstones. An upper bound on the number of live keys.
+        size_type record_count() const
+        {
+            size_type total = m_memtable.size();
+            for (const auto &run : m_runs)
+                total += run->records.size();
+            return total;
+        }
+
+        key_compare key_comp() const { return m_key_comp; }
+
+    private:
+        struct entry
+        {
+            mapped_type value;
+            bool erased;
+        };
+
+        using record = std::pair<key_type, entry>;
+
+        struct run
+        {
+            run(std::vector<record> &&r, size_type bits, uint8_t hashes)
+            : records(std::move(r)), filter(bits, hashes)
+            {
+            }
+
+            const std::vector<record> records;
+            bloom_filter<key_type, Hash> filter;
+        };
+
+        // About 1% false positives at 10 bits per key and 7 hashes.
+        static constexpr size_type bloom_bits_per_key = 10;
+        static constexpr uint8_t bloom_hashes = 7;
+
+        static std::unique_ptr<run> make_run(std::vector<record> &&records)
+        {
+            const auto bits = std::max<size_type>(records.size() * bloom_bits_per_key, 64);
+            std::unique_ptr<run> r(new run(std::move(records), bits, bloom_hashes));
+            for (const auto &rec : r->records)
+                r->filter.add(rec.first);
+            return r;
+        }
+
+        void maybe_flush()
+        {
+            if (m_memtable.size() >= m_memtable_limit) flush();
+        }
+
+        // Merges the two newest runs. Tombstones are dropped once nothing older remains.
+        void merge_last_two()
+        {
+            const auto &newer = m_runs[m_runs.size() - 1]->records;
+            const auto &older = m_runs[m_runs.size() - 2]->records;
+            const bool bottom = m_runs.size() == 2;
+
+            std::vector<record> merged;
+            merged.reserve(newer.size() + older.size());
+            const auto emit = [&](const record &r) {
+                if (!(bottom && r.second.erased)) merged.push_back(r);
+            };
+
+            auto n = newer.begin();
+            auto o = older.begin();
+            while (n != newer.end() && o != older.end())
+            {
+                if (m_key_comp(n->first, o->first))
+                    emit(*n++);
+                else if (m_key_comp(o->first, n->first))
+                    emit(*o++);
+                else
+                {
+                    emit(*n++);
+                    ++o;
+                }
+            }
+            std::for_each(n, newer.end(), emit);
+            std::for_each(o, older.end(), emit);
+
+            m_runs.pop_back();
+            m_runs.back() = make_run(std::move(merged));
+        }
+
+        vmap<key_type, entry, Compare> m_memtable;
+        std::vector<std::unique_ptr<run>> m_runs; // oldest first
+        size_type m_memtable_limit;
+        size_type m_growth_factor;
+        key_compare m_key_comp;
+    };
+} // namespace ltc
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace ltc
+{
+    // A whole file mapped read-only into memory. Pages are read on first access and shared
+    // through the page cache with every other process that maps the same file.
+    class mapped_file final
+    {
+    public:
+        mapped_file() = default;
+
+        // Maps path, throwing std::runtime_error if it cannot be opened or mapped.
+        explicit mapped_file(const std::string &path);
+        ~mapped_file();
+
+        mapped_file(mapped_file &&other) noexcept;
+        mapped_file &operator=(mapped_file &&other) noexcept;
+
+        mapped_file(const mapped_file &) = delete;
+        mapped_file &operator=(const mapped_file &) = delete;
+
+        const char *data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+        bool is_open() const { return m_data != nullptr; }
+
+        void close();
+
+    private:
+        const char *m_data = nullptr;
+        std::size_t m_size = 0;
+    };
+} // namespace ltc
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <ltc/mapped_file.hpp>
+#include <ltc/range.hpp>
+#include <ltc/serialize.hpp>
+#include <ltc/span.hpp>
+
+namespace ltc
+{
+    namespace detail
+    {
+        // The sorted keys of a mapped file and the searches over them. With a sparse index
+        // a search first finds the block of index_stride keys in the small index, which
+        // stays in cache, and then touches only that block of the key array.
+        template <class Key, class Compare> class mapped_keys
+        {
+        public:
+            mapped_keys(const mapped_file &file,
+                        uint32_t value_size,
+                        bool has_values,
+                        const Compare &comp)
+            : m_comp(comp)
+            {
+                static_assert(std::is_trivially_copyable<Key>::value,
+                              "mapped files need trivially copyable keys");
+                static_assert(alignof(Key) <= binary_alignment, "key alignment");
+                if (file.size() < sizeof(binary_header)) throw std::runtime_error("truncated");
+                m_header = reinterpret_cast<const binary_header *>(file.data());
+                check_header(*m_header, file.size(), sizeof(Key), value_size, has_values);
+                m_keys = reinterpret_cast<const Key *>(file.data() + m_header->keys_offset);
+                if (m_header->index_count > 0)
+                    m_index = reinterpret_cast<const Key *>(file.data() + m_header->index_offset);
+            }
+
+            // Moving leaves other empty. The pointers stay valid as the mapping moves along
+            // with the mapped_file that owns it.
+            mapped_keys(mapped_keys &&other) noexcept
+            : m_header(std::exchange(other.m_header, nullptr)),
+              m_keys(std::exchange(other.m_keys, nullptr)),
+              m_index(std::exchange(other.m_index, nullptr)), m_comp(other.m_comp)
+            {
+            }
+
+            mapped_keys &operator=(mapped_keys &&other) noexcept
+            {
+                m_header = std::exchange(other.m_header, nullptr);
+                m_keys = std::exchange(other.m_keys, nullptr);
+                m_index = std::exchange(other.m_index, nullptr);
+                m_comp = other.m_comp;
+                return *this;
+            }
+
+            const binary_header &header() const { return *m_header; }
+            const Key *keys() const { return m_keys; }
+            std::size_t size() const
+            {
+                return m_header ? static_cast<std::size_t>(m_header->count) : 0;
+            }
+            const Compare &comp() const { return m_comp; }
+
+            std::size_t lower_bound(const Key &key) const
+            {
+                std::size_t first = 0;
+                std::size_t last = size();
+                if (m_index)
+                {
+                    const std::size_t stride = m_header->index_stride;
+                    const auto count = static_cast<std::size_t>(m_header->index_count);
+                    // index[j - 1] <= key < index[j], so the bound is in block j - 1
+                    const auto j = std::upper_bound(m_index, m_index + count, key, m_comp) -
+                                   m_index;
+                    if (j == 0) return 0;
+                    first = (j - 1) * stride;
+                    last = std::min(j * stride, last);
+                }
+                return std::lower_bound(m_keys + first, m_keys + last, key, m_comp) - m_keys;
+            }
+
+            // Position of key, or size() if it is not present
+            std::size_t find(const Key &key) const
+            {
+                const auto i = lower_bound(key);
+                return i != size() && !m_comp(key, m_keys[i]) ? i : size();
+            }
+
+            std::size_t upper_bound(const Key &key) const
+            {
+                const auto i = lower_bound(key);
+                return i != size() && !m_comp(key, m_keys[i]) ? i + 1 : i;
+            }
+
+        private:
+            const binary_header *m_header = nullptr;
+            const Key *m_keys = nullptr;
+            const Key *m_index = nullptr;
+            Compare m_comp;
+        };
+    } // namespace detail
+
+    // A read-only sorted map served straight from a file written by save_binary, with no
+    // deserialization. Opening it only maps the file; pages are read as lookups touch them
+    // and are shared by every process that maps the same file. Compare must order keys as
+    // the map that was saved did. Moving a mapped_vmap keeps its iterators valid.
+    template <class Key, class T, class Compare = std::less<Key>> class mapped_vmap
+    {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using size_type = std::size_t;
+        using key_compare = Compare;
+        using reference = std::pair<const Key &, const T &>;
+
+        // Random access iterator yielding pairs of references into the key and value arrays.
+        // It points into the mapping, not at the map.
+        class const_iterator final
+        : public iterator_facade<const_iterator, std::random_access_iterator_tag, reference>
+        {
+            friend class mapped_vmap;
+            friend iterator_access;
+
+        public:
+            const_iterator() = default;
+
+        private:
+            const_iterator(const Key *keys, const T *values, size_type i)
+            : m_keys(keys), m_values(values), m_i(i)
+            {
+            }
+
+            reference dereference() const { return reference(m_keys[m_i], m_values[m_i]); }
+            void increment() { ++m_i; }
+            void decrement() { --m_i; }
+            void advance(std::ptrdiff_t n) { m_i += n; }
+            std::ptrdiff_t distance_to(const const_iterator &o) const
+            {
+                return static_cast<std::ptrdiff_t>(o.m_i) - static_cast<std::ptrdiff_t>(m_i);
+            }
+            bool equal(const const_iterator &o) const { return m_i == o.m_i; }
+
+            const Key *m_keys = nullptr;
+            const T *m_values = nullptr;
+            size_type m_i = 0;
+        };
+
+        using iterator = const_iterator;
+
+        // Maps path, throwing std::runtime_error if it is not a map with these key and
+        // value types
+        explicit mapped_vmap(const std::string &path, const Compare &comp = Compare())
+        : mapped_vmap(mapped_file(path), comp)
+        {
+        }
+
+        explicit mapped_vmap(mapped_file &&file, const Compare &comp = Compare())
+        : m_file(std::move(file)), m_keys(m_file, sizeof(T), true, comp),
+          m_values(reinterpret_cast<const T *>(m_file.data() + m_keys.header().values_offset))
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "mapped files need trivially copyable values");
+            static_assert(alignof(T) <= binary_alignment, "value alignment");
+        }
+
+        mapped_vmap(const mapped_vmap &) = delete;
+        mapped_vmap &operator=(const mapped_vmap &) = delete;
+        mapped_vmap(mapped_vmap &&) = default;
+        mapped_vmap &operator=(mapped_vmap &&) = default;
+
+        // Iterators
+        const_iterator begin() const { return at_index(0); }
+        const_iterator end() const { return at_index(size()); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // Capacity
+        bool empty() const { return size() == 0; }
+        size_type size() const { return m_keys.size(); }
+
+        // Lookup
+        const mapped_type &at(const key_type &key) const
+        {
+            const auto i = m_keys.find(key);
+            if (i == size()) throw std::out_of_range("key");
+            return m_values[i];
+        }
+
+        size_type count(const key_type &key) const { return contains(key) ? 1 : 0; }
+        bool contains(const key_type &key) const { return m_keys.find(key) != size(); }
+
+        const_iterator find(const key_type &key) const
+        {
+            return at_index(m_keys.find(key));
+        }
+
+        const_iterator lower_bound(const key_type &key) const
+        {
+            return at_index(m_keys.lower_bound(key));
+        }
+
+        const_iterator upper_bound(const key_type &key) const
+        {
+            return at_index(m_keys.upper_bound(key));
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const
+        {
+            return std::make_pair(lower_bound(key), upper_bound(key));
+        }
+
+        // The key and value arrays
+        span<const Key> keys() const { return span<const Key>(m_keys.keys(), size()); }
+        span<const T> values() const { return span<const T>(m_values, size()); }
+
+        key_compare key_comp() const { return m_keys.comp(); }
+
+    private:
+        const_iterator at_index(size_type i) const
+        {
+            return const_iterator(m_keys.keys(), m_values, i);
+        }
+
+        mapped_file m_file;
+        detail::mapped_keys<Key, Compare> m_keys;
+        const T *m_values;
+    };
+
+    // A read-only sorted set served straight from a file written by save_binary. See
+    // mapped_vmap.
+    template <class Key, class Compare = std::less<Key>> class mapped_vset
+    {
+    public:
+        using key_type = Key;
+        using value_type = Key;
+        using size_type = std::size_t;
+        using key_compare = Compare;
+        using const_iterator = const Key *;
+        using iterator = const_iterator;
+
+        explicit mapped_vset(const std::string &path, const Compare &comp = Compare())
+        : mapped_vset(mapped_file(path), comp)
+        {
+        }
+
+        explicit mapped_vset(mapped_file &&file, const Compare &comp = Compare())
+        : m_file(std::move(file)), m_keys(m_file, 0, false, comp)
+        {
+        }
+
+        mapped_vset(const mapped_vset &) = delete;
+        mapped_vset &operator=(const mapped_vset &) = delete;
+        mapped_vset(mapped_vset &&) = default;
+        mapped_vset &operator=(mapped_vset &&) = default;
+
+        // Iterators
+        const_iterator begin() const { return m_keys.keys(); }
+        const_iterator end() const { return m_keys.keys() + size(); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // Capacity
+        bool empty() const { return size() == 0; }
+        size_type size() const { return m_keys.size(); }
+
+        // Lookup
+        size_type count(const key_type &key) const { return contains(key) ? 1 : 0; }
+        bool contains(const key_type &key) const { return m_keys.find(key) != size(); }
+        const_iterator find(const key_type &key) const { return begin() + m_keys.find(key); }
+
+        const_iterator lower_bound(const key_type &key) const
+        {
+            return begin() + m_keys.lower_bound(key);
+        }
+
+        const_iterator upper_bound(const key_type &key) const
+        {
+            return begin() + m_keys.upper_bound(key);
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const
+        {
+            return std::make_pair(lower_bound(key), upper_bound(key));
+        }
+
+        span<const Key> keys() const { return span<const Key>(begin(), size()); }
+
+        key_compare key_comp() const { return m_keys.comp(); }
+
+    private:
+        mapped_file m_file;
+        detail::mapped_keys<Key, Compare> m_keys;
+    };
+} // namespace ltc
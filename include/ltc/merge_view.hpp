@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ltc/range.hpp>
+#include <ltc/sorted_unique.hpp>
+
+namespace ltc
+{
+    // How a merge_view resolves elements with equivalent keys. Equivalent elements always
+    // come out of the inputs in input order, so first and last refer to that order.
+
+    // Yields every element
+    struct keep_all
+    {
+    };
+
+    // Yields the element from the earliest input
+    struct keep_first
+    {
+    };
+
+    // Yields the element from the latest input
+    struct keep_last
+    {
+    };
+
+    // Yields one element whose mapped value is fn(fn(a, b), c)... over the mapped values of
+    // the equivalent elements in input order. Needs a default constructible value_type.
+    template <class Fn> struct combine_values
+    {
+        Fn fn;
+    };
+
+    template <class Fn> combine_values<Fn> combine(Fn fn) { return combine_values<Fn>{ fn }; }
+
+    namespace detail
+    {
+        // The key of a map element or a set element
+        template <class K, class V> const K &merge_key(const std::pair<K, V> &v)
+        {
+            return v.first;
+        }
+
+        template <class K> const K &merge_key(const K &k) { return k; }
+
+        template <class Policy> struct is_combine : std::false_type
+        {
+        };
+
+        template <class Fn> struct is_combine<combine_values<Fn>> : std::true_type
+        {
+        };
+
+        template <class It>
+        using merge_key_t = std::decay_t<decltype(merge_key(*std::declval<It>()))>;
+    } // namespace detail
+
+    // Lazily merges N sorted runs into one sorted stream in O(log N) comparisons per element,
+    // using a loser tree: each inner node remembers the loser of the match played there, so
+    // replacing the winner replays only the matches on its path to the root. Runs are
+    // iterator pairs into containers that must outlive the view and stay unmodified while
+    // it is iterated.
+    template <class It,
+              class Policy = keep_all,
+              class Compare = std::less<detail::merge_key_t<It>>>
+    class merge_view
+    {
+    public:
+        using run_type = std::pair<It, It>;
+        using value_type = typename std::iterator_traits<It>::value_type;
+        using size_type = std::size_t;
+
+        class iterator final
+        : public iterator_facade<iterator, std::forward_iterator_tag, const value_type &>
+        {
+            friend class merge_view;
+            friend iterator_access;
+
+        public:
+            iterator() = default;
+
+        private:
+            using combining = detail::is_combine<Policy>;
+            struct none
+            {
+            };
+
+            explicit iterator(const merge_view *view) : m_view(view), m_done(false)
+            {
+                const auto k = view->m_runs.size();
+                m_pos.reserve(k);
+                for (const auto &run : view->m_runs)
+                    m_pos.push_back(run.first);
+                m_tree.resize(k);
+                if (k > 0) m_tree[0] = build(1);
+                settle(view->m_policy);
+            }
+
+            const value_type &dereference() const { return current(combining()); }
+            void increment() { settle(m_view->m_policy); }
+            bool equal(const iterator &o) const
+            {
+                return m_done == o.m_done && (m_done || m_pos == o.m_pos);
+            }
+
+            const value_type &current(std::false_type) const { return *m_current; }
+            const value_type &current(std::true_type) const { return m_combined; }
+
+            bool exhausted(size_type i) const { return m_pos[i] == m_view->m_runs[i].second; }
+
+            // Whether run a wins against run b: smaller key, then earlier run
+            bool beats(size_type a, size_type b) const
+            {
+                if (exhausted(a)) return false;
+                if (exhausted(b)) return true;
+                const auto &comp = m_view->m_comp;
+                const auto &ka = detail::merge_key(*m_pos[a]);
+                const auto &kb = detail::merge_key(*m_pos[b]);
+                if (comp(ka, kb)) return true;
+                if (comp(kb, ka)) return false;
+                return a < b;
+            }
+
+            // Plays the matches below node n and returns the winner. Node n has children 2n
+            // and 2n + 1, and node k + i is the leaf of run i.
+            size_type build(size_type n)
+            {
+                const auto k = m_pos.size();
+                if (n >= k) return n - k;
+                const auto a = build(2 * n);
+                const auto b = build(2 * n + 1);
+                const bool a_wins = beats(a, b);
+                m_tree[n] = a_wins ? b : a;
+                return a_wins ? a : b;
+            }
+
+            // Advances the current winner and replays its path to the root
+            void pop()
+            {
+                auto winner = m_tree[0];
+                ++m_pos[winner];
+                for (auto n = (winner + m_pos.size()) / 2; n > 0; n /= 2)
+                    if (beats(m_tree[n], winner)) std::swap(m_tree[n], winner);
+                m_tree[0] = winner;
+            }
+
+            // Whether the next element is equivalent to v
+            bool next_equivalent(const value_type &v) const
+            {
+                if (exhausted(m_tree[0])) return false;
+                const auto &next = *m_pos[m_tree[0]];
+                return !m_view->m_comp(detail::merge_key(v), detail::merge_key(next));
+            }
+
+            // Moves to the next group of equivalent elements and consumes it
+            bool start()
+            {
+                if (m_pos.empty() || exhausted(m_tree[0]))
+                {
+                    m_done = true;
+                    return false;
+                }
+                m_current = &*m_pos[m_tree[0]];
+                pop();
+                return true;
+            }
+
+            void settle(keep_all) { start(); }
+
+            void settle(keep_first)
+            {
+                if (!start()) return;
+                while (next_equivalent(*m_current))
+                    pop();
+            }
+
+            void settle(keep_last)
+            {
+                if (!start()) return;
+                while (next_equivalent(*m_current))
+                {
+                    m_current = &*m_pos[m_tree[0]];
+                    pop();
+                }
+            }
+
+            template <class Fn> void settle(const combine_values<Fn> &policy)
+            {
+                if (!start()) return;
+                m_combined = *m_current;
+                while (next_equivalent(m_combined))
+                {
+                    m_combined.second = policy.fn(m_combined.second, m_pos[m_tree[0]]->second);
+                    pop();
+                }
+            }
+
+            const merge_view *m_view = nullptr;
+            std::vector<It> m_pos;
+            std::vector<size_type> m_tree; // m_tree[0] is the winner, the rest losers
+            const value_type *m_current = nullptr;
+            std::conditional_t<combining::value, value_type, none> m_combined;
+            bool m_done = true;
+        };
+
+        using const_iterator = iterator;
+
+        explicit merge_view(std::vector<run_type> runs,
+                            const Policy &policy = Policy(),
+                            const Compare &comp = Compare())
+        : m_runs(std::move(runs)), m_policy(policy), m_comp(comp)
+        {
+        }
+
+        iterator begin() const { return iterator(this); }
+        iterator end() const { return iterator(); }
+
+        // Number of input elements, an upper bound of the number yielded
+        size_type input_size() const
+        {
+            size_type n = 0;
+            for (const auto &run : m_runs)
+                n += static_cast<size_type>(std::distance(run.first, run.second));
+            return n;
+        }
+
+        const std::vector<run_type> &runs() const { return m_runs; }
+
+    private:
+        std::vector<run_type> m_runs;
+        Policy m_policy;
+        Compare m_comp;
+    };
+
+    // Merges the given runs
+    template <class It,
+              class Policy = keep_all,
+              class Compare = std::less<detail::merge_key_t<It>>>
+    merge_view<It, Policy, Compare> merge_runs(std::vector<std::pair<It, It>> runs,
+                                               const Policy &policy = Policy(),
+                                               const Compare &comp = Compare())
+    {
+        return merge_view<It, Policy, Compare>(std::move(runs), policy, comp);
+    }
+
+    // Merges every container in a range of sorted containers, such as a vector of vsets
+    template <class Containers,
+              class Policy = keep_all,
+              class Compare = typename Containers::value_type::key_compare>
+    merge_view<typename Containers::value_type::const_iterator, Policy, Compare>
+    merge_containers(const Containers &containers,
+                     const Policy &policy = Policy(),
+                     const Compare &comp = Compare())
+    {
+        using It = typename Containers::value_type::const_iterator;
+        std::vector<std::pair<It, It>> runs;
+        for (const auto &c : containers)
+            runs.emplace_back(c.begin(), c.end());
+        return merge_view<It, Policy, Compare>(std::move(runs), policy, comp);
+    }
+
+    // Replaces the contents of a vmap, vset or amap with the merged stream. The storage is
+    // reserved for every input element and filled in order, without searches or sorting.
+    template <class It, class Policy, class Compare, class Container>
+    void merge_into(const merge_view<It, Policy, Compare> &view, Container &out)
+    {
+        static_assert(!std::is_same<Policy, keep_all>::value,
+                      "a unique container needs a policy that resolves duplicates");
+        typename Container::storage_type storage;
+        storage.reserve(std::min<std::size_t>(view.input_size(), storage.max_size()));
+        for (const auto &v : view)
+            storage.push_back(v);
+        out = Container(sorted_unique, std::move(storage), out.key_comp());
+    }
+} // namespace ltc
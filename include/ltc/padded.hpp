@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ltc/range.hpp>
+
+namespace ltc
+{
+    // Objects this many bytes apart never share a cache line. 64 bytes covers the
+    // destructive interference size of current x86 and most ARM cores. C++17's
+    // std::hardware_destructive_interference_size is not used: it is missing from C++14, and
+    // GCC warns that it may change between compiler flags.
+    constexpr std::size_t cache_line_size = 64;
+
+    // A T on cache lines of its own. Neighbouring padded objects, such as the elements of
+    // an array indexed by worker thread, never share a line, so workers that update their
+    // own element do not invalidate each other's caches (false sharing).
+    //
+    // Before C++17, operator new ignores the alignment of over-aligned types; keep padded
+    // objects on the heap with cache_aligned_allocator.
+    template <class T> struct alignas(cache_line_size) padded
+    {
+        padded() = default;
+
+        template <class... Args,
+                  class = std::enable_if_t<std::is_constructible<T, Args &&...>::value>>
+        explicit padded(Args &&... args) : value(std::forward<Args>(args)...)
+        {
+        }
+
+        T &operator*() { return value; }
+        const T &operator*() const { return value; }
+        T *operator->() { return &value; }
+        const T *operator->() const { return &value; }
+
+        T value{};
+    };
+
+    // Allocates on cache line boundaries whatever the language version, by over-allocating
+    // and keeping the pointer to free just before the aligned block
+    template <class T> struct cache_aligned_allocator
+    {
+        using value_type = T;
+
+        cache_aligned_allocator() = default;
+        template <class U> cache_aligned_allocator(const cache_aligned_allocator<U> &) noexcept {}
+
+        T *allocate(std::size_t n)
+        {
+            const auto extra = cache_line_size - 1 + sizeof(void *);
+            if (n > (std::numeric_limits<std::size_t>::max() - extra) / sizeof(T))
+                throw std::bad_alloc();
+            void *raw = ::operator new(n * sizeof(T) + extra);
+            auto addr = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *);
+            addr = (addr + cache_line_size - 1) & ~std::uintptr_t(cache_line_size - 1);
+            reinterpret_cast<void **>(addr)[-1] = raw;
+            return reinterpret_cast<T *>(addr);
+        }
+
+        void deallocate(T *p, std::size_t) noexcept
+        {
+            ::operator delete(reinterpret_cast<void **>(p)[-1]);
+        }
+    };
+
+    template <class T, class U>
+    bool operator==(const cache_aligned_allocator<T> &, const cache_aligned_allocator<U> &)
+    {
+        return true;
+    }
+
+    template <class T, class U>
+    bool operator!=(const cache_aligned_allocator<T> &, const cache_aligned_allocator<U> &)
+    {
+        return false;
+    }
+
+    // One T per worker thread, each on cache lines of its own. Workers update the instance
+    // at their own index, e.g. thread_pool::worker_index(), without locks or false sharing;
+    // combine() then folds the instances into one, for instance merging per-thread vsets.
+    template <class T> class per_thread
+    {
+        using slot = padded<T>;
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        template <bool Const>
+        class basic_iterator final
+        : public iterator_facade<basic_iterator<Const>,
+                                 std::random_access_iterator_tag,
+                                 std::conditional_t<Const, const T &, T &>>
+        {
+            friend class per_thread;
+            friend iterator_access;
+            using slot_pointer = std::conditional_t<Const, const slot *, slot *>;
+
+        public:
+            basic_iterator() = default;
+
+        private:
+            explicit basic_iterator(slot_pointer p) : m_slot(p) {}
+
+            std::conditional_t<Const, const T &, T &> dereference() const
+            {
+                return m_slot->value;
+            }
+            void increment() { ++m_slot; }
+            void decrement() { --m_slot; }
+            void advance(std::ptrdiff_t n) { m_slot += n; }
+            std::ptrdiff_t distance_to(const basic_iterator &o) const { return o.m_slot - m_slot; }
+            bool equal(const basic_iterator &o) const { return m_slot == o.m_slot; }
+
+            slot_pointer m_slot = nullptr;
+        };
+
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+        // count instances, at least one, copied from init. One per hardware thread by
+        // default.
+        explicit per_thread(size_type count = default_count(), const T &init = T())
+        {
+            count = std::max<size_type>(count, 1);
+            m_slots.reserve(count);
+            for (size_type i = 0; i < count; ++i)
+                m_slots.emplace_back(init);
+        }
+
+        static size_type default_count()
+        {
+            return std::max<size_type>(1, std::thread::hardware_concurrency());
+        }
+
+        size_type size() const { return m_slots.size(); }
+
+        T &operator[](size_type index) { return m_slots[index].value; }
+        const T &operator[](size_type index) const { return m_slots[index].value; }
+
+        iterator begin() { return iterator(m_slots.data()); }
+        const_iterator begin() const { return const_iterator(m_slots.data()); }
+        iterator end() { return iterator(m_slots.data() + m_slots.size()); }
+        const_iterator end() const { return const_iterator(m_slots.data() + m_slots.size()); }
+
+        // Folds the instances in index order: starts from a copy of the first and calls
+        // fn(result, instance) for each of the others, which merges instance into result
+        template <class Fn> T combine(Fn fn) const
+        {
+            T result = m_slots.front().value;
+            for (size_type i = 1; i < m_slots.size(); ++i)
+                fn(result, m_slots[i].value);
+            return result;
+        }
+
+    private:
+        std::vector<slot, cache_aligned_allocator<slot>> m_slots;
+    };
+} // namespace ltc
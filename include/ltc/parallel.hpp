@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include <ltc/thread_pool.hpp>
+
+namespace ltc
+{
+    // Data parallel loops over random access ranges (ltc::range, vmap, vset, std::vector...)
+    // run on a thread_pool. Work is split by recursive halving down to grain elements, so idle
+    // workers steal large halves first. A grain of 0 picks about 8 pieces per worker.
+
+    namespace detail
+    {
+        inline std::size_t pick_grain(std::size_t size, std::size_t grain, const thread_pool &pool)
+        {
+            if (grain != 0) return grain;
+            return std::max<std::size_t>(1, size / (8 * pool.size()));
+        }
+
+        // Calls fn(first, last) on the pieces [first + k * grain, first + (k + 1) * grain)
+        // of [first, last), the last piece possibly shorter.
+        template <class It, class Fn>
+        void split(task_group &group, It first, It last, std::size_t grain, const Fn &fn)
+        {
+            std::size_t size;
+            while ((size = static_cast<std::size_t>(last - first)) > grain)
+            {
+                const auto pieces = (size + grain - 1) / grain;
+                const auto mid = first + static_cast<std::ptrdiff_t>(pieces / 2 * grain);
+                group.run([&group, mid, last, grain, &fn]() {
+                    split(group, mid, last, grain, fn);
+                });
+                last = mid;
+            }
+            fn(first, last);
+        }
+
+        template <class It, class Fn>
+        void for_pieces(It first, It last, std::size_t grain, thread_pool &pool, const Fn &fn)
+        {
+            const auto size = static_cast<std::size_t>(last - first);
+            if (size == 0) return;
+            grain = pick_grain(size, grain, pool);
+            if (size <= grain)
+            {
+                fn(first, last);
+                return;
+            }
+            task_group group(pool);
+            split(group, first, last, grain, fn);
+            group.wait();
+        }
+    } // namespace detail
+
+    // Calls fn(element) for every element of [first, last), in no particular order.
+    template <class It, class Fn>
+    void parallel_for(It first,
+                      It last,
+                      Fn fn,
+                      std::size_t grain = 0,
+                      thread_pool &pool = thread_pool::instance())
+    {
+        detail::for_pieces(first, last, grain, pool, [&fn](It b, It e) {
+            for (; b != e; ++b)
+                fn(*b);
+        });
+    }
+
+    // Takes the range by forwarding reference, so fn may modify the elements of a container.
+    template <class Range, class Fn>
+    void parallel_for(Range &&range,
+                      Fn fn,
+                      std::size_t grain = 0,
+                      thread_pool &pool = thread_pool::instance())
+    {
+        parallel_for(range.begin(), range.end(), fn, grain, pool);
+    }
+
+    // Folds transform(element) for every element into init with reduce, which must be
+    // associative. Each piece starts from init, so init must be an identity of reduce.
+    template <class It, class T, class Reduce, class Transform>
+    T parallel_transform_reduce(It first,
+                                It last,
+                                T init,
+                                Reduce reduce,
+                                Transform transform,
+                                std::size_t grain = 0,
+                                thread_pool &pool = thread_pool::instance())
+    {
+        const auto size = static_cast<std::size_t>(last - first);
+        grain = detail::pick_grain(size, grain, pool);
+        const auto pieces = (size + grain - 1) / grain;
+
+        // One slot per piece, so the result does not depend on scheduling
+        std::vector<T> partial(pieces, init);
+        detail::for_pieces(first, last, grain, pool, [&](It b, It e) {
+            auto acc = init;
+            const auto slot = static_cast<std::size_t>(b - first) / grain;
+            for (; b != e; ++b)
+                acc = reduce(std::move(acc), transform(*b));
+            partial[slot] = std::move(acc);
+        });
+
+        for (auto &p : partial)
+            init = reduce(std::move(init), std::move(p));
+        return init;
+    }
+
+    template <class Range, class T, class Reduce, class Transform>
+    T parallel_transform_reduce(const Range &range,
+                                T init,
+                                Reduce reduce,
+                                Transform transform,
+                                std::size_t grain = 0,
+                                thread_pool &pool = thread_pool::instance())
+    {
+        return parallel_transform_reduce(range.begin(), range.end(), std::move(init), reduce,
+                                         transform, grain, pool);
+    }
+
+    template <class Range, class T, class Reduce = std::plus<T>>
+    T parallel_reduce(const Range &range,
+                      T init,
+                      Reduce reduce = Reduce(),
+                      std::size_t grain = 0,
+                      thread_pool &pool = thread_pool::instance())
+    {
+        using reference = decltype(*range.begin());
+        return parallel_transform_reduce(range.begin(), range.end(), std::move(init), reduce,
+                                         [](reference v) -> reference { return v; }, grain, pool);
+    }
+
+    // Sorts [first, last): pieces are sorted in parallel and then merged pairwise, with the
+    // merges of each round running in parallel.
+    template <class It, class Compare = std::less<typename std::iterator_traits<It>::value_type>>
+    void parallel_sort(It first,
+                       It last,
+                       Compare comp = Compare(),
+                       std::size_t grain = 0,
+                       thread_pool &pool = thread_pool::instance())
+    {
+        const auto size = static_cast<std::size_t>(last - first);
+        if (size < 2) return;
+        grain = std::max<std::size_t>(detail::pick_grain(size, grain, pool), 1024);
+        if (size <= grain)
+        {
+            std::sort(first, last, comp);
+            return;
+        }
+
+        // Equal pieces, so the merge tree stays balanced
+        std::vector<It> bounds;
+        for (std::size_t i = 0; i < size; i += grain)
+            bounds.push_back(first + i);
+        bounds.push_back(last);
+
+        {
+            task_group group(pool);
+            for (std::size_t i = 0; i + 1 < bounds.size(); ++i)
+            {
+                const auto b = bounds[i], e = bounds[i + 1];
+                group.run([b, e, &comp]() { std::sort(b, e, comp); });
+            }
+            group.wait();
+        }
+
+        while (bounds.size() > 2)
+        {
+            std::vector<It> merged;
+            task_group group(pool);
+            std::size_t i = 0;
+            for (; i + 2 < bounds.size(); i += 2)
+            {
+                const auto b = bounds[i], m = bounds[i + 1], e = bounds[i + 2];
+                group.run([b, m, e, &comp]() { std::inplace_merge(b, m, e, comp); });
+                merged.push_back(b);
+            }
+            // An odd piece out waits for the next round
+            for (; i < bounds.size(); ++i)
+                merged.push_back(bounds[i]);
+            group.wait();
+            bounds.swap(merged);
+        }
+    }
+
+    template <class Container, class Compare = std::less<typename Container::value_type>>
+    void parallel_sort(Container &c,
+                       Compare comp = Compare(),
+                       std::size_t grain = 0,
+                       thread_pool &pool = thread_pool::instance())
+    {
+        parallel_sort(c.begin(), c.end(), comp, grain, pool);
+    }
+} // namespace ltc
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+#include <ltc/bloom.hpp>
+#include <ltc/padded.hpp>
+#include <ltc/thread_pool.hpp>
+
+namespace ltc
+{
+    namespace detail
+    {
+        // Below this many keys per thread, build_from uses fewer threads
+        constexpr std::size_t bloom_min_keys_per_thread = 4096;
+    } // namespace detail
+
+    // Adds every key of a random access range to filter. The range is split over threads
+    // filters of the same configuration, filled on pool and then merged into filter.
+    template <class Key, class Hash, class Stats, class Range>
+    void build_from(bloom_filter<Key, Hash, Stats> &filter,
+                    const Range &keys,
+                    std::size_t threads = thread_pool::instance().size(),
+                    thread_pool &pool = thread_pool::instance())
+    {
+        using filter_type = bloom_filter<Key, Hash, Stats>;
+        const auto first = std::begin(keys);
+        const auto total = static_cast<std::size_t>(std::end(keys) - first);
+        threads = std::max<std::size_t>(
+            1, std::min(threads, total / detail::bloom_min_keys_per_thread));
+        if (threads == 1)
+        {
+            for (const auto &key : keys)
+                filter.add(key);
+            return;
+        }
+        per_thread<filter_type> parts(threads,
+                                      filter_type(filter.size(), filter.hashes(), filter.seed()));
+        {
+            task_group group(pool);
+            for (std::size_t t = 0; t < threads; ++t)
+                group.run([&parts, first, total, threads, t]() {
+                    const auto end = first + static_cast<std::ptrdiff_t>(total * (t + 1) /
+                                                                         threads);
+                    for (auto it = first + static_cast<std::ptrdiff_t>(total * t / threads);
+                         it != end; ++it)
+                        parts[t].add(*it);
+                });
+            group.wait();
+        }
+        for (const auto &part : parts)
+            filter.merge(part);
+    }
+} // namespace ltc
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <ltc/pma_vector.hpp>
+#include <ltc/vmap_base.hpp>
+
+namespace ltc
+{
+    // A sorted map stored in a packed memory array. Lookups cost O(log^2 n) instead of
+    // O(log n), but inserts and erases move O(log^2 n) elements amortized instead of O(n).
+    template <class Key, class T, class Compare = std::less<Key>, class Stats = no_stats>
+    class pma_map : public vmap_base<pma_vector<std::pair<Key, T>>, Compare, Stats>
+    {
+        using storage_type = pma_vector<std::pair<Key, T>>;
+        using base_type = vmap_base<storage_type, Compare, Stats>;
+
+    public:
+        pma_map() : base_type() {}
+
+        explicit pma_map(const Compare &comp) : base_type(comp) {}
+
+        pma_map(std::initializer_list<typename base_type::value_type> init, const Compare &comp = Compare())
+        : base_type(comp, storage_type(std::move(init)))
+        {
+        }
+
+        pma_map(const pma_map &other) : base_type(other) {}
+
+        pma_map(pma_map &&other) : base_type(std::move(other)) {}
+
+        template <class InputIt>
+        pma_map(InputIt first, InputIt last, const Compare &comp = Compare())
+        : base_type(comp, storage_type(first, last))
+        {
+        }
+
+        pma_map &operator=(const pma_map &other)
+        {
+            *(static_cast<base_type *>(this)) = other;
+            return *this;
+        }
+
+        pma_map &operator=(pma_map &&other)
+        {
+            *(static_cast<base_type *>(this)) = std::move(other);
+            return *this;
+        }
+
+        pma_map &operator=(std::initializer_list<typename base_type::value_type> ilist)
+        {
+            *(static_cast<base_type *>(this)) = std::move(ilist);
+            return *this;
+        }
+    };
+} // namespace ltc
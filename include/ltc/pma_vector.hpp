@@ -0,0 +1,487 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ltc
+{
+    // A sequence stored as a packed memory array: the slots are split into segments of
+    // O(log capacity) slots, each segment keeps its elements packed to the left and leaves
+    // the rest as gaps. An insert shifts within one segment, and when a segment is full the
+    // smallest enclosing window whose density is within bounds is spread out evenly, so an
+    // insert or erase moves O(log^2 n) elements amortized. Iteration stays nearly contiguous.
+    //
+    // Iterators are random access by rank: advancing by more than one element or computing
+    // the position of a rank costs O(log n) through a Fenwick tree over segment counts.
+    // This is what lets pma_vector serve as the Container of vmap_base.
+    template <class T> class pma_vector
+    {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+
+        template <bool Const> class basic_iterator
+        {
+            using owner_type = typename std::conditional<Const, const pma_vector, pma_vector>::type;
+
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = typename std::conditional<Const, const T *, T *>::type;
+            using reference = typename std::conditional<Const, const T &, T &>::type;
+
+            basic_iterator() = default;
+
+            template <bool OtherConst, class = typename std::enable_if<Const && !OtherConst>::type>
+            basic_iterator(const basic_iterator<OtherConst> &other)
+            : m_owner(other.m_owner), m_slot(other.m_slot), m_rank(other.m_rank)
+            {
+            }
+
+            reference operator*() const { return m_owner->m_slots[m_slot]; }
+            pointer operator->() const { return &m_owner->m_slots[m_slot]; }
+            reference operator[](difference_type n) const { return *(*this + n); }
+
+            basic_iterator &operator++()
+            {
+                m_slot = m_owner->next_slot(m_slot);
+                ++m_rank;
+                return *this;
+            }
+
+            basic_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            basic_iterator &operator--()
+            {
+                m_slot = m_owner->prev_slot(m_slot);
+                --m_rank;
+                return *this;
+            }
+
+            basic_iterator operator--(int)
+            {
+                auto tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            basic_iterator &operator+=(difference_type n)
+            {
+                if (n == 1) return ++*this;
+                if (n == -1) return --*this;
+                m_rank += n;
+                m_slot = m_owner->slot_of(m_rank);
+                return *this;
+            }
+
+            basic_iterator &operator-=(difference_type n) { return *this += -n; }
+
+            friend basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+            friend basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+            friend basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
+
+            template <bool C> difference_type operator-(const basic_iterator<C> &o) const
+            {
+                return static_cast<difference_type>(m_rank) - static_cast<difference_type>(o.m_rank);
+            }
+
+            template <bool C> bool operator==(const basic_iterator<C> &o) const { return m_rank == o.m_rank; }
+            template <bool C> bool operator!=(const basic_iterator<C> &o) const { return m_rank != o.m_rank; }
+            template <bool C> bool operator<(const basic_iterator<C> &o) const { return m_rank < o.m_rank; }
+            template <bool C> bool operator>(const basic_iterator<C> &o) const { return m_rank > o.m_rank; }
+            template <bool C> bool operator<=(const basic_iterator<C> &o) const { return m_rank <= o.m_rank; }
+            template <bool C> bool operator>=(const basic_iterator<C> &o) const { return m_rank >= o.m_rank; }
+
+            size_type rank() const { return m_rank; }
+
+        private:
+            friend class pma_vector;
+            template <bool> friend class basic_iterator;
+
+            basic_iterator(owner_type *owner, size_type slot, size_type rank)
+            : m_owner(owner), m_slot(slot), m_rank(rank)
+            {
+            }
+
+            owner_type *m_owner = nullptr;
+            size_type m_slot = 0;
+            size_type m_rank = 0;
+        };
+
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        // Construction
+        pma_vector() = default;
+
+        template <class InputIt> pma_vector(InputIt first, InputIt last) : m_buffer(first, last)
+        {
+            reallocate(capacity_for(m_buffer.size()));
+            spread(0, m_counts.size());
+        }
+
+        pma_vector(std::initializer_list<T> init) : pma_vector(init.begin(), init.end()) {}
+
+        pma_vector(const pma_vector &other) = default;
+
+        pma_vector(pma_vector &&other) noexcept { swap(other); }
+
+        pma_vector &operator=(const pma_vector &other) = default;
+
+        pma_vector &operator=(pma_vector &&other) noexcept
+        {
+            pma_vector tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+
+        pma_vector &operator=(std::initializer_list<T> ilist)
+        {
+            pma_vector tmp(ilist);
+            swap(tmp);
+            return *this;
+        }
+
+        // Iterators
+        iterator begin() noexcept { return iterator(this, slot_of(0), 0); }
+        const_iterator begin() const noexcept { return const_iterator(this, slot_of(0), 0); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return iterator(this, m_slots.size(), m_size); }
+        const_iterator end() const noexcept { return const_iterator(this, m_slots.size(), m_size); }
+        const_iterator cend() const noexcept { return end(); }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const noexcept { return rend(); }
+
+        // Capacity
+        bool empty() const noexcept { return m_size == 0; }
+        size_type size() const noexcept { return m_size; }
+        size_type max_size() const noexcept { return m_slots.max_size() / 2; }
+        size_type capacity() const noexcept { return m_slots.size(); }
+        size_type segment_size() const noexcept { return size_type(1) << m_segment_shift; }
+
+        void reserve(size_type new_cap)
+        {
+            const auto cap = capacity_for(new_cap);
+            if (cap <= m_slots.size()) return;
+            gather(0, m_counts.size());
+            reallocate(cap);
+            spread(0, m_counts.size());
+        }
+
+        void shrink_to_fit() { /* capacity follows the density thresholds */ }
+
+        // Element access
+        reference operator[](size_type pos) { return m_slots[slot_of(pos)]; }
+        const_reference operator[](size_type pos) const { return m_slots[slot_of(pos)]; }
+        reference front() { return *begin(); }
+        const_reference front() const { return *begin(); }
+        reference back() { return *rbegin(); }
+        const_reference back() const { return *rbegin(); }
+
+        // Modifiers
+        void clear() noexcept
+        {
+            m_slots.clear();
+            m_counts.clear();
+            m_tree.clear();
+            m_size = 0;
+            m_segment_shift = min_segment_shift;
+        }
+
+        iterator insert(const_iterator pos, const T &value) { return insert_at(pos.m_rank, value); }
+        iterator insert(const_iterator pos, T &&value) { return insert_at(pos.m_rank, std::move(value)); }
+
+        template <class... Args> iterator emplace(const_iterator pos, Args &&... args)
+        {
+            return insert_at(pos.m_rank, T(std::forward<Args>(args)...));
+        }
+
+        void push_back(const T &value) { insert_at(m_size, value); }
+        void push_back(T &&value) { insert_at(m_size, std::move(value)); }
+
+        iterator erase(const_iterator pos) { return erase_at(pos.m_rank); }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            const auto r0 = first.m_rank;
+            const auto count = last.m_rank - r0;
+            if (count <= segment_size())
+            {
+                for (size_type i = 0; i < count; ++i)
+                    erase_at(r0);
+            }
+            else
+            {
+                gather(0, m_counts.size());
+                m_buffer.erase(m_buffer.begin() + r0, m_buffer.begin() + r0 + count);
+                reallocate(capacity_for(m_buffer.size()));
+                spread(0, m_counts.size());
+            }
+            return iterator(this, slot_of(r0), r0);
+        }
+
+        void swap(pma_vector &other) noexcept
+        {
+            m_slots.swap(other.m_slots);
+            m_counts.swap(other.m_counts);
+            m_tree.swap(other.m_tree);
+            m_buffer.swap(other.m_buffer);
+            std::swap(m_size, other.m_size);
+            std::swap(m_segment_shift, other.m_segment_shift);
+        }
+
+    private:
+        static constexpr unsigned min_segment_shift = 3;
+        static constexpr size_type min_capacity = size_type(1) << min_segment_shift;
+
+        // Density bounds at the leaves (single segments) and at the root (the whole array);
+        // windows in between interpolate linearly by height.
+        static constexpr double upper_leaf = 1.0;
+        static constexpr double upper_root = 0.75;
+        static constexpr double lower_leaf = 0.125;
+        static constexpr double lower_root = 0.25;
+
+        static size_type capacity_for(size_type n)
+        {
+            size_type cap = min_capacity;
+            while (cap < 2 * n)
+                cap <<= 1;
+            return cap;
+        }
+
+        static unsigned log2(size_type n)
+        {
+            unsigned r = 0;
+            while (n >>= 1)
+                ++r;
+            return r;
+        }
+
+        size_type segment_count() const { return m_counts.size(); }
+
+        // Fenwick tree over the segment counts
+        void tree_add(size_type seg, difference_type delta)
+        {
+            for (auto i = seg + 1; i < m_tree.size(); i += i & (~i + 1))
+                m_tree[i] += delta;
+        }
+
+        // Number of elements in segments [0, seg)
+        size_type prefix(size_type seg) const
+        {
+            size_type sum = 0;
+            for (auto i = seg; i > 0; i -= i & (~i + 1))
+                sum += m_tree[i];
+            return sum;
+        }
+
+        // Slot of the element with the given rank, or capacity() for rank >= size()
+        size_type slot_of(size_type rank) const
+        {
+            if (rank >= m_size) return m_slots.size();
+            const auto segs = segment_count();
+            size_type pos = 0;
+            size_type rem = rank;
+            for (auto step = size_type(1) << log2(segs); step > 0; step >>= 1)
+            {
+                if (pos + step <= segs && m_tree[pos + step] <= rem)
+                {
+                    pos += step;
+                    rem -= m_tree[pos];
+                }
+            }
+            return (pos << m_segment_shift) + rem;
+        }
+
+        size_type next_slot(size_type slot) const
+        {
+            auto seg = slot >> m_segment_shift;
+            if (slot + 1 - (seg << m_segment_shift) < m_counts[seg]) return slot + 1;
+            while (++seg < segment_count())
+                if (m_counts[seg] > 0) return seg << m_segment_shift;
+            return m_slots.size();
+        }
+
+        size_type prev_slot(size_type slot) const
+        {
+            auto seg = slot >> m_segment_shift;
+            if (slot < m_slots.size() && slot > (seg << m_segment_shift)) return slot - 1;
+            while (seg-- > 0)
+                if (m_counts[seg] > 0) return (seg << m_segment_shift) + m_counts[seg] - 1;
+            return 0;
+        }
+
+        static double threshold(double leaf, double root, unsigned height, unsigned max_height)
+        {
+            return leaf - (leaf - root) * height / max_height;
+        }
+
+        // Moves the elements of segments [lo, hi) to the buffer
+        void gather(size_type lo, size_type hi)
+        {
+            m_buffer.clear();
+            for (auto seg = lo; seg < hi; ++seg)
+            {
+                const auto base = m_slots.begin() + (seg << m_segment_shift);
+                std::move(base, base + m_counts[seg], std::back_inserter(m_buffer));
+            }
+        }
+
+        // Moves the buffer back into segments [lo, hi), spreading it evenly
+        void spread(size_type lo, size_type hi)
+        {
+            const auto segs = hi - lo;
+            const auto n = m_buffer.size();
+            const auto seg_size = segment_size();
+            auto src = m_buffer.begin();
+            for (size_type j = 0; j < segs; ++j)
+            {
+                const auto count = ((j + 1) * n) / segs - (j * n) / segs;
+                const auto seg = lo + j;
+                const auto base = m_slots.begin() + (seg << m_segment_shift);
+                std::move(src, src + count, base);
+                std::fill(base + count, base + seg_size, T());
+                src += count;
+                tree_add(seg, static_cast<difference_type>(count) -
+                              static_cast<difference_type>(m_counts[seg]));
+                m_counts[seg] = count;
+            }
+            m_buffer.clear();
+        }
+
+        // Replaces the slot arrays with empty ones of the given capacity. The elements must
+        // have been gathered before and are spread again afterwards.
+        void reallocate(size_type cap)
+        {
+            // Segments of about log2(cap) slots, rounded up to a power of two
+            m_segment_shift = log2(log2(cap)) + 1;
+            if (m_segment_shift < min_segment_shift) m_segment_shift = min_segment_shift;
+            if (m_segment_shift > log2(cap)) m_segment_shift = log2(cap);
+            m_slots.assign(cap, T());
+            m_counts.assign(cap >> m_segment_shift, 0);
+            m_tree.assign(m_counts.size() + 1, 0);
+            m_size = m_buffer.size();
+        }
+
+        template <class U> iterator insert_at(size_type rank, U &&value)
+        {
+            if (m_slots.empty())
+            {
+                m_buffer.clear();
+                m_buffer.push_back(std::forward<U>(value));
+                reallocate(min_capacity);
+                spread(0, segment_count());
+                return begin();
+            }
+
+            // Insert in front of the element at rank, or behind the last element
+            const auto at = rank < m_size ? slot_of(rank) : (m_size ? slot_of(m_size - 1) + 1 : 0);
+            const auto seg = std::min(at >> m_segment_shift, segment_count() - 1);
+            const auto seg_size = segment_size();
+            if (m_counts[seg] < seg_size)
+            {
+                const auto base = m_slots.begin() + (seg << m_segment_shift);
+                const auto pos = m_slots.begin() + at;
+                std::move_backward(pos, base + m_counts[seg], base + m_counts[seg] + 1);
+                *pos = std::forward<U>(value);
+                ++m_counts[seg];
+                tree_add(seg, 1);
+                ++m_size;
+                return iterator(this, at, rank);
+            }
+
+            const auto max_height = log2(segment_count());
+            for (unsigned h = 1; h <= max_height; ++h)
+            {
+                const auto lo = seg & ~((size_type(1) << h) - 1);
+                const auto hi = lo + (size_type(1) << h);
+                const auto count = prefix(hi) - prefix(lo);
+                const auto window = double(seg_size << h);
+                if (count + 1 <= threshold(upper_leaf, upper_root, h, max_height) * window)
+                {
+                    const auto offset = rank - prefix(lo);
+                    gather(lo, hi);
+                    m_buffer.insert(m_buffer.begin() + offset, std::forward<U>(value));
+                    ++m_size;
+                    spread(lo, hi);
+                    return iterator(this, slot_of(rank), rank);
+                }
+            }
+
+            gather(0, segment_count());
+            m_buffer.insert(m_buffer.begin() + rank, std::forward<U>(value));
+            reallocate(m_slots.size() * 2);
+            spread(0, segment_count());
+            return iterator(this, slot_of(rank), rank);
+        }
+
+        iterator erase_at(size_type rank)
+        {
+            const auto at = slot_of(rank);
+            const auto seg = at >> m_segment_shift;
+            const auto base = m_slots.begin() + (seg << m_segment_shift);
+            const auto last = base + m_counts[seg];
+            std::move(m_slots.begin() + at + 1, last, m_slots.begin() + at);
+            *(last - 1) = T();
+            --m_counts[seg];
+            tree_add(seg, -1);
+            --m_size;
+
+            const auto seg_size = segment_size();
+            const auto max_height = log2(segment_count());
+            if (m_counts[seg] < lower_leaf * seg_size && max_height > 0)
+            {
+                if (m_slots.size() > min_capacity && m_size < lower_root * m_slots.size())
+                {
+                    gather(0, segment_count());
+                    reallocate(m_slots.size() / 2);
+                    spread(0, segment_count());
+                }
+                else
+                {
+                    for (unsigned h = 1; h <= max_height; ++h)
+                    {
+                        const auto lo = seg & ~((size_type(1) << h) - 1);
+                        const auto hi = lo + (size_type(1) << h);
+                        const auto count = prefix(hi) - prefix(lo);
+                        const auto window = double(seg_size << h);
+                        if (count >= threshold(lower_leaf, lower_root, h, max_height) * window)
+                        {
+                            gather(lo, hi);
+                            spread(lo, hi);
+                            break;
+                        }
+                    }
+                }
+            }
+            return iterator(this, slot_of(rank), rank);
+        }
+
+        std::vector<T> m_slots;
+        std::vector<size_type> m_counts; // elements per segment
+        std::vector<size_type> m_tree;   // Fenwick tree over m_counts
+        std::vector<T> m_buffer;         // scratch space for rebalancing
+        size_type m_size = 0;
+        unsigned m_segment_shift = min_segment_shift;
+    };
+} // namespace ltc
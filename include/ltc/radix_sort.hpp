@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ltc
+{
+    // Describes keys that can be radix sorted under Compare. Integers and std::string under
+    // std::less qualify; any other key or comparator is sorted by comparison.
+    template <class Key, class Compare, class = void> struct radix_key_traits
+    {
+        static constexpr bool enabled = false;
+    };
+
+    namespace detail
+    {
+        template <class Compare, class Key>
+        using is_default_less =
+            std::integral_constant<bool,
+                                   std::is_same<Compare, std::less<Key>>::value ||
+                                       std::is_same<Compare, std::less<>>::value>;
+    } // namespace detail
+
+    // Integers map to unsigned values in the same order, sorted a byte at a time from the
+    // least significant end (LSD)
+    template <class Key, class Compare>
+    struct radix_key_traits<Key,
+                            Compare,
+                            std::enable_if_t<std::is_integral<Key>::value &&
+                                             !std::is_same<Key, bool>::value &&
+                                             detail::is_default_less<Compare, Key>::value>>
+    {
+        static constexpr bool enabled = true;
+        static constexpr bool is_string = false;
+        using unsigned_type = std::make_unsigned_t<Key>;
+
+        static unsigned_type bits(Key key)
+        {
+            // Flipping the sign bit puts negative values first
+            const auto sign = std::is_signed<Key>::value
+                                  ? unsigned_type(1) << (sizeof(Key) * CHAR_BIT - 1)
+                                  : unsigned_type(0);
+            return static_cast<unsigned_type>(key) ^ sign;
+        }
+    };
+
+    // Strings compare as unsigned bytes, sorted from the most significant end (MSD)
+    template <class Compare>
+    struct radix_key_traits<std::string,
+                            Compare,
+                            std::enable_if_t<detail::is_default_less<Compare, std::string>::value>>
+    {
+        static constexpr bool enabled = true;
+        static constexpr bool is_string = true;
+    };
+
+    namespace detail
+    {
+        // Ranges shorter than this are sorted by comparison
+        constexpr std::size_t radix_cutoff = 64;
+
+        template <class RandomIt, class Proj>
+        void lsd_radix_sort(RandomIt first, RandomIt last, Proj proj)
+        {
+            using value_type = typename std::iterator_traits<RandomIt>::value_type;
+            using key_type = std::decay_t<decltype(proj(*first))>;
+            using traits = radix_key_traits<key_type, std::less<key_type>>;
+            constexpr std::size_t digits = sizeof(key_type);
+            const auto n = static_cast<std::size_t>(last - first);
+            const auto digit = [&proj](const value_type &v, std::size_t d) {
+                const auto bits = traits::bits(proj(v)) >> (d * CHAR_BIT);
+                return static_cast<std::size_t>(bits & 0xff);
+            };
+
+            // One pass counts every digit
+            std::array<std::array<std::size_t, 256>, digits> counts{};
+            for (auto it = first; it != last; ++it)
+                for (std::size_t d = 0; d < digits; ++d)
+                    ++counts[d][digit(*it, d)];
+
+            std::vector<value_type> buffer(n);
+            bool in_buffer = false;
+            for (std::size_t d = 0; d < digits; ++d)
+            {
+                auto &count = counts[d];
+                // A digit shared by every key leaves the order as it is
+                if (count[digit(in_buffer ? buffer[0] : *first, d)] == n) continue;
+                std::size_t offset = 0;
+                for (auto &c : count)
+                    offset += std::exchange(c, offset);
+                if (in_buffer)
+                    for (auto &v : buffer)
+                        first[count[digit(v, d)]++] = std::move(v);
+                else
+                    for (auto it = first; it != last; ++it)
+                        buffer[count[digit(*it, d)]++] = std::move(*it);
+                in_buffer = !in_buffer;
+            }
+            if (in_buffer) std::move(buffer.begin(), buffer.end(), first);
+        }
+
+        // Sorts [first, last), whose keys share their first depth bytes, by the bytes from
+        // depth on. buffer is scratch space of at least last - first elements.
+        template <class RandomIt, class Proj, class Buffer>
+        void msd_radix_sort(RandomIt first,
+                            RandomIt last,
+                            Proj proj,
+                            Buffer &buffer,
+                            std::size_t depth)
+        {
+            using value_type = typename std::iterator_traits<RandomIt>::value_type;
+            const auto n = static_cast<std::size_t>(last - first);
+            const auto less = [&proj](const value_type &a, const value_type &b) {
+                return proj(a) < proj(b);
+            };
+            // Bucket 0 holds keys that end at depth, bucket 1 + b those with byte b there
+            const auto bucket = [&proj, &depth](const value_type &v) -> std::size_t {
+                const auto &key = proj(v);
+                if (key.size() <= depth) return 0;
+                return 1 + static_cast<unsigned char>(key[depth]);
+            };
+
+            std::array<std::size_t, 257> count;
+            for (;;)
+            {
+                if (n < radix_cutoff)
+                {
+                    std::stable_sort(first, last, less);
+                    return;
+                }
+                count.fill(0);
+                for (auto it = first; it != last; ++it)
+                    ++count[bucket(*it)];
+                // Skip a byte shared by every key without moving anything
+                const auto shared = count[bucket(*first)] == n;
+                if (!shared || bucket(*first) == 0) break;
+                ++depth;
+            }
+            if (count[0] == n) return;
+
+            std::array<std::size_t, 257> start;
+            std::size_t offset = 0;
+            for (std::size_t b = 0; b < count.size(); ++b)
+            {
+                start[b] = offset;
+                offset += count[b];
+            }
+            auto next = start;
+            for (auto it = first; it != last; ++it)
+                buffer[next[bucket(*it)]++] = std::move(*it);
+            std::move(buffer.begin(), buffer.begin() + n, first);
+
+            for (std::size_t b = 1; b < count.size(); ++b)
+                if (count[b] > 1)
+                    msd_radix_sort(first + start[b], first + start[b] + count[b], proj, buffer,
+                                   depth + 1);
+        }
+
+        template <class RandomIt, class Proj, class Compare>
+        void comparison_sort(RandomIt first, RandomIt last, Proj proj, const Compare &comp)
+        {
+            using value_type = typename std::iterator_traits<RandomIt>::value_type;
+            std::stable_sort(first, last, [&](const value_type &a, const value_type &b) {
+                return comp(proj(a), proj(b));
+            });
+        }
+
+        template <class RandomIt, class Proj>
+        void radix_sort(RandomIt first, RandomIt last, Proj proj, std::false_type /*string*/)
+        {
+            lsd_radix_sort(first, last, proj);
+        }
+
+        template <class RandomIt, class Proj>
+        void radix_sort(RandomIt first, RandomIt last, Proj proj, std::true_type /*string*/)
+        {
+            std::vector<typename std::iterator_traits<RandomIt>::value_type> buffer(last - first);
+            msd_radix_sort(first, last, proj, buffer, 0);
+        }
+
+        template <class RandomIt, class Proj, class Compare>
+        void sort_by_key(RandomIt first,
+                         RandomIt last,
+                         Proj proj,
+                         const Compare &comp,
+                         std::false_type /*radix*/)
+        {
+            comparison_sort(first, last, proj, comp);
+        }
+
+        template <class RandomIt, class Proj, class Compare>
+        void sort_by_key(RandomIt first,
+                         RandomIt last,
+                         Proj proj,
+                         const Compare &comp,
+                         std::true_type /*radix*/)
+        {
+            using key_type = std::decay_t<decltype(proj(*first))>;
+            using traits = radix_key_traits<key_type, Compare>;
+            using is_string = std::integral_constant<bool, traits::is_string>;
+            if (static_cast<std::size_t>(last - first) < radix_cutoff)
+                comparison_sort(first, last, proj, comp);
+            else
+                radix_sort(first, last, proj, is_string());
+        }
+    } // namespace detail
+
+    // Stable sort of [first, last) by proj(element) under comp. Radix sorts when
+    // radix_key_traits allows it and the elements can be default constructed into a scratch
+    // buffer, and falls back to std::stable_sort otherwise.
+    template <class RandomIt, class Proj, class Compare>
+    void sort_by_key(RandomIt first, RandomIt last, Proj proj, const Compare &comp)
+    {
+        using value_type = typename std::iterator_traits<RandomIt>::value_type;
+        using key_type = std::decay_t<decltype(proj(*first))>;
+        using radix =
+            std::integral_constant<bool,
+                                   radix_key_traits<key_type, Compare>::enabled &&
+                                       std::is_default_constructible<value_type>::value &&
+                                       std::is_move_assignable<value_type>::value>;
+        detail::sort_by_key(first, last, proj, comp, radix());
+    }
+} // namespace ltc
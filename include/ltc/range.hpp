@@ -1,28 +1,82 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 namespace ltc
 {
+    // Half open range of values [b, e), iterated with random access iterators so that
+    // parallel algorithms and OpenMP loops can split it without walking it.
     template <typename T> struct range final
     {
         class iterator final
         {
         public:
-            using iterator_category = std::forward_iterator_tag;
+            using iterator_category = std::random_access_iterator_tag;
             using value_type = T;
             using difference_type = std::ptrdiff_t;
-            using pointer = T *;
-            using reference = T &;
+            using pointer = const T *;
+            using reference = T;
 
+            iterator() : m_value() {}
             iterator(const T &v) : m_value(v) {}
-            const iterator &operator++()
+
+            T operator*() const { return m_value; }
+            T operator[](difference_type n) const { return static_cast<T>(m_value + n); }
+
+            iterator &operator++()
             {
                 ++m_value;
                 return *this;
             }
+            iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++m_value;
+                return tmp;
+            }
+            iterator &operator--()
+            {
+                --m_value;
+                return *this;
+            }
+            iterator operator--(int)
+            {
+                auto tmp = *this;
+                --m_value;
+                return tmp;
+            }
+            iterator &operator+=(difference_type n)
+            {
+                m_value = static_cast<T>(m_value + n);
+                return *this;
+            }
+            iterator &operator-=(difference_type n)
+            {
+                m_value = static_cast<T>(m_value - n);
+                return *this;
+            }
+
+            friend iterator operator+(iterator it, difference_type n) { return it += n; }
+            friend iterator operator+(difference_type n, iterator it) { return it += n; }
+            friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const iterator &a, const iterator &b)
+            {
+                return static_cast<difference_type>(a.m_value) -
+                       static_cast<difference_type>(b.m_value);
+            }
+
+            bool operator==(const iterator &o) const { return o.m_value == m_value; }
             bool operator!=(const iterator &o) const { return o.m_value != m_value; }
-            T operator*() const { return m_value; }
+            bool operator<(const iterator &o) const { return m_value < o.m_value; }
+            bool operator>(const iterator &o) const { return m_value > o.m_value; }
+            bool operator<=(const iterator &o) const { return m_value <= o.m_value; }
+            bool operator>=(const iterator &o) const { return m_value >= o.m_value; }
 
         private:
             T m_value;
@@ -36,31 +90,82 @@ namespace ltc
         iterator begin() const { return m_begin; }
         iterator end() const { return m_end; }
 
+        std::size_t size() const { return static_cast<std::size_t>(end() - begin()); }
+        bool empty() const { return m_begin == m_end; }
+        T operator[](std::size_t n) const { return begin()[n]; }
+
         range() = delete;
 
     private:
         T m_begin, m_end;
     };
 
+    // The values of (b, e] in descending order: e, e - 1, ..., b + 1.
     template <typename T> struct reverse_range final
     {
         class iterator final
         {
         public:
-            using iterator_category = std::forward_iterator_tag;
+            using iterator_category = std::random_access_iterator_tag;
             using value_type = T;
             using difference_type = std::ptrdiff_t;
-            using pointer = T *;
-            using reference = T &;
+            using pointer = const T *;
+            using reference = T;
 
+            iterator() : m_value() {}
             iterator(const T &v) : m_value(v) {}
-            const iterator &operator++()
+
+            T operator*() const { return m_value; }
+            T operator[](difference_type n) const { return static_cast<T>(m_value - n); }
+
+            iterator &operator++()
             {
                 --m_value;
                 return *this;
             }
+            iterator operator++(int)
+            {
+                auto tmp = *this;
+                --m_value;
+                return tmp;
+            }
+            iterator &operator--()
+            {
+                ++m_value;
+                return *this;
+            }
+            iterator operator--(int)
+            {
+                auto tmp = *this;
+                ++m_value;
+                return tmp;
+            }
+            iterator &operator+=(difference_type n)
+            {
+                m_value = static_cast<T>(m_value - n);
+                return *this;
+            }
+            iterator &operator-=(difference_type n)
+            {
+                m_value = static_cast<T>(m_value + n);
+                return *this;
+            }
+
+            friend iterator operator+(iterator it, difference_type n) { return it += n; }
+            friend iterator operator+(difference_type n, iterator it) { return it += n; }
+            friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const iterator &a, const iterator &b)
+            {
+                return static_cast<difference_type>(b.m_value) -
+                       static_cast<difference_type>(a.m_value);
+            }
+
+            bool operator==(const iterator &o) const { return o.m_value == m_value; }
             bool operator!=(const iterator &o) const { return o.m_value != m_value; }
-            T operator*() const { return m_value; }
+            bool operator<(const iterator &o) const { return m_value > o.m_value; }
+            bool operator>(const iterator &o) const { return m_value < o.m_value; }
+            bool operator<=(const iterator &o) const { return m_value >= o.m_value; }
+            bool operator>=(const iterator &o) const { return m_value <= o.m_value; }
 
         private:
             T m_value;
@@ -75,6 +180,10 @@ namespace ltc
 
         iterator end() const { return m_end; }
 
+        std::size_t size() const { return static_cast<std::size_t>(end() - begin()); }
+        bool empty() const { return m_begin == m_end; }
+        T operator[](std::size_t n) const { return begin()[n]; }
+
         reverse_range() = delete;
         reverse_range(const reverse_range &) = delete;
 
@@ -82,6 +191,151 @@ namespace ltc
         T m_begin, m_end;
     };
 
+    // A contiguous part [first, last) of another range.
+    template <typename Iter> struct subrange final
+    {
+        using iterator = Iter;
+
+        subrange(Iter first, Iter last) : m_begin(first), m_end(last) {}
+
+        iterator begin() const { return m_begin; }
+        iterator end() const { return m_end; }
+        std::size_t size() const { return static_cast<std::size_t>(m_end - m_begin); }
+        bool empty() const { return m_begin == m_end; }
+
+    private:
+        Iter m_begin, m_end;
+    };
+
+    // Splits a random access range into subranges of grain elements (the last one may be
+    // shorter). The chunks are themselves random access, so they can be handed to parallel
+    // algorithms or an OpenMP loop as units of work.
+    template <typename Iter> struct chunked_range final
+    {
+        class iterator final
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = subrange<Iter>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type *;
+            using reference = value_type;
+
+            iterator() = default;
+
+            // Holds the range's bounds by value, so it stays valid after the chunked_range
+            // it came from, such as a temporary in a range-for, is gone
+            iterator(const chunked_range &owner, difference_type index)
+            : m_first(owner.m_first), m_count(owner.m_count), m_grain(owner.m_grain),
+              m_index(index)
+            {
+            }
+
+            value_type operator*() const { return make_chunk(m_first, m_count, m_grain, m_index); }
+            value_type operator[](difference_type n) const
+            {
+                return make_chunk(m_first, m_count, m_grain, m_index + n);
+            }
+
+            iterator &operator++()
+            {
+                ++m_index;
+                return *this;
+            }
+            iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++m_index;
+                return tmp;
+            }
+            iterator &operator--()
+            {
+                --m_index;
+                return *this;
+            }
+            iterator operator--(int)
+            {
+                auto tmp = *this;
+                --m_index;
+                return tmp;
+            }
+            iterator &operator+=(difference_type n)
+            {
+                m_index += n;
+                return *this;
+            }
+            iterator &operator-=(difference_type n)
+            {
+                m_index -= n;
+                return *this;
+            }
+
+            friend iterator operator+(iterator it, difference_type n) { return it += n; }
+            friend iterator operator+(difference_type n, iterator it) { return it += n; }
+            friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const iterator &a, const iterator &b)
+            {
+                return a.m_index - b.m_index;
+            }
+
+            bool operator==(const iterator &o) const { return m_index == o.m_index; }
+            bool operator!=(const iterator &o) const { return m_index != o.m_index; }
+            bool operator<(const iterator &o) const { return m_index < o.m_index; }
+            bool operator>(const iterator &o) const { return m_index > o.m_index; }
+            bool operator<=(const iterator &o) const { return m_index <= o.m_index; }
+            bool operator>=(const iterator &o) const { return m_index >= o.m_index; }
+
+        private:
+            Iter m_first{};
+            std::size_t m_count = 0;
+            std::size_t m_grain = 1;
+            difference_type m_index = 0;
+        };
+
+        chunked_range(Iter first, Iter last, std::size_t grain)
+        : m_first(first), m_count(last - first), m_grain(grain)
+        {
+            if (grain == 0) throw std::invalid_argument("grain");
+        }
+
+        iterator begin() const { return iterator(*this, 0); }
+        iterator end() const { return iterator(*this, static_cast<std::ptrdiff_t>(size())); }
+        std::size_t size() const { return (m_count + m_grain - 1) / m_grain; }
+        bool empty() const { return m_count == 0; }
+
+        subrange<Iter> chunk(std::ptrdiff_t index) const
+        {
+            return make_chunk(m_first, m_count, m_grain, index);
+        }
+
+        subrange<Iter> operator[](std::size_t index) const { return chunk(index); }
+
+    private:
+        static subrange<Iter>
+        make_chunk(Iter base, std::size_t count, std::size_t grain, std::ptrdiff_t index)
+        {
+            const auto first = static_cast<std::ptrdiff_t>(index * grain);
+            const auto last = std::min(first + static_cast<std::ptrdiff_t>(grain),
+                                       static_cast<std::ptrdiff_t>(count));
+            return subrange<Iter>(base + first, base + last);
+        }
+
+        Iter m_first;
+        std::size_t m_count;
+        std::size_t m_grain;
+    };
+
+    template <typename Range>
+    chunked_range<typename Range::iterator> chunked(const Range &range, std::size_t grain)
+    {
+        return chunked_range<typename Range::iterator>(range.begin(), range.end(), grain);
+    }
+
+    template <typename Iter> chunked_range<Iter> chunked(Iter first, Iter last, std::size_t grain)
+    {
+        return chunked_range<Iter>(first, last, grain);
+    }
+
     template <typename T, typename InputIter, typename Conv> struct transform_range final
     {
         class iterator final
@@ -129,9 +383,783 @@ namespace ltc
     }
 
     template <typename T, typename Range, typename Conv>
-    transform_range<T, typename Range:: iterator, Conv> make_transform(Range range, Conv conv)
+    transform_range<T, typename Range::iterator, Conv> make_transform(const Range &range, Conv conv)
     {
         return make_transform<T>(range.begin(), range.end(), conv);
     }
 
+    // Lazy range adaptors. Each view holds its base view and its functor once; iterators
+    // hold a pointer back to the view, so a view must outlive the iterators taken from it.
+    // Views compose with |:
+    //
+    //     for (auto &v : m | filter(is_odd) | transform(square) | take(10)) ...
+    //
+    // An lvalue range is referenced, an rvalue range (typically another view) is moved into
+    // the new view. Each view keeps the iterator category of its base where it can: filter
+    // is at most bidirectional, and take, stride, zip, enumerate and chunk stay random
+    // access over random access bases and are forward otherwise.
+
+    namespace detail
+    {
+        template <class R> using iterator_of_t = decltype(std::declval<const R &>().begin());
+
+        template <class It>
+        using category_of_t = typename std::iterator_traits<It>::iterator_category;
+
+        template <class It>
+        using is_random_access =
+            std::is_base_of<std::random_access_iterator_tag, category_of_t<It>>;
+
+        // Tag, weakened to at most Cap
+        template <class Tag, class Cap>
+        using clamp_category_t = std::conditional_t<std::is_base_of<Cap, Tag>::value, Cap, Tag>;
+
+        template <class A, class B>
+        using common_category_t = std::conditional_t<std::is_base_of<A, B>::value, A, B>;
+
+        // Holds a functor, as an empty base when possible so that a stateless functor adds
+        // nothing to the size of the view.
+        template <class F, bool = std::is_empty<F>::value && !std::is_final<F>::value>
+        class ebo_box : private F
+        {
+        public:
+            explicit ebo_box(F f) : F(std::move(f)) {}
+            const F &get() const { return *this; }
+        };
+
+        template <class F> class ebo_box<F, false>
+        {
+        public:
+            explicit ebo_box(F f) : m_f(std::move(f)) {}
+            const F &get() const { return m_f; }
+
+        private:
+            F m_f;
+        };
+    } // namespace detail
+
+    // Gives iterator_facade and its operators access to the private primitives of an
+    // iterator that declares it a friend.
+    class iterator_access
+    {
+    public:
+        template <class It> static decltype(auto) dereference(const It &it)
+        {
+            return it.dereference();
+        }
+        template <class It> static void increment(It &it) { it.increment(); }
+        template <class It> static void decrement(It &it) { it.decrement(); }
+        template <class It> static void advance(It &it, std::ptrdiff_t n) { it.advance(n); }
+        template <class It> static std::ptrdiff_t distance_to(const It &a, const It &b)
+        {
+            return a.distance_to(b);
+        }
+        template <class It> static bool equal(const It &a, const It &b) { return a.equal(b); }
+    };
+
+    // What operator-> returns for iterators that yield values rather than references
+    template <class T> struct arrow_proxy
+    {
+        const T *operator->() const { return &value; }
+        T value;
+    };
+
+    // Implements the operators of an iterator from a few primitives of Derived:
+    // dereference, increment and equal, plus decrement for bidirectional iterators and
+    // advance and distance_to for random access ones. Operators whose primitives are missing
+    // are only an error if used.
+    template <class Derived, class Category, class Reference> class iterator_facade
+    {
+    public:
+        using iterator_category = Category;
+        using value_type = std::remove_cv_t<std::remove_reference_t<Reference>>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<std::is_reference<Reference>::value,
+                                           std::add_pointer_t<Reference>,
+                                           arrow_proxy<Reference>>;
+        using reference = Reference;
+
+        reference operator*() const { return iterator_access::dereference(self()); }
+        pointer operator->() const { return arrow(std::is_reference<Reference>()); }
+        reference operator[](difference_type n) const { return *(self() + n); }
+
+        Derived &operator++()
+        {
+            iterator_access::increment(self());
+            return self();
+        }
+        Derived operator++(int)
+        {
+            auto tmp = self();
+            iterator_access::increment(self());
+            return tmp;
+        }
+        Derived &operator--()
+        {
+            iterator_access::decrement(self());
+            return self();
+        }
+        Derived operator--(int)
+        {
+            auto tmp = self();
+            iterator_access::decrement(self());
+            return tmp;
+        }
+        Derived &operator+=(difference_type n)
+        {
+            iterator_access::advance(self(), n);
+            return self();
+        }
+        Derived &operator-=(difference_type n)
+        {
+            iterator_access::advance(self(), -n);
+            return self();
+        }
+
+        friend Derived operator+(Derived it, difference_type n) { return it += n; }
+        friend Derived operator+(difference_type n, Derived it) { return it += n; }
+        friend Derived operator-(Derived it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const Derived &a, const Derived &b)
+        {
+            return iterator_access::distance_to(b, a);
+        }
+
+        friend bool operator==(const Derived &a, const Derived &b)
+        {
+            return iterator_access::equal(a, b);
+        }
+        friend bool operator!=(const Derived &a, const Derived &b)
+        {
+            return !iterator_access::equal(a, b);
+        }
+        friend bool operator<(const Derived &a, const Derived &b)
+        {
+            return iterator_access::distance_to(a, b) > 0;
+        }
+        friend bool operator>(const Derived &a, const Derived &b) { return b < a; }
+        friend bool operator<=(const Derived &a, const Derived &b) { return !(b < a); }
+        friend bool operator>=(const Derived &a, const Derived &b) { return !(a < b); }
+
+    private:
+        Derived &self() { return static_cast<Derived &>(*this); }
+        const Derived &self() const { return static_cast<const Derived &>(*this); }
+
+        pointer arrow(std::true_type) const { return std::addressof(**this); }
+        pointer arrow(std::false_type) const { return pointer{ **this }; }
+    };
+
+    // Non-owning view of an lvalue range
+    template <class R> class ref_view final
+    {
+    public:
+        using iterator = decltype(std::declval<R &>().begin());
+
+        ref_view(R &r) : m_range(std::addressof(r)) {}
+
+        iterator begin() const { return m_range->begin(); }
+        iterator end() const { return m_range->end(); }
+
+    private:
+        R *m_range;
+    };
+
+    // The view an adaptor stores for R: a ref_view of an lvalue, the moved value otherwise.
+    template <class R>
+    using view_t = std::conditional_t<std::is_lvalue_reference<R>::value,
+                                      ref_view<std::remove_reference_t<R>>,
+                                      std::decay_t<R>>;
+
+    template <class R> view_t<R> make_view(R &&r) { return view_t<R>(std::forward<R>(r)); }
+
+    // Base of the adaptor objects returned by filter(), transform() etc. Lets | find them.
+    struct range_adaptor
+    {
+    };
+
+    template <class R,
+              class Adaptor,
+              class = std::enable_if_t<std::is_base_of<range_adaptor, Adaptor>::value>>
+    auto operator|(R &&r, const Adaptor &adaptor)
+    {
+        return adaptor(std::forward<R>(r));
+    }
+
+    // transform: applies fn to each element
+    template <class V, class F> class transform_view final : private detail::ebo_box<F>
+    {
+        using base_iterator = detail::iterator_of_t<V>;
+        using category = detail::category_of_t<base_iterator>;
+        using element = decltype(std::declval<const F &>()(*std::declval<base_iterator>()));
+
+    public:
+        class iterator final : public iterator_facade<iterator, category, element>
+        {
+            using base = iterator_facade<iterator, category, element>;
+            friend iterator_access;
+
+        public:
+            iterator() = default;
+            iterator(const transform_view *view, base_iterator it) : m_view(view), m_it(it) {}
+
+        private:
+            typename base::reference dereference() const { return m_view->fn()(*m_it); }
+            void increment() { ++m_it; }
+            void decrement() { --m_it; }
+            void advance(std::ptrdiff_t n) { m_it += n; }
+            std::ptrdiff_t distance_to(const iterator &o) const { return o.m_it - m_it; }
+            bool equal(const iterator &o) const { return m_it == o.m_it; }
+
+            const transform_view *m_view = nullptr;
+            base_iterator m_it;
+        };
+
+        transform_view(V base, F fn) : detail::ebo_box<F>(std::move(fn)), m_base(std::move(base)) {}
+
+        iterator begin() const { return iterator(this, m_base.begin()); }
+        iterator end() const { return iterator(this, m_base.end()); }
+
+    private:
+        const F &fn() const { return this->get(); }
+
+        V m_base;
+    };
+
+    template <class F> struct transform_adaptor : range_adaptor
+    {
+        explicit transform_adaptor(F f) : fn(std::move(f)) {}
+
+        F fn;
+
+        template <class R> transform_view<view_t<R>, F> operator()(R &&r) const
+        {
+            return transform_view<view_t<R>, F>(make_view(std::forward<R>(r)), fn);
+        }
+    };
+
+    template <class F> transform_adaptor<F> transform(F fn) { return transform_adaptor<F>(fn); }
+
+    // filter: keeps the elements for which pred is true
+    template <class V, class Pred> class filter_view final : private detail::ebo_box<Pred>
+    {
+        using base_iterator = detail::iterator_of_t<V>;
+
+    public:
+        class iterator final
+        : public iterator_facade<iterator,
+                                 detail::clamp_category_t<detail::category_of_t<base_iterator>,
+                                                          std::bidirectional_iterator_tag>,
+                                 typename std::iterator_traits<base_iterator>::reference>
+        {
+            using base = iterator_facade<
+                iterator,
+                detail::clamp_category_t<detail::category_of_t<base_iterator>,
+                                         std::bidirectional_iterator_tag>,
+                typename std::iterator_traits<base_iterator>::reference>;
+            friend iterator_access;
+
+        public:
+            iterator() = default;
+            iterator(const filter_view *view, base_iterator it) : m_view(view), m_it(it) {}
+
+        private:
+            typename base::reference dereference() const { return *m_it; }
+            void increment() { m_it = m_view->next(++m_it); }
+            void decrement()
+            {
+                do
+                    --m_it;
+                while (!m_view->pred()(*m_it));
+            }
+            bool equal(const iterator &o) const { return m_it == o.m_it; }
+
+            const filter_view *m_view = nullptr;
+            base_iterator m_it;
+        };
+
+        filter_view(V base, Pred pred)
+        : detail::ebo_box<Pred>(std::move(pred)), m_base(std::move(base))
+        {
+        }
+
+        // Finds the first match, so begin() is linear in the number of leading rejects.
+        iterator begin() const { return iterator(this, next(m_base.begin())); }
+        iterator end() const { return iterator(this, m_base.end()); }
+
+    private:
+        const Pred &pred() const { return this->get(); }
+
+        base_iterator next(base_iterator it) const
+        {
+            const auto last = m_base.end();
+            while (it != last && !pred()(*it))
+                ++it;
+            return it;
+        }
+
+        V m_base;
+    };
+
+    template <class Pred> struct filter_adaptor : range_adaptor
+    {
+        explicit filter_adaptor(Pred p) : pred(std::move(p)) {}
+
+        Pred pred;
+
+        template <class R> filter_view<view_t<R>, Pred> operator()(R &&r) const
+        {
+            return filter_view<view_t<R>, Pred>(make_view(std::forward<R>(r)), pred);
+        }
+    };
+
+    template <class Pred> filter_adaptor<Pred> filter(Pred pred)
+    {
+        return filter_adaptor<Pred>(pred);
+    }
+
+    // take: the first n elements, or all if there are fewer. Over a random access base the
+    // iterators are the base iterators themselves.
+    template <class V, bool = detail::is_random_access<detail::iterator_of_t<V>>::value>
+    class take_view final
+    {
+    public:
+        using iterator = detail::iterator_of_t<V>;
+
+        take_view(V base, std::size_t n) : m_base(std::move(base)), m_count(n) {}
+
+        iterator begin() const { return m_base.begin(); }
+        iterator end() const
+        {
+            const auto first = m_base.begin();
+            const auto size = static_cast<std::size_t>(m_base.end() - first);
+            return first + static_cast<std::ptrdiff_t>(std::min(size, m_count));
+        }
+
+    private:
+        V m_base;
+        std::size_t m_count;
+    };
+
+    template <class V> class take_view<V, false> final
+    {
+        using base_iterator = detail::iterator_of_t<V>;
+
+    public:
+        // Ends when either the count runs out or the base ends
+        class iterator final
+        : public iterator_facade<iterator,
+                                 std::forward_iterator_tag,
+                                 typename std::iterator_traits<base_iterator>::reference>
+        {
+            using base = iterator_facade<iterator,
+                                         std::forward_iterator_tag,
+                                         typename std::iterator_traits<base_iterator>::reference>;
+            friend iterator_access;
+
+        public:
+            iterator() = default;
+            iterator(base_iterator it, std::size_t left) : m_it(it), m_left(left) {}
+
+        private:
+            typename base::reference dereference() const { return *m_it; }
+            void increment()
+            {
+                ++m_it;
+                --m_left;
+            }
+            bool equal(const iterator &o) const { return m_left == o.m_left || m_it == o.m_it; }
+
+            base_iterator m_it;
+            std::size_t m_left = 0;
+        };
+
+        take_view(V base, std::size_t n) : m_base(std::move(base)), m_count(n) {}
+
+        iterator begin() const { return iterator(m_base.begin(), m_count); }
+        iterator end() const { return iterator(m_base.end(), 0); }
+
+    private:
+        V m_base;
+        std::size_t m_count;
+    };
+
+    struct take_adaptor : range_adaptor
+    {
+        explicit take_adaptor(std::size_t n) : count(n) {}
+
+        std::size_t count;
+
+        template <class R> take_view<view_t<R>> operator()(R &&r) const
+        {
+            return take_view<view_t<R>>(make_view(std::forward<R>(r)), count);
+        }
+    };
+
+    inline take_adaptor take(std::size_t n) { return take_adaptor(n); }
+
+    // stride: every step'th element, starting with the first
+    template <class V, bool = detail::is_random_access<detail::iterator_of_t<V>>::value>
+    class stride_view final
+    {
+        using base_iterator = detail::iterator_of_t<V>;
+
+    public:
+        // Addresses element index * step of the base, so all moves are O(1)
+        class iterator final
+        : public iterator_facade<iterator,
+                                 std::random_access_iterator_tag,
+                                 typename std::iterator_traits<base_iterator>::reference>
+        {
+            using base = iterator_facade<iterator,
+                                         std::random_access_iterator_tag,
+                                         typename std::iterator_traits<base_iterator>::reference>;
+            friend iterator_access;
+
+        public:
+            iterator() = default;
+            iterator(base_iterator first, std::ptrdiff_t step, std::ptrdiff_t index)
+            : m_first(first), m_step(step), m_index(index)
+            {
+            }
+
+        private:
+            typename base::reference dereference() const { return m_first[m_index * m_step]; }
+            void increment() { ++m_index; }
+            void decrement() { --m_index; }
+            void advance(std::ptrdiff_t n) { m_index += n; }
+            std::ptrdiff_t distance_to(const iterator &o) const { return o.m_index - m_index; }
+            bool equal(const iterator &o) const { return m_index == o.m_index; }
+
+            base_iterator m_first;
+            std::ptrdiff_t m_step = 1;
+            std::ptrdiff_t m_index = 0;
+        };
+
+        stride_view(V base, std::size_t step) : m_base(std::move(base)), m_step(step)
+        {
+            if (step == 0) throw std::invalid_argument("step");
+        }
+
+        iterator begin() const { return iterator(m_base.begin(), step(), 0); }
+        iterator end() const
+        {
+            const auto size = m_base.end() - m_base.begin();
+            return iterator(m_base.begin(), step(), (size + step() - 1) / step());
+        }
+
+    private:
+        std::ptrdiff_t step() const { return static_cast<std::ptrdiff_t>(m_step); }
+
+        V m_base;
+        std::size_t m_step;
+    };
+
+    template <class V> class stride_view<V, false> final
+    {
+        using base_iterator = detail::iterator_of_t<V>;
+
+    public:
+        class iterator final
+        : public iterator_facade<iterator,
+                                 std::forward_iterator_tag,
+                                 typename std::iterator_traits<base_iterator>::reference>
+        {
+            using base = iterator_facade<iterator,
+                                         std::forward_iterator_tag,
+                                         typename std::iterator_traits<base_iterator>::reference>;
+            friend iterator_access;
+
+        public:
+            iterator() = default;
+            iterator(base_iterator it, base_iterator last, std::size_t step)
+            : m_it(it), m_last(last), m_step(step)
+            {
+            }
+
+        private:
+            typename base::reference dereference() const { return *m_it; }
+            void increment()
+            {
+                for (std::size_t i = 0; i < m_step && m_it != m_last; ++i)
+                    ++m_it;
+            }
+            bool equal(const iterator &o) const { return m_it == o.m_it; }
+
+            base_iterator m_it, m_last;
+            std::size_t m_step = 1;
+        };
+
+        stride_view(V base, std::size_t step) : m_base(std::move(base)), m_step(step)
+        {
+            if (step == 0) throw std::invalid_argument("step");
+        }
+
+        iterator begin() const { return iterator(m_base.begin(), m_base.end(), m_step); }
+        iterator end() const { return iterator(m_base.end(), m_base.end(), m_step); }
+
+    private:
+        V m_base;
+        std::size_t m_step;
+    };
+
+    struct stride_adaptor : range_adaptor
+    {
+        explicit stride_adaptor(std::size_t n) : step(n) {}
+
+        std::size_t step;
+
+        template <class R> stride_view<view_t<R>> operator()(R &&r) const
+        {
+            return stride_view<view_t<R>>(make_view(std::forward<R>(r)), step);
+        }
+    };
+
+    inline stride_adaptor stride(std::size_t step) { return stride_adaptor(step); }
+
+    // enumerate: pairs of (index, element)
+    template <class V> class enumerate_view final
+    {
+        using base_iterator = detail::iterator_of_t<V>;
+        using category = detail::clamp_category_t<
+            detail::category_of_t<base_iterator>,
+            std::conditional_t<detail::is_random_access<base_iterator>::value,
+                               std::random_access_iterator_tag,
+                               std::forward_iterator_tag>>;
+        using element =
+            std::pair<std::size_t, typename std::iterator_traits<base_iterator>::reference>;
+
+    public:
+        class iterator final : public iterator_facade<iterator, category, element>
+        {
+            using base = iterator_facade<iterator, category, element>;
+            friend iterator_access;
+
+        public:
+            iterator() = default;
+            iterator(base_iterator it, std::size_t index) : m_it(it), m_index(index) {}
+
+        private:
+            element dereference() const { return element(m_index, *m_it); }
+            void increment()
+            {
+                ++m_it;
+                ++m_index;
+            }
+            void decrement()
+            {
+                --m_it;
+                --m_index;
+            }
+            void advance(std::ptrdiff_t n)
+            {
+                m_it += n;
+                m_index += n;
+            }
+            std::ptrdiff_t distance_to(const iterator &o) const { return o.m_it - m_it; }
+            bool equal(const iterator &o) const { return m_it == o.m_it; }
+
+            base_iterator m_it;
+            std::size_t m_index = 0;
+        };
+
+        explicit enumerate_view(V base) : m_base(std::move(base)) {}
+
+        iterator begin() const { return iterator(m_base.begin(), 0); }
+        iterator end() const
+        {
+            return iterator(m_base.end(), end_index(detail::is_random_access<base_iterator>()));
+        }
+
+    private:
+        std::size_t end_index(std::true_type) const
+        {
+            return static_cast<std::size_t>(m_base.end() - m_base.begin());
+        }
+        std::size_t end_index(std::false_type) const { return 0; }
+
+        V m_base;
+    };
+
+    struct enumerate_adaptor : range_adaptor
+    {
+        template <class R> enumerate_view<view_t<R>> operator()(R &&r) const
+        {
+            return enumerate_view<view_t<R>>(make_view(std::forward<R>(r)));
+        }
+    };
+
+    constexpr enumerate_adaptor enumerate{};
+
+    // zip: pairs of elements of two ranges, as long as the shorter one
+    template <class V1, class V2> class zip_view final
+    {
+        using iterator1 = detail::iterator_of_t<V1>;
+        using iterator2 = detail::iterator_of_t<V2>;
+        static constexpr bool random_access =
+            detail::is_random_access<iterator1>::value &&
+            detail::is_random_access<iterator2>::value;
+        using category = std::conditional_t<random_access,
+                                            std::random_access_iterator_tag,
+                                            detail::common_category_t<
+                                                std::forward_iterator_tag,
+                                                detail::common_category_t<
+                                                    detail::category_of_t<iterator1>,
+                                                    detail::category_of_t<iterator2>>>>;
+        using element = std::pair<typename std::iterator_traits<iterator1>::reference,
+                                  typename std::iterator_traits<iterator2>::reference>;
+
+    public:
+        class iterator final : public iterator_facade<iterator, category, element>
+        {
+            using base = iterator_facade<iterator, category, element>;
+            friend iterator_access;
+
+        public:
+            iterator() = default;
+            iterator(iterator1 it1, iterator2 it2) : m_it1(it1), m_it2(it2) {}
+
+        private:
+            element dereference() const { return element(*m_it1, *m_it2); }
+            void increment()
+            {
+                ++m_it1;
+                ++m_it2;
+            }
+            void decrement()
+            {
+                --m_it1;
+                --m_it2;
+            }
+            void advance(std::ptrdiff_t n)
+            {
+                m_it1 += n;
+                m_it2 += n;
+            }
+            std::ptrdiff_t distance_to(const iterator &o) const { return o.m_it1 - m_it1; }
+            // Either side reaching its end ends the zip
+            bool equal(const iterator &o) const { return m_it1 == o.m_it1 || m_it2 == o.m_it2; }
+
+            iterator1 m_it1;
+            iterator2 m_it2;
+        };
+
+        zip_view(V1 base1, V2 base2) : m_base1(std::move(base1)), m_base2(std::move(base2)) {}
+
+        iterator begin() const { return iterator(m_base1.begin(), m_base2.begin()); }
+        iterator end() const { return end(std::integral_constant<bool, random_access>()); }
+
+    private:
+        iterator end(std::true_type) const
+        {
+            const auto n =
+                std::min(m_base1.end() - m_base1.begin(), m_base2.end() - m_base2.begin());
+            return iterator(m_base1.begin() + n, m_base2.begin() + n);
+        }
+        iterator end(std::false_type) const { return iterator(m_base1.end(), m_base2.end()); }
+
+        V1 m_base1;
+        V2 m_base2;
+    };
+
+    template <class R1, class R2> zip_view<view_t<R1>, view_t<R2>> zip(R1 &&r1, R2 &&r2)
+    {
+        return zip_view<view_t<R1>, view_t<R2>>(make_view(std::forward<R1>(r1)),
+                                                make_view(std::forward<R2>(r2)));
+    }
+
+    // chunk: consecutive subranges of size elements, the last one possibly shorter. Random
+    // access inputs are split by chunked_range, so its chunks are random access too.
+    template <class V, bool = detail::is_random_access<detail::iterator_of_t<V>>::value>
+    class chunk_view final
+    {
+        using base_iterator = detail::iterator_of_t<V>;
+
+    public:
+        using iterator = typename chunked_range<base_iterator>::iterator;
+
+        chunk_view(V base, std::size_t size) : m_base(std::move(base)), m_size(size)
+        {
+            if (size == 0) throw std::invalid_argument("size");
+        }
+
+        iterator begin() const { return chunks().begin(); }
+        iterator end() const { return chunks().end(); }
+
+    private:
+        chunked_range<base_iterator> chunks() const
+        {
+            return chunked_range<base_iterator>(m_base.begin(), m_base.end(), m_size);
+        }
+
+        V m_base;
+        std::size_t m_size;
+    };
+
+    template <class V> class chunk_view<V, false> final
+    {
+        using base_iterator = detail::iterator_of_t<V>;
+
+    public:
+        class iterator final
+        : public iterator_facade<iterator, std::forward_iterator_tag, subrange<base_iterator>>
+        {
+            using base =
+                iterator_facade<iterator, std::forward_iterator_tag, subrange<base_iterator>>;
+            friend iterator_access;
+
+        public:
+            iterator() = default;
+            iterator(base_iterator it, base_iterator last, std::size_t size)
+            : m_it(it), m_next(it), m_last(last), m_size(size)
+            {
+                step();
+            }
+
+        private:
+            subrange<base_iterator> dereference() const
+            {
+                return subrange<base_iterator>(m_it, m_next);
+            }
+            void increment()
+            {
+                m_it = m_next;
+                step();
+            }
+            bool equal(const iterator &o) const { return m_it == o.m_it; }
+
+            void step()
+            {
+                for (std::size_t i = 0; i < m_size && m_next != m_last; ++i)
+                    ++m_next;
+            }
+
+            base_iterator m_it, m_next, m_last;
+            std::size_t m_size = 1;
+        };
+
+        chunk_view(V base, std::size_t size) : m_base(std::move(base)), m_size(size)
+        {
+            if (size == 0) throw std::invalid_argument("size");
+        }
+
+        iterator begin() const { return iterator(m_base.begin(), m_base.end(), m_size); }
+        iterator end() const { return iterator(m_base.end(), m_base.end(), m_size); }
+
+    private:
+        V m_base;
+        std::size_t m_size;
+    };
+
+    struct chunk_adaptor : range_adaptor
+    {
+        explicit chunk_adaptor(std::size_t n) : size(n) {}
+
+        std::size_t size;
+
+        template <class R> chunk_view<view_t<R>> operator()(R &&r) const
+        {
+            return chunk_view<view_t<R>>(make_view(std::forward<R>(r)), size);
+        }
+    };
+
+    inline chunk_adaptor chunk(std::size_t size) { return chunk_adaptor(size); }
 }
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ltc/sorted_unique.hpp>
+
+namespace ltc
+{
+    // Binary format of a sorted map or set with trivially copyable keys and values, in the
+    // byte order of the machine that wrote it:
+    //
+    //   binary_header
+    //   keys      count keys in order
+    //   values    count values, keys[i] maps to values[i]; absent for sets
+    //   index     every index_stride-th key, a small top level for searches; optional
+    //
+    // Each section starts at a multiple of binary_alignment, so a memory mapped file can be
+    // used in place. See mapped_vmap and mapped_vset.
+    struct binary_header
+    {
+        char magic[4];
+        uint32_t byte_order; // binary_byte_order as written
+        uint32_t version;
+        uint32_t has_values;
+        uint32_t key_size;
+        uint32_t value_size;
+        uint32_t index_stride; // 0 when there is no index
+        uint32_t reserved;
+        uint64_t count;
+        uint64_t keys_offset;
+        uint64_t values_offset;
+        uint64_t index_offset;
+        uint64_t index_count;
+        uint64_t file_size;
+    };
+
+    static_assert(sizeof(binary_header) == 80, "binary_header must have no padding");
+
+    constexpr uint32_t binary_version = 1;
+    constexpr uint32_t binary_byte_order = 0x01020304;
+    constexpr size_t binary_alignment = 64;
+    constexpr uint32_t default_index_stride = 64;
+
+    namespace detail
+    {
+        template <class T> struct is_pair : std::false_type
+        {
+        };
+
+        template <class A, class B> struct is_pair<std::pair<A, B>> : std::true_type
+        {
+        };
+
+        inline uint64_t align_binary(uint64_t offset)
+        {
+            if (offset > std::numeric_limits<uint64_t>::max() - (binary_alignment - 1))
+                throw std::runtime_error("size overflow");
+            return (offset + binary_alignment - 1) / binary_alignment * binary_alignment;
+        }
+
+        // End of a section of count elements of size bytes starting at offset. Throws
+        // std::runtime_error if it does not fit in 64 bits, as a corrupt count may ask.
+        inline uint64_t section_end(uint64_t offset, uint64_t count, uint64_t size)
+        {
+            if (size != 0 && count > (std::numeric_limits<uint64_t>::max() - offset) / size)
+                throw std::runtime_error("size overflow");
+            return offset + count * size;
+        }
+
+        // Lays out the sections for count elements
+        inline binary_header make_header(uint64_t count,
+                                         uint32_t key_size,
+                                         uint32_t value_size,
+                                         bool has_values,
+                                         uint32_t index_stride)
+        {
+            binary_header h{};
+            std::memcpy(h.magic, "LTCB", 4);
+            h.byte_order = binary_byte_order;
+            h.version = binary_version;
+            h.has_values = has_values ? 1 : 0;
+            h.key_size = key_size;
+            h.value_size = has_values ? value_size : 0;
+            h.count = count;
+            h.keys_offset = align_binary(sizeof(binary_header));
+            auto end = section_end(h.keys_offset, count, key_size);
+            if (has_values)
+            {
+                h.values_offset = align_binary(end);
+                end = section_end(h.values_offset, count, value_size);
+            }
+            if (index_stride > 0 && count > index_stride)
+            {
+                h.index_stride = index_stride;
+                h.index_count = count / index_stride + (count % index_stride != 0 ? 1 : 0);
+                h.index_offset = align_binary(end);
+                end = section_end(h.index_offset, h.index_count, key_size);
+            }
+            h.file_size = end;
+            return h;
+        }
+
+        // Throws std::runtime_error unless h describes a file of size bytes with the given
+        // key and value sizes
+        inline void check_header(const binary_header &h,
+                                 uint64_t size,
+                                 uint32_t key_size,
+                                 uint32_t value_size,
+                                 bool has_values)
+        {
+            if (std::memcmp(h.magic, "LTCB", 4) != 0) throw std::runtime_error("not an ltc file");
+            if (h.byte_order != binary_byte_order) throw std::runtime_error("byte order");
+            if (h.version != binary_version) throw std::runtime_error("unsupported version");
+            if (h.has_values != (has_values ? 1u : 0u) || h.key_size != key_size ||
+                (has_values && h.value_size != value_size))
+                throw std::runtime_error("element type mismatch");
+            const auto expected = make_header(h.count, key_size, value_size, has_values,
+                                              h.index_stride);
+            if (h.keys_offset != expected.keys_offset ||
+                h.values_offset != expected.values_offset ||
+                h.index_offset != expected.index_offset ||
+                h.index_count != expected.index_count || h.file_size != expected.file_size ||
+                h.file_size > size)
+                throw std::runtime_error("corrupt header");
+        }
+
+        inline void write_padding(std::ostream &os, uint64_t &pos, uint64_t offset)
+        {
+            static const char zeros[binary_alignment] = {};
+            os.write(zeros, static_cast<std::streamsize>(offset - pos));
+            pos = offset;
+        }
+
+        template <class T>
+        void write_array(std::ostream &os, uint64_t &pos, const std::vector<T> &a)
+        {
+            os.write(reinterpret_cast<const char *>(a.data()),
+                     static_cast<std::streamsize>(a.size() * sizeof(T)));
+            pos += a.size() * sizeof(T);
+        }
+
+        template <class Key, class Value, class Range>
+        void write_sections(std::ostream &os,
+                            const Range &range,
+                            bool has_values,
+                            uint32_t stride)
+        {
+            std::vector<Key> keys;
+            std::vector<Value> values;
+            for (const auto &v : range)
+            {
+                keys.push_back(v.first);
+                if (has_values) values.push_back(v.second);
+            }
+            const auto h = make_header(keys.size(), sizeof(Key), sizeof(Value), has_values,
+                                       stride);
+            os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+            uint64_t pos = sizeof(h);
+            write_padding(os, pos, h.keys_offset);
+            write_array(os, pos, keys);
+            if (has_values)
+            {
+                write_padding(os, pos, h.values_offset);
+                write_array(os, pos, values);
+            }
+            if (h.index_count > 0)
+            {
+                std::vector<Key> index;
+                for (uint64_t i = 0; i < keys.size(); i += h.index_stride)
+                    index.push_back(keys[i]);
+                write_padding(os, pos, h.index_offset);
+                write_array(os, pos, index);
+            }
+            if (!os) throw std::runtime_error("write failed");
+        }
+
+        // Presents the keys of a set as the first of a pair, so sets and maps share the
+        // writer
+        template <class Set> struct set_as_pairs
+        {
+            struct iterator
+            {
+                typename Set::const_iterator it;
+
+                std::pair<typename Set::key_type, char> operator*() const
+                {
+                    return std::make_pair(*it, char());
+                }
+                iterator &operator++()
+                {
+                    ++it;
+                    return *this;
+                }
+                bool operator!=(const iterator &o) const { return it != o.it; }
+            };
+
+            iterator begin() const { return iterator{ set.begin() }; }
+            iterator end() const { return iterator{ set.end() }; }
+
+            const Set &set;
+        };
+
+        template <class Container>
+        void write_binary(std::ostream &os, const Container &c, uint32_t stride, std::true_type)
+        {
+            using key_type = typename Container::key_type;
+            using mapped_type = typename Container::mapped_type;
+            static_assert(std::is_trivially_copyable<key_type>::value &&
+                              std::is_trivially_copyable<mapped_type>::value,
+                          "binary files need trivially copyable keys and values");
+            write_sections<key_type, mapped_type>(os, c, true, stride);
+        }
+
+        template <class Container>
+        void write_binary(std::ostream &os, const Container &c, uint32_t stride, std::false_type)
+        {
+            using key_type = typename Container::key_type;
+            static_assert(std::is_trivially_copyable<key_type>::value,
+                          "binary files need trivially copyable keys");
+            write_sections<key_type, char>(os, set_as_pairs<Container>{ c }, false, stride);
+        }
+
+        // Reads the count elements at offset into out. The header count is not trusted: the
+        // array grows one chunk at a time, so a corrupt count runs into the end of the
+        // stream before it allocates more than the stream holds.
+        template <class T>
+        void read_array(std::istream &is,
+                        uint64_t &pos,
+                        uint64_t offset,
+                        std::vector<T> &out,
+                        uint64_t count)
+        {
+            is.ignore(static_cast<std::streamsize>(offset - pos));
+            const uint64_t chunk = std::max<uint64_t>(1, (uint64_t(1) << 16) / sizeof(T));
+            for (uint64_t done = 0; done < count;)
+            {
+                const auto n = std::min(chunk, count - done);
+                out.resize(static_cast<size_t>(done + n));
+                is.read(reinterpret_cast<char *>(out.data() + done),
+                        static_cast<std::streamsize>(n * sizeof(T)));
+                if (!is) throw std::runtime_error("read failed");
+                done += n;
+            }
+            pos = offset + count * sizeof(T);
+        }
+
+        template <class Container>
+        typename Container::storage_type read_storage(std::istream &is, std::true_type)
+        {
+            using key_type = typename Container::key_type;
+            using mapped_type = typename Container::mapped_type;
+            binary_header h;
+            is.read(reinterpret_cast<char *>(&h), sizeof(h));
+            if (!is) throw std::runtime_error("read failed");
+            // The stream size is unknown, so only the layout is checked up front
+            check_header(h, h.file_size, sizeof(key_type), sizeof(mapped_type), true);
+            std::vector<key_type> keys;
+            std::vector<mapped_type> values;
+            uint64_t pos = sizeof(h);
+            read_array(is, pos, h.keys_offset, keys, h.count);
+            read_array(is, pos, h.values_offset, values, h.count);
+            typename Container::storage_type storage;
+            storage.reserve(keys.size());
+            for (uint64_t i = 0; i < h.count; ++i)
+                storage.push_back(typename Container::value_type(keys[i], values[i]));
+            return storage;
+        }
+
+        template <class Container>
+        typename Container::storage_type read_storage(std::istream &is, std::false_type)
+        {
+            using key_type = typename Container::key_type;
+            binary_header h;
+            is.read(reinterpret_cast<char *>(&h), sizeof(h));
+            if (!is) throw std::runtime_error("read failed");
+            check_header(h, h.file_size, sizeof(key_type), 0, false);
+            std::vector<key_type> keys;
+            uint64_t pos = sizeof(h);
+            read_array(is, pos, h.keys_offset, keys, h.count);
+            return typename Container::storage_type(keys.begin(), keys.end());
+        }
+    } // namespace detail
+
+    // Writes the elements of a vmap, amap or vset in the binary format. index_stride 0
+    // writes no index.
+    template <class Container>
+    void write_binary(std::ostream &os,
+                      const Container &c,
+                      uint32_t index_stride = default_index_stride)
+    {
+        detail::write_binary(os, c, index_stride,
+                             detail::is_pair<typename Container::value_type>());
+    }
+
+    // Reads a vmap, amap or vset written by write_binary, without sorting it again
+    template <class Container> Container read_binary(std::istream &is)
+    {
+        auto storage = detail::read_storage<Container>(
+            is, detail::is_pair<typename Container::value_type>());
+        return Container(sorted_unique, std::move(storage));
+    }
+
+    template <class Container>
+    void save_binary(const std::string &path,
+                     const Container &c,
+                     uint32_t index_stride = default_index_stride)
+    {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if (!os) throw std::runtime_error("cannot open " + path);
+        write_binary(os, c, index_stride);
+    }
+
+    template <class Container> Container load_binary(const std::string &path)
+    {
+        std::ifstream is(path, std::ios::binary);
+        if (!is) throw std::runtime_error("cannot open " + path);
+        return read_binary<Container>(is);
+    }
+} // namespace ltc
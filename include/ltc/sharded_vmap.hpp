@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <ltc/merge_view.hpp>
+#include <ltc/padded.hpp>
+#include <ltc/vmap.hpp>
+
+namespace ltc
+{
+    // Spreads keys over the shards by hash. Gives the most even load but no locality.
+    template <class Key, class Hash = std::hash<Key>> struct hash_partition
+    {
+        size_t operator()(const Key &key, size_t shards) const { return Hash()(key) % shards; }
+    };
+
+    // Spreads keys over the shards by the sorted split points given at construction:
+    // shard i holds keys in [splits[i-1], splits[i]). Keeps neighbouring keys together.
+    template <class Key, class Compare = std::less<Key>> struct range_partition
+    {
+        range_partition() = default;
+        explicit range_partition(std::vector<Key> splits, const Compare &comp = Compare())
+        : m_splits(std::move(splits)), m_comp(comp)
+        {
+            std::sort(m_splits.begin(), m_splits.end(), m_comp);
+        }
+
+        size_t operator()(const Key &key, size_t shards) const
+        {
+            const auto it = std::upper_bound(m_splits.begin(), m_splits.end(), key, m_comp);
+            return std::min<size_t>(it - m_splits.begin(), shards - 1);
+        }
+
+    private:
+        std::vector<Key> m_splits;
+        Compare m_comp;
+    };
+
+    // A map split into Shards independently locked vmaps. Single key operations lock one
+    // shard, batched operations lock every touched shard exactly once, and ordered traversal
+    // locks all shards and k-way merges them.
+    template <class Key,
+              class T,
+              size_t Shards = 16,
+              class Partition = hash_partition<Key>,
+              class Compare = std::less<Key>>
+    class sharded_vmap
+    {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using size_type = std::size_t;
+        using key_compare = Compare;
+        using shard_map_type = vmap<Key, T, Compare>;
+
+        static_assert(Shards > 0, "sharded_vmap needs at least one shard");
+
+        sharded_vmap() : sharded_vmap(Partition()) {}
+
+        explicit sharded_vmap(const Partition &partition, const Compare &comp = Compare())
+        : sharded_vmap(partition, comp, std::make_index_sequence<Shards>())
+        {
+        }
+
+        sharded_vmap(const sharded_vmap &) = delete;
+        sharded_vmap &operator=(const sharded_vmap &) = delete;
+
+        static constexpr size_type shard_count() { return Shards; }
+
+        size_type shard_of(const key_type &key) const { return m_partition(key, Shards); }
+
+        // Capacity
+        bool empty() const { return size() == 0; }
+
+        size_type size() const
+        {
+            size_type total = 0;
+            for (const auto &s : m_shards)
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                total += s.map.size();
+            }
+            return total;
+        }
+
+        // Modifiers
+        void clear()
+        {
+            for (auto &s : m_shards)
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.map.clear();
+            }
+        }
+
+        bool insert(const value_type &value)
+        {
+            auto &s = m_shards[shard_of(value.first)];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.map.insert(value).second;
+        }
+
+        bool insert(value_type &&value)
+        {
+            auto &s = m_shards[shard_of(value.first)];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.map.insert(std::move(value)).second;
+        }
+
+        // Returns true if the key was inserted, false if an existing value was replaced.
+        template <class M> bool insert_or_assign(const key_type &key, M &&obj)
+        {
+            auto &s = m_shards[shard_of(key)];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            const auto it = s.map.find(key);
+            if (it != s.map.end())
+            {
+                it->second = std::forward<M>(obj);
+                return false;
+            }
+            s.map.insert(value_type(key, std::forward<M>(obj)));
+            return true;
+        }
+
+        size_type erase(const key_type &key)
+        {
+            auto &s = m_shards[shard_of(key)];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.map.erase(key);
+        }
+
+        // Batched insert of value_type elements. Returns the number of new keys.
+        template <class InputIt> size_type insert(InputIt first, InputIt last)
+        {
+            std::array<std::vector<value_type>, Shards> buckets;
+            std::for_each(first, last, [&](const value_type &v) {
+                buckets[shard_of(v.first)].push_back(v);
+            });
+
+            size_type inserted = 0;
+            for (size_type i = 0; i < Shards; ++i)
+            {
+                auto &bucket = buckets[i];
+                if (bucket.empty()) continue;
+                auto &s = m_shards[i];
+                std::lock_guard<std::mutex> lock(s.mutex);
+                for (auto &v : bucket)
+                    if (s.map.insert(std::move(v)).second) ++inserted;
+            }
+            return inserted;
+        }
+
+        // Batched erase of keys. Returns the number of erased keys.
+        template <class InputIt> size_type erase(InputIt first, InputIt last)
+        {
+            const auto buckets = bucket_keys(first, last);
+            size_type erased = 0;
+            for (size_type i = 0; i < Shards; ++i)
+            {
+                if (buckets[i].empty()) continue;
+                auto &s = m_shards[i];
+                std::lock_guard<std::mutex> lock(s.mutex);
+                for (const auto &key : buckets[i])
+                    erased += s.map.erase(key);
+            }
+            return erased;
+        }
+
+        // Lookup
+        bool contains(const key_type &key) const
+        {
+            const auto &s = m_shards[shard_of(key)];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.map.contains(key);
+        }
+
+        // Copies the mapped value of key to value. Returns false if key is not present.
+        bool find(const key_type &key, mapped_type &value) const
+        {
+            const auto &s = m_shards[shard_of(key)];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            const auto it = s.map.find(key);
+            if (it == s.map.end()) return false;
+            value = it->second;
+            return true;
+        }
+
+        // Calls fn(mapped_type&) under the shard lock. Returns false if key is not present.
+        template <class Fn> bool visit(const key_type &key, Fn fn)
+        {
+            auto &s = m_shards[shard_of(key)];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            const auto it = s.map.find(key);
+            if (it == s.map.end()) return false;
+            fn(it->second);
+            return true;
+        }
+
+        // Batched lookup. Writes a copy of each found element to out, grouped by shard.
+        template <class InputIt, class OutputIt>
+        OutputIt find_many(InputIt first, InputIt last, OutputIt out) const
+        {
+            const auto buckets = bucket_keys(first, last);
+            for (size_type i = 0; i < Shards; ++i)
+            {
+                if (buckets[i].empty()) continue;
+                const auto &s = m_shards[i];
+                std::lock_guard<std::mutex> lock(s.mutex);
+                for (const auto &key : buckets[i])
+                {
+                    const auto it = s.map.find(key);
+                    if (it != s.map.end()) *out++ = *it;
+                }
+            }
+            return out;
+        }
+
+        // Calls fn(const value_type&) for every element in key order. All shards are locked,
+        // in shard order, for the duration of the traversal.
+        template <class Fn> void for_each(Fn fn) const
+        {
+            using const_iterator = typename shard_map_type::const_iterator;
+
+            std::array<std::unique_lock<std::mutex>, Shards> locks;
+            for (size_type i = 0; i < Shards; ++i)
+                locks[i] = std::unique_lock<std::mutex>(m_shards[i].mutex);
+
+            // Shards hold disjoint keys, so there are no duplicates to resolve
+            std::vector<std::pair<const_iterator, const_iterator>> runs;
+            for (const auto &s : m_shards)
+                runs.emplace_back(s.map.begin(), s.map.end());
+            for (const auto &v : merge_runs(std::move(runs), keep_all(), m_key_comp))
+                fn(v);
+        }
+
+        key_compare key_comp() const { return m_key_comp; }
+
+    private:
+        // Shards sit on cache lines of their own, so locking one does not slow its neighbours
+        struct alignas(cache_line_size) shard
+        {
+            shard(const Compare &comp) : map(comp) {}
+
+            mutable std::mutex mutex;
+            shard_map_type map;
+        };
+
+        // Every shard's map orders by comp. Shards are neither copyable nor movable, so the
+        // array is built in place, one braced initializer per shard.
+        template <size_t... I>
+        sharded_vmap(const Partition &partition, const Compare &comp, std::index_sequence<I...>)
+        : m_shards{ { { (static_cast<void>(I), comp) }... } }, m_partition(partition),
+          m_key_comp(comp)
+        {
+        }
+
+        template <class InputIt>
+        std::array<std::vector<key_type>, Shards> bucket_keys(InputIt first, InputIt last) const
+        {
+            std::array<std::vector<key_type>, Shards> buckets;
+            std::for_each(first, last, [&](const key_type &key) {
+                buckets[shard_of(key)].push_back(key);
+            });
+            return buckets;
+        }
+
+        std::array<shard, Shards> m_shards;
+        Partition m_partition;
+        key_compare m_key_comp;
+    };
+} // namespace ltc
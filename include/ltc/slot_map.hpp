@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ltc
+{
+    // Names an element of a slot_map. A handle resolves until its element is erased; the
+    // slot's generation then moves on, so a stale handle never reaches a later occupant.
+    struct slot_handle
+    {
+        uint32_t index = uint32_t(-1);
+        uint32_t generation = 0;
+
+        // False for a default constructed handle, which names nothing
+        explicit operator bool() const { return index != uint32_t(-1); }
+    };
+
+    inline bool operator==(const slot_handle &a, const slot_handle &b)
+    {
+        return a.index == b.index && a.generation == b.generation;
+    }
+
+    inline bool operator!=(const slot_handle &a, const slot_handle &b) { return !(a == b); }
+
+    // Unordered storage with O(1) insert, erase and lookup by handle. Slots live in fixed
+    // size pages that never move, so besides handles, pointers and references to elements
+    // also stay valid until the element is erased. Erased slots are reused through a free
+    // list.
+    template <class T> class slot_map
+    {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using handle = slot_handle;
+
+        slot_map() = default;
+
+        slot_map(const slot_map &other)
+        {
+            for (uint32_t i = 0; i < other.m_slots; ++i)
+            {
+                const auto &from = other.at(i);
+                if (i == capacity()) add_page();
+                auto &to = at(i);
+                if (from.occupied) new (&to.storage) T(*from.value());
+                to.generation = from.generation;
+                to.next_free = from.next_free;
+                to.occupied = from.occupied;
+                m_slots = i + 1;
+            }
+            m_free_head = other.m_free_head;
+            m_size = other.m_size;
+        }
+
+        slot_map(slot_map &&other) noexcept { swap(other); }
+
+        slot_map &operator=(slot_map other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~slot_map() { destroy(); }
+
+        // Capacity
+        bool empty() const { return m_size == 0; }
+        size_type size() const { return m_size; }
+        size_type capacity() const { return m_pages.size() * page_size; }
+
+        // Modifiers
+        template <class... Args> handle emplace(Args &&... args)
+        {
+            const bool reuse = m_free_head != npos;
+            if (!reuse && m_slots == capacity()) add_page();
+            const auto index = reuse ? m_free_head : m_slots;
+            auto &s = at(index);
+            new (&s.storage) T(std::forward<Args>(args)...);
+            if (reuse)
+                m_free_head = s.next_free;
+            else
+                ++m_slots;
+            s.occupied = true;
+            ++m_size;
+            return handle{ index, s.generation };
+        }
+
+        handle insert(const T &value) { return emplace(value); }
+        handle insert(T &&value) { return emplace(std::move(value)); }
+
+        // Returns false if h was stale
+        bool erase(handle h)
+        {
+            if (!contains(h)) return false;
+            release(h.index);
+            return true;
+        }
+
+        // Erases every element; all handles go stale
+        void clear()
+        {
+            for (uint32_t i = 0; i < m_slots; ++i)
+                if (at(i).occupied) release(i);
+        }
+
+        void swap(slot_map &other) noexcept
+        {
+            using std::swap;
+            swap(m_pages, other.m_pages);
+            swap(m_slots, other.m_slots);
+            swap(m_free_head, other.m_free_head);
+            swap(m_size, other.m_size);
+        }
+
+        // Lookup
+        bool contains(handle h) const { return get(h) != nullptr; }
+
+        // The element h names, or nullptr if h is stale
+        T *get(handle h)
+        {
+            if (h.index >= m_slots) return nullptr;
+            auto &s = at(h.index);
+            return s.occupied && s.generation == h.generation ? s.value() : nullptr;
+        }
+
+        const T *get(handle h) const { return const_cast<slot_map *>(this)->get(h); }
+
+        // Unchecked access; h must not be stale
+        T &operator[](handle h)
+        {
+            assert(contains(h));
+            return *at(h.index).value();
+        }
+
+        const T &operator[](handle h) const
+        {
+            assert(contains(h));
+            return *at(h.index).value();
+        }
+
+        // Calls fn(handle, T&) for every element, in slot order
+        template <class Fn> void for_each(Fn fn)
+        {
+            for (uint32_t i = 0; i < m_slots; ++i)
+            {
+                auto &s = at(i);
+                if (s.occupied) fn(handle{ i, s.generation }, *s.value());
+            }
+        }
+
+        template <class Fn> void for_each(Fn fn) const
+        {
+            for (uint32_t i = 0; i < m_slots; ++i)
+            {
+                const auto &s = at(i);
+                if (s.occupied) fn(handle{ i, s.generation }, *s.value());
+            }
+        }
+
+    private:
+        struct slot
+        {
+            T *value() { return reinterpret_cast<T *>(&storage); }
+            const T *value() const { return reinterpret_cast<const T *>(&storage); }
+
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+            uint32_t generation = 0;
+            uint32_t next_free = uint32_t(-1);
+            bool occupied = false;
+        };
+
+        static constexpr uint32_t npos = uint32_t(-1);
+        static constexpr size_type page_shift = 8;
+        static constexpr size_type page_size = size_type(1) << page_shift;
+
+        slot &at(uint32_t i) { return m_pages[i >> page_shift][i & (page_size - 1)]; }
+        const slot &at(uint32_t i) const { return m_pages[i >> page_shift][i & (page_size - 1)]; }
+
+        void add_page() { m_pages.emplace_back(new slot[page_size]); }
+
+        void release(uint32_t index)
+        {
+            auto &s = at(index);
+            s.value()->~T();
+            s.occupied = false;
+            ++s.generation;
+            s.next_free = m_free_head;
+            m_free_head = index;
+            --m_size;
+        }
+
+        void destroy()
+        {
+            for (uint32_t i = 0; i < m_slots; ++i)
+                if (at(i).occupied) at(i).value()->~T();
+        }
+
+        std::vector<std::unique_ptr<slot[]>> m_pages;
+        uint32_t m_slots = 0; // slots ever used, the rest of the last page is untouched
+        uint32_t m_free_head = npos;
+        size_type m_size = 0;
+    };
+
+    template <class T> void swap(slot_map<T> &a, slot_map<T> &b) noexcept { a.swap(b); }
+} // namespace ltc
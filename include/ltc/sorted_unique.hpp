@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+
+namespace ltc
+{
+    // Tag for constructors taking elements that are already sorted by the container's
+    // comparator and free of equivalent keys. The elements are adopted without sorting;
+    // debug builds assert the precondition.
+    struct sorted_unique_t
+    {
+        explicit sorted_unique_t() = default;
+    };
+
+    constexpr sorted_unique_t sorted_unique{};
+
+    // Tag for batched lookups whose probe keys are already sorted by the container's
+    // comparator, so the lookup can skip sorting them.
+    struct presorted_t
+    {
+        explicit presorted_t() = default;
+    };
+
+    constexpr presorted_t presorted{};
+
+    // True if [first, last) is strictly increasing under comp.
+    template <class ForwardIt, class Compare>
+    bool is_sorted_unique(ForwardIt first, ForwardIt last, Compare comp)
+    {
+        return std::adjacent_find(first, last, [&comp](const auto &a, const auto &b) {
+                   return !comp(a, b);
+               }) == last;
+    }
+} // namespace ltc
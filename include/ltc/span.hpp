@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace ltc
+{
+    // A non-owning view of a contiguous array, as a pair of pointers. Stays valid as long
+    // as the underlying storage is neither modified nor reallocated.
+    template <class T> class span final
+    {
+    public:
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T *;
+        using reference = T &;
+        using iterator = T *;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+
+        span() = default;
+        span(pointer first, pointer last) : m_first(first), m_last(last) {}
+        span(pointer first, size_type size) : m_first(first), m_last(first + size) {}
+
+        // A span of T converts to a span of const T
+        template <class U, class = std::enable_if_t<std::is_convertible<U *, T *>::value>>
+        span(const span<U> &other) : m_first(other.begin()), m_last(other.end())
+        {
+        }
+
+        iterator begin() const { return m_first; }
+        iterator end() const { return m_last; }
+        reverse_iterator rbegin() const { return reverse_iterator(m_last); }
+        reverse_iterator rend() const { return reverse_iterator(m_first); }
+
+        pointer data() const { return m_first; }
+        size_type size() const { return static_cast<size_type>(m_last - m_first); }
+        bool empty() const { return m_first == m_last; }
+
+        reference operator[](size_type i) const { return m_first[i]; }
+        reference at(size_type i) const
+        {
+            if (i >= size()) throw std::out_of_range("index");
+            return m_first[i];
+        }
+        reference front() const { return *m_first; }
+        reference back() const { return *(m_last - 1); }
+
+        span first(size_type n) const { return span(m_first, n); }
+        span last(size_type n) const { return span(m_last - n, m_last); }
+        span subspan(size_type offset, size_type n) const { return span(m_first + offset, n); }
+
+    private:
+        pointer m_first = nullptr;
+        pointer m_last = nullptr;
+    };
+} // namespace ltc
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include <ltc/slot_map.hpp>
+#include <ltc/vmap.hpp>
+
+namespace ltc
+{
+    // A sorted map whose mapped values stay put. The values live in a slot_map and a vmap of
+    // keys and slot handles keeps them in key order, so inserts and erases only shift the
+    // small index entries. A handle from insert or find reaches its mapped value in O(1),
+    // without a search, and stays valid, as do references, until that key is erased.
+    //
+    // Keys are stored once, in the index. Each slot records the index position of its key,
+    // for erase(handle) and key_of(handle); inserts and erases renumber the slots of the
+    // entries they shift.
+    template <class Key, class T, class Compare = std::less<Key>> class stable_vmap
+    {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<Key, T>;
+        using size_type = std::size_t;
+        using key_compare = Compare;
+        using handle = slot_handle;
+        using index_type = vmap<Key, slot_handle, Compare>;
+
+        stable_vmap() = default;
+        explicit stable_vmap(const Compare &comp) : m_index(comp) {}
+
+        // Capacity
+        bool empty() const { return m_index.empty(); }
+        size_type size() const { return m_index.size(); }
+
+        // Modifiers
+        void clear()
+        {
+            m_index.clear();
+            m_slots.clear();
+        }
+
+        // Inserts key if it is not present. Returns its handle and whether it was inserted.
+        template <class M> std::pair<handle, bool> insert(const key_type &key, M &&value)
+        {
+            const auto it = m_index.find(key);
+            if (it != m_index.end()) return std::make_pair(it->second, false);
+            return std::make_pair(add(key, std::forward<M>(value)), true);
+        }
+
+        template <class M> handle insert_or_assign(const key_type &key, M &&value)
+        {
+            const auto r = insert(key, std::forward<M>(value));
+            if (!r.second) m_slots[r.first].value = std::forward<M>(value);
+            return r.first;
+        }
+
+        size_type erase(const key_type &key)
+        {
+            const auto it = m_index.find(key);
+            if (it == m_index.end()) return 0;
+            const auto position = static_cast<size_type>(it - m_index.begin());
+            m_slots.erase(it->second);
+            m_index.erase(it);
+            renumber(position);
+            return 1;
+        }
+
+        // Returns false if h was stale
+        bool erase(handle h)
+        {
+            const auto e = m_slots.get(h);
+            if (!e) return false;
+            const auto position = e->position;
+            m_index.erase(m_index.begin() + position);
+            m_slots.erase(h);
+            renumber(position);
+            return true;
+        }
+
+        // Element access
+        mapped_type &operator[](const key_type &key)
+        {
+            return *get(insert(key, mapped_type()).first);
+        }
+
+        mapped_type &at(const key_type &key)
+        {
+            const auto v = get(find(key));
+            if (!v) throw std::out_of_range("key");
+            return *v;
+        }
+
+        const mapped_type &at(const key_type &key) const
+        {
+            const auto v = get(find(key));
+            if (!v) throw std::out_of_range("key");
+            return *v;
+        }
+
+        // The mapped value h names in O(1), or nullptr if its key was erased
+        mapped_type *get(handle h)
+        {
+            const auto e = m_slots.get(h);
+            return e ? &e->value : nullptr;
+        }
+
+        const mapped_type *get(handle h) const
+        {
+            const auto e = m_slots.get(h);
+            return e ? &e->value : nullptr;
+        }
+
+        // The key h names, or nullptr if it was erased. The key lives in the index, so the
+        // pointer is only valid until the next insert or erase.
+        const key_type *key_of(handle h) const
+        {
+            const auto e = m_slots.get(h);
+            return e ? &(m_index.begin() + e->position)->first : nullptr;
+        }
+
+        // Lookup
+
+        // The handle of key, or a handle that converts to false if key is not present
+        handle find(const key_type &key) const
+        {
+            const auto it = m_index.find(key);
+            return it != m_index.end() ? it->second : handle();
+        }
+
+        bool contains(const key_type &key) const { return m_index.contains(key); }
+        bool valid(handle h) const { return m_slots.contains(h); }
+
+        // Calls fn(const key_type&, mapped_type&) for every element in key order
+        template <class Fn> void for_each(Fn fn)
+        {
+            for (const auto &entry : m_index)
+                fn(entry.first, m_slots[entry.second].value);
+        }
+
+        template <class Fn> void for_each(Fn fn) const
+        {
+            for (const auto &entry : m_index)
+                fn(entry.first, m_slots[entry.second].value);
+        }
+
+        // The sorted keys and their handles, for ordered and range lookups
+        const index_type &index() const { return m_index; }
+
+        key_compare key_comp() const { return m_index.key_comp(); }
+
+    private:
+        // A mapped value and the position of its key in the index
+        struct slot
+        {
+            template <class M>
+            slot(M &&value, size_type index) : value(std::forward<M>(value)), position(index)
+            {
+            }
+
+            mapped_type value;
+            size_type position;
+        };
+
+        template <class M> handle add(const key_type &key, M &&value)
+        {
+            const auto h = m_slots.emplace(std::forward<M>(value), size_type(0));
+            try
+            {
+                const auto it = m_index.insert(typename index_type::value_type(key, h)).first;
+                renumber(static_cast<size_type>(it - m_index.begin()));
+            }
+            catch (...)
+            {
+                m_slots.erase(h);
+                throw;
+            }
+            return h;
+        }
+
+        // Updates the positions of the slots whose index entries start at from or after
+        void renumber(size_type from)
+        {
+            auto i = from;
+            for (auto it = m_index.begin() + from; it != m_index.end(); ++it)
+                m_slots[it->second].position = i++;
+        }
+
+        index_type m_index;
+        slot_map<slot> m_slots;
+    };
+} // namespace ltc
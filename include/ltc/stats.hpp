@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ltc
+{
+    // A copy of the counters of a container's stats policy, for export to a metrics system.
+    // The gauges are only filled in by containers that have them, such as bloom_filter.
+    struct stats_snapshot
+    {
+        uint64_t finds = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t inserts = 0;
+        uint64_t erases = 0;
+        uint64_t moved = 0; // elements shifted by inserts and erases
+        uint64_t searches = 0;
+        uint64_t comparisons = 0;
+        uint64_t reallocations = 0;
+
+        double fill_ratio = 0;
+        double estimated_fpp = 0;
+
+        double comparisons_per_search() const
+        {
+            return searches == 0 ? 0.0 : double(comparisons) / double(searches);
+        }
+
+        double moved_per_modification() const
+        {
+            const auto modifications = inserts + erases;
+            return modifications == 0 ? 0.0 : double(moved) / double(modifications);
+        }
+
+        // Calls fn(const char *name, value) for every counter and gauge
+        template <class Fn> void for_each(Fn fn) const
+        {
+            fn("finds", finds);
+            fn("hits", hits);
+            fn("misses", misses);
+            fn("inserts", inserts);
+            fn("erases", erases);
+            fn("moved", moved);
+            fn("searches", searches);
+            fn("comparisons", comparisons);
+            fn("reallocations", reallocations);
+            fn("fill_ratio", fill_ratio);
+            fn("estimated_fpp", estimated_fpp);
+        }
+    };
+
+    // The default stats policy. Every hook is an empty inline function, so the arguments
+    // computed for it are dropped by the optimizer and an uninstrumented container pays
+    // nothing, not even storage, as the policy is held as an empty base.
+    struct no_stats
+    {
+        void on_find(bool) const {}
+        void on_search(size_t) const {}
+        void on_insert(size_t, size_t, bool) const {}
+        void on_erase(size_t, size_t) const {}
+        void on_reallocate() const {}
+
+        stats_snapshot snapshot() const { return stats_snapshot(); }
+        void reset() const {}
+    };
+
+    // Counts every hook call. The counters are mutable so const lookups can be counted; like
+    // the containers themselves the policy is not thread safe.
+    class counting_stats
+    {
+    public:
+        // A lookup of a single key, hit when the key was found
+        void on_find(bool hit) const
+        {
+            ++m_finds;
+            m_hits += hit ? 1 : 0;
+        }
+
+        // A binary search of the storage that took the given number of comparisons
+        void on_search(size_t comparisons) const
+        {
+            ++m_searches;
+            m_comparisons += comparisons;
+        }
+
+        // count elements inserted, shifting moved others, and whether the storage reallocated
+        void on_insert(size_t count, size_t moved, bool reallocated) const
+        {
+            m_inserts += count;
+            m_moved += moved;
+            m_reallocations += reallocated ? 1 : 0;
+        }
+
+        // count elements erased, shifting moved others
+        void on_erase(size_t count, size_t moved) const
+        {
+            m_erases += count;
+            m_moved += moved;
+        }
+
+        void on_reallocate() const { ++m_reallocations; }
+
+        stats_snapshot snapshot() const
+        {
+            stats_snapshot s;
+            s.finds = m_finds;
+            s.hits = m_hits;
+            s.misses = m_finds - m_hits;
+            s.inserts = m_inserts;
+            s.erases = m_erases;
+            s.moved = m_moved;
+            s.searches = m_searches;
+            s.comparisons = m_comparisons;
+            s.reallocations = m_reallocations;
+            return s;
+        }
+
+        void reset() const
+        {
+            m_finds = m_hits = m_inserts = m_erases = 0;
+            m_moved = m_searches = m_comparisons = m_reallocations = 0;
+        }
+
+    private:
+        mutable uint64_t m_finds = 0;
+        mutable uint64_t m_hits = 0;
+        mutable uint64_t m_inserts = 0;
+        mutable uint64_t m_erases = 0;
+        mutable uint64_t m_moved = 0;
+        mutable uint64_t m_searches = 0;
+        mutable uint64_t m_comparisons = 0;
+        mutable uint64_t m_reallocations = 0;
+    };
+
+    // Holds a container's stats policy as an empty-base-optimized base class. The policy is
+    // not copied with the container: a copy starts counting from zero.
+    template <class Stats> class stats_holder : private Stats
+    {
+    public:
+        using stats_type = Stats;
+
+        stats_holder() = default;
+        stats_holder(const stats_holder &) : Stats() {}
+        stats_holder &operator=(const stats_holder &) { return *this; }
+
+        const Stats &stats() const { return *this; }
+        stats_snapshot snapshot() const { return stats().snapshot(); }
+        void reset_stats() { stats().reset(); }
+    };
+} // namespace ltc
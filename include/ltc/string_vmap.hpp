@@ -0,0 +1,643 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#include <ltc/radix_sort.hpp>
+#include <ltc/range.hpp>
+
+namespace ltc
+{
+    // A borrowed string to look up, from a std::string, a C string or, in C++17, a
+    // std::string_view. Must not outlive the string it refers to.
+    class key_view
+    {
+    public:
+        key_view(const std::string &s) : m_data(s.data()), m_size(s.size()) {}
+        key_view(const char *s) : m_data(s), m_size(std::strlen(s)) {}
+        key_view(const char *s, std::size_t size) : m_data(s), m_size(size) {}
+#if __cplusplus >= 201703L
+        key_view(std::string_view s) : m_data(s.data()), m_size(s.size()) {}
+#endif
+
+        const char *data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+        std::string str() const { return std::string(m_data, m_size); }
+
+    private:
+        const char *m_data;
+        std::size_t m_size;
+    };
+
+    namespace detail
+    {
+        inline void put_varint(std::vector<char> &out, std::size_t v)
+        {
+            for (; v >= 0x80; v >>= 7)
+                out.push_back(static_cast<char>(v | 0x80));
+            out.push_back(static_cast<char>(v));
+        }
+
+        inline std::size_t get_varint(const char *&p)
+        {
+            std::size_t v = 0;
+            for (unsigned shift = 0;; shift += 7)
+            {
+                const auto b = static_cast<unsigned char>(*p++);
+                v |= static_cast<std::size_t>(b & 0x7f) << shift;
+                if (b < 0x80) return v;
+            }
+        }
+
+        // Orders as std::string does, by unsigned bytes
+        inline int compare_bytes(const char *a, std::size_t an, const char *b, std::size_t bn)
+        {
+            const int r = std::memcmp(a, b, std::min(an, bn));
+            if (r != 0) return r;
+            return an < bn ? -1 : an > bn ? 1 : 0;
+        }
+
+        // Sorted unique strings, front coded: each key is stored as the length of the prefix
+        // it shares with the key before it and the rest of its bytes. Every Restart keys a
+        // block starts that stores its first key in full, so a search binary searches the
+        // blocks and then scans one block. The scan tracks the common prefix of the probe
+        // and the key it passed, so it compares only suffixes and never decodes a key.
+        template <std::size_t Restart> class front_coded_keys
+        {
+            static_assert(Restart > 0, "blocks need at least one key");
+
+        public:
+            using size_type = std::size_t;
+
+            // Where key is or would be inserted
+            struct position
+            {
+                size_type index;
+                bool found;
+            };
+
+            // Decodes keys in order, starting at a given index
+            class cursor
+            {
+            public:
+                cursor() = default;
+
+                cursor(const front_coded_keys *keys, size_type index)
+                : m_keys(keys), m_index(index)
+                {
+                    if (index >= keys->size()) return;
+                    m_block = keys->block_of(index);
+                    m_offset = keys->m_blocks[m_block].offset;
+                    for (auto i = keys->m_blocks[m_block].first; i <= index; ++i)
+                        decode();
+                }
+
+                const std::string &key() const { return m_key; }
+                size_type index() const { return m_index; }
+
+                void next()
+                {
+                    if (++m_index >= m_keys->size()) return;
+                    if (m_block + 1 < m_keys->m_blocks.size() &&
+                        m_index == m_keys->m_blocks[m_block + 1].first)
+                        ++m_block;
+                    decode();
+                }
+
+            private:
+                void decode()
+                {
+                    const char *p = m_keys->m_bytes.data() + m_offset;
+                    const auto shared = get_varint(p);
+                    const auto length = get_varint(p);
+                    m_key.resize(shared);
+                    m_key.append(p, length);
+                    m_offset = static_cast<size_type>(p + length - m_keys->m_bytes.data());
+                }
+
+                const front_coded_keys *m_keys = nullptr;
+                size_type m_index = 0;
+                size_type m_block = 0;
+                size_type m_offset = 0;
+                std::string m_key;
+            };
+
+            front_coded_keys() = default;
+
+            // Takes keys that are sorted and free of duplicates
+            explicit front_coded_keys(const std::vector<std::string> &keys)
+            {
+                replace_block(0, keys, static_cast<std::ptrdiff_t>(keys.size()));
+            }
+
+            size_type size() const { return m_size; }
+
+            // Bytes used by the encoded keys and the block index
+            size_type key_bytes() const
+            {
+                return m_bytes.capacity() + m_blocks.capacity() * sizeof(block);
+            }
+
+            void clear()
+            {
+                m_bytes.clear();
+                m_blocks.clear();
+                m_size = 0;
+            }
+
+            void swap(front_coded_keys &other) noexcept
+            {
+                m_bytes.swap(other.m_bytes);
+                m_blocks.swap(other.m_blocks);
+                std::swap(m_size, other.m_size);
+            }
+
+            position lower_bound(key_view key) const
+            {
+                const auto b = std::upper_bound(m_blocks.begin(), m_blocks.end(), key,
+                                                [this](key_view k, const block &blk) {
+                                                    const char *p = m_bytes.data() + blk.offset;
+                                                    get_varint(p);
+                                                    const auto n = get_varint(p);
+                                                    return compare_bytes(k.data(), k.size(), p,
+                                                                         n) < 0;
+                                                });
+                if (b == m_blocks.begin()) return position{ 0, false };
+                const auto end = b == m_blocks.end() ? m_size : b->first;
+                const char *p = m_bytes.data() + (b - 1)->offset;
+                size_type lcp = 0; // common prefix of key and the last key passed
+                for (auto index = (b - 1)->first; index < end; ++index)
+                {
+                    const auto shared = get_varint(p);
+                    const auto length = get_varint(p);
+                    const char *suffix = p;
+                    p += length;
+                    // The key passed differs from key at lcp. Sharing more with it means
+                    // being smaller than key too, sharing less means being greater.
+                    if (shared > lcp) continue;
+                    if (shared < lcp) return position{ index, false };
+                    const auto rest = key.size() - lcp;
+                    const char *probe = key.data() + lcp;
+                    size_type m = 0;
+                    while (m < length && m < rest && suffix[m] == probe[m])
+                        ++m;
+                    if (m == length && m == rest) return position{ index, true };
+                    const bool less = m == length ||
+                                      (m < rest && static_cast<unsigned char>(suffix[m]) <
+                                                       static_cast<unsigned char>(probe[m]));
+                    if (!less) return position{ index, false };
+                    lcp += m;
+                }
+                return position{ end, false };
+            }
+
+            // Inserts key at index, which must be where lower_bound placed it
+            void insert(size_type index, key_view key)
+            {
+                if (m_blocks.empty())
+                {
+                    replace_block(0, std::vector<std::string>{ key.str() }, 1);
+                    return;
+                }
+                // Before a block's first key, the key joins the end of the previous block
+                auto b = block_of(index == m_size ? index - 1 : index);
+                if (b > 0 && index == m_blocks[b].first) --b;
+                auto keys = decode_block(b);
+                keys.insert(keys.begin() + (index - m_blocks[b].first), key.str());
+                replace_block(b, keys, 1);
+            }
+
+            void erase(size_type index)
+            {
+                const auto b = block_of(index);
+                auto keys = decode_block(b);
+                keys.erase(keys.begin() + (index - m_blocks[b].first));
+                replace_block(b, keys, -1);
+            }
+
+        private:
+            struct block
+            {
+                size_type offset; // of the first key in m_bytes
+                size_type first;  // index of the first key
+            };
+
+            size_type block_of(size_type index) const
+            {
+                const auto b = std::upper_bound(m_blocks.begin(), m_blocks.end(), index,
+                                                [](size_type i, const block &blk) {
+                                                    return i < blk.first;
+                                                });
+                return static_cast<size_type>(b - m_blocks.begin()) - 1;
+            }
+
+            std::vector<std::string> decode_block(size_type b) const
+            {
+                std::vector<std::string> keys;
+                const auto end = b + 1 < m_blocks.size() ? m_blocks[b + 1].first : m_size;
+                for (cursor c(this, m_blocks[b].first); c.index() < end; c.next())
+                    keys.push_back(c.key());
+                return keys;
+            }
+
+            // Replaces block b, or appends when there are no blocks, with keys, splitting
+            // them evenly into blocks of at most Restart keys. count_delta is the change in
+            // the number of keys.
+            void replace_block(size_type b, const std::vector<std::string> &keys,
+                               std::ptrdiff_t count_delta)
+            {
+                const bool append = b == m_blocks.size();
+                const auto begin = append ? m_bytes.size() : m_blocks[b].offset;
+                const auto end = b + 1 < m_blocks.size() ? m_blocks[b + 1].offset
+                                                         : m_bytes.size();
+                const auto first = append ? m_size : m_blocks[b].first;
+
+                std::vector<char> encoded;
+                std::vector<block> blocks;
+                const auto count = (keys.size() + Restart - 1) / Restart;
+                for (size_type i = 0, k = 0; i < count; ++i)
+                {
+                    blocks.push_back(block{ begin + encoded.size(), first + k });
+                    const auto stop = (i + 1) * keys.size() / count;
+                    for (const std::string *prev = nullptr; k < stop; prev = &keys[k++])
+                    {
+                        size_type shared = 0;
+                        if (prev)
+                            while (shared < prev->size() && shared < keys[k].size() &&
+                                   (*prev)[shared] == keys[k][shared])
+                                ++shared;
+                        put_varint(encoded, shared);
+                        put_varint(encoded, keys[k].size() - shared);
+                        encoded.insert(encoded.end(), keys[k].begin() + shared, keys[k].end());
+                    }
+                }
+
+                m_bytes.erase(m_bytes.begin() + begin, m_bytes.begin() + end);
+                m_bytes.insert(m_bytes.begin() + begin, encoded.begin(), encoded.end());
+                const auto byte_delta = static_cast<std::ptrdiff_t>(encoded.size()) -
+                                        static_cast<std::ptrdiff_t>(end - begin);
+                for (auto i = b + 1; i < m_blocks.size(); ++i)
+                {
+                    m_blocks[i].offset += byte_delta;
+                    m_blocks[i].first += count_delta;
+                }
+                if (!append) m_blocks.erase(m_blocks.begin() + b);
+                m_blocks.insert(m_blocks.begin() + b, blocks.begin(), blocks.end());
+                m_size += count_delta;
+            }
+
+            std::vector<char> m_bytes;
+            std::vector<block> m_blocks;
+            size_type m_size = 0;
+        };
+
+        // Sorts keys by the radix sort of radix_sort.hpp and drops duplicates after the first
+        template <class V, class Proj> void sort_unique_strings(std::vector<V> &v, Proj proj)
+        {
+            sort_by_key(v.begin(), v.end(), proj, std::less<std::string>());
+            const auto same = [&proj](const V &a, const V &b) { return proj(a) == proj(b); };
+            v.erase(std::unique(v.begin(), v.end(), same), v.end());
+        }
+    } // namespace detail
+
+    // A sorted map from strings to T for keys that share long prefixes, such as URLs and
+    // paths. Keys are front coded in contiguous blocks of Restart keys (see
+    // detail::front_coded_keys), which takes a fraction of the memory of a
+    // vmap<std::string, T> and avoids a heap allocation and pointer chase per key. Values
+    // are kept in key order in a separate vector.
+    //
+    // Iterators are forward only and decode keys as they go; a dereferenced key refers to
+    // the iterator and is valid until it is advanced. Inserts and erases re-encode one block
+    // and shift the bytes after it, like inserts into a vmap.
+    template <class T, std::size_t Restart = 16> class string_vmap
+    {
+        using keys_type = detail::front_coded_keys<Restart>;
+
+    public:
+        using key_type = std::string;
+        using mapped_type = T;
+        using value_type = std::pair<std::string, T>;
+        using size_type = std::size_t;
+
+        template <bool Const>
+        class basic_iterator final
+        : public iterator_facade<basic_iterator<Const>,
+                                 std::forward_iterator_tag,
+                                 std::pair<const std::string &,
+                                           std::conditional_t<Const, const T &, T &>>>
+        {
+            friend class string_vmap;
+            friend iterator_access;
+            using map_pointer = std::conditional_t<Const, const string_vmap *, string_vmap *>;
+
+        public:
+            using reference = std::pair<const std::string &,
+                                        std::conditional_t<Const, const T &, T &>>;
+
+            basic_iterator() = default;
+            // A mutable iterator converts to a const one
+            template <bool C, class = std::enable_if_t<Const && !C>>
+            basic_iterator(const basic_iterator<C> &other)
+            : m_map(other.m_map), m_cursor(other.m_cursor)
+            {
+            }
+
+            const std::string &key() const { return m_cursor.key(); }
+
+        private:
+            template <bool> friend class basic_iterator;
+
+            basic_iterator(map_pointer map, size_type index)
+            : m_map(map), m_cursor(&map->m_keys, index)
+            {
+            }
+
+            reference dereference() const
+            {
+                return reference(m_cursor.key(), m_map->m_values[m_cursor.index()]);
+            }
+            void increment() { m_cursor.next(); }
+            bool equal(const basic_iterator &o) const
+            {
+                return m_cursor.index() == o.m_cursor.index();
+            }
+
+            map_pointer m_map = nullptr;
+            typename keys_type::cursor m_cursor;
+        };
+
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+        // Construction
+        string_vmap() = default;
+
+        string_vmap(std::initializer_list<value_type> init) : string_vmap(init.begin(), init.end())
+        {
+        }
+
+        template <class InputIt> string_vmap(InputIt first, InputIt last)
+        {
+            std::vector<value_type> values(first, last);
+            detail::sort_unique_strings(values, [](const value_type &v) -> const std::string & {
+                return v.first;
+            });
+            std::vector<std::string> keys;
+            keys.reserve(values.size());
+            m_values.reserve(values.size());
+            for (auto &v : values)
+            {
+                keys.push_back(std::move(v.first));
+                m_values.push_back(std::move(v.second));
+            }
+            m_keys = keys_type(keys);
+        }
+
+        // Iterators
+        iterator begin() { return iterator(this, 0); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator cbegin() const { return begin(); }
+        iterator end() { return iterator(this, size()); }
+        const_iterator end() const { return const_iterator(this, size()); }
+        const_iterator cend() const { return end(); }
+
+        // Capacity
+        bool empty() const { return size() == 0; }
+        size_type size() const { return m_keys.size(); }
+
+        // Bytes used by the keys, without the values
+        size_type key_bytes() const { return m_keys.key_bytes(); }
+
+        // Modifiers
+        void clear()
+        {
+            m_keys.clear();
+            m_values.clear();
+        }
+
+        // Inserts key if it is not present. Returns its position and whether it was inserted.
+        template <class M> std::pair<iterator, bool> insert(key_view key, M &&value)
+        {
+            const auto pos = m_keys.lower_bound(key);
+            if (pos.found) return std::make_pair(iterator(this, pos.index), false);
+            add(pos.index, key, std::forward<M>(value));
+            return std::make_pair(iterator(this, pos.index), true);
+        }
+
+        std::pair<iterator, bool> insert(const value_type &value)
+        {
+            return insert(value.first, value.second);
+        }
+
+        template <class M> iterator insert_or_assign(key_view key, M &&value)
+        {
+            const auto pos = m_keys.lower_bound(key);
+            if (pos.found)
+                m_values[pos.index] = std::forward<M>(value);
+            else
+                add(pos.index, key, std::forward<M>(value));
+            return iterator(this, pos.index);
+        }
+
+        size_type erase(key_view key)
+        {
+            const auto pos = m_keys.lower_bound(key);
+            if (!pos.found) return 0;
+            m_keys.erase(pos.index);
+            m_values.erase(m_values.begin() + pos.index);
+            return 1;
+        }
+
+        void swap(string_vmap &other) noexcept
+        {
+            m_keys.swap(other.m_keys);
+            m_values.swap(other.m_values);
+        }
+
+        // Element access
+        mapped_type &operator[](key_view key)
+        {
+            const auto pos = m_keys.lower_bound(key);
+            if (!pos.found) add(pos.index, key, mapped_type());
+            return m_values[pos.index];
+        }
+
+        mapped_type &at(key_view key)
+        {
+            const auto pos = m_keys.lower_bound(key);
+            if (!pos.found) throw std::out_of_range("key");
+            return m_values[pos.index];
+        }
+
+        const mapped_type &at(key_view key) const
+        {
+            const auto pos = m_keys.lower_bound(key);
+            if (!pos.found) throw std::out_of_range("key");
+            return m_values[pos.index];
+        }
+
+        // Lookup
+        size_type count(key_view key) const { return contains(key) ? 1 : 0; }
+        bool contains(key_view key) const { return m_keys.lower_bound(key).found; }
+
+        iterator find(key_view key)
+        {
+            const auto pos = m_keys.lower_bound(key);
+            return iterator(this, pos.found ? pos.index : size());
+        }
+
+        const_iterator find(key_view key) const
+        {
+            const auto pos = m_keys.lower_bound(key);
+            return const_iterator(this, pos.found ? pos.index : size());
+        }
+
+        iterator lower_bound(key_view key) { return iterator(this, m_keys.lower_bound(key).index); }
+
+        const_iterator lower_bound(key_view key) const
+        {
+            return const_iterator(this, m_keys.lower_bound(key).index);
+        }
+
+    private:
+        template <class M> void add(size_type index, key_view key, M &&value)
+        {
+            m_values.insert(m_values.begin() + index, std::forward<M>(value));
+            try
+            {
+                m_keys.insert(index, key);
+            }
+            catch (...)
+            {
+                m_values.erase(m_values.begin() + index);
+                throw;
+            }
+        }
+
+        keys_type m_keys;
+        std::vector<T> m_values;
+    };
+
+    template <class T, std::size_t Restart>
+    void swap(string_vmap<T, Restart> &a, string_vmap<T, Restart> &b) noexcept
+    {
+        a.swap(b);
+    }
+
+    // A sorted set of strings, front coded as in string_vmap
+    template <std::size_t Restart = 16> class string_vset
+    {
+        using keys_type = detail::front_coded_keys<Restart>;
+
+    public:
+        using key_type = std::string;
+        using value_type = std::string;
+        using size_type = std::size_t;
+
+        class const_iterator final
+        : public iterator_facade<const_iterator, std::forward_iterator_tag, const std::string &>
+        {
+            friend class string_vset;
+            friend iterator_access;
+
+        public:
+            const_iterator() = default;
+
+        private:
+            const_iterator(const keys_type *keys, size_type index) : m_cursor(keys, index) {}
+
+            const std::string &dereference() const { return m_cursor.key(); }
+            void increment() { m_cursor.next(); }
+            bool equal(const const_iterator &o) const
+            {
+                return m_cursor.index() == o.m_cursor.index();
+            }
+
+            typename keys_type::cursor m_cursor;
+        };
+
+        using iterator = const_iterator;
+
+        // Construction
+        string_vset() = default;
+
+        string_vset(std::initializer_list<std::string> init) : string_vset(init.begin(), init.end())
+        {
+        }
+
+        template <class InputIt> string_vset(InputIt first, InputIt last)
+        {
+            std::vector<std::string> keys(first, last);
+            detail::sort_unique_strings(keys, [](const std::string &k) -> const std::string & {
+                return k;
+            });
+            m_keys = keys_type(keys);
+        }
+
+        // Iterators
+        const_iterator begin() const { return const_iterator(&m_keys, 0); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator end() const { return const_iterator(&m_keys, size()); }
+        const_iterator cend() const { return end(); }
+
+        // Capacity
+        bool empty() const { return size() == 0; }
+        size_type size() const { return m_keys.size(); }
+        size_type key_bytes() const { return m_keys.key_bytes(); }
+
+        // Modifiers
+        void clear() { m_keys.clear(); }
+
+        std::pair<const_iterator, bool> insert(key_view key)
+        {
+            const auto pos = m_keys.lower_bound(key);
+            if (!pos.found) m_keys.insert(pos.index, key);
+            return std::make_pair(const_iterator(&m_keys, pos.index), !pos.found);
+        }
+
+        size_type erase(key_view key)
+        {
+            const auto pos = m_keys.lower_bound(key);
+            if (!pos.found) return 0;
+            m_keys.erase(pos.index);
+            return 1;
+        }
+
+        void swap(string_vset &other) noexcept { m_keys.swap(other.m_keys); }
+
+        // Lookup
+        size_type count(key_view key) const { return contains(key) ? 1 : 0; }
+        bool contains(key_view key) const { return m_keys.lower_bound(key).found; }
+
+        const_iterator find(key_view key) const
+        {
+            const auto pos = m_keys.lower_bound(key);
+            return const_iterator(&m_keys, pos.found ? pos.index : size());
+        }
+
+        const_iterator lower_bound(key_view key) const
+        {
+            return const_iterator(&m_keys, m_keys.lower_bound(key).index);
+        }
+
+    private:
+        keys_type m_keys;
+    };
+
+    template <std::size_t Restart>
+    void swap(string_vset<Restart> &a, string_vset<Restart> &b) noexcept
+    {
+        a.swap(b);
+    }
+} // namespace ltc
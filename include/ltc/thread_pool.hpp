@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ltc
+{
+    // A fixed size work-stealing thread pool. Every worker owns a deque of tasks: it pushes
+    // and pops its own tasks at the back, and when that runs dry steals from the front of
+    // the other workers' deques. Tasks submitted from outside the pool are spread round
+    // robin over the workers.
+    class thread_pool final
+    {
+    public:
+        using task = std::function<void()>;
+
+        // Starts threads workers, one per hardware thread by default.
+        explicit thread_pool(std::size_t threads = default_size());
+        ~thread_pool();
+
+        thread_pool(const thread_pool &) = delete;
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        // The process wide pool, sized to the machine and started on first use.
+        static thread_pool &instance();
+
+        static std::size_t default_size();
+
+        std::size_t size() const { return m_workers.size(); }
+
+        void submit(task t);
+
+        // Runs one queued task on the calling thread, if there is one. Lets a thread that
+        // waits for tasks help out instead of blocking.
+        bool try_run_one();
+
+        // Index of the calling thread among the workers of this pool, or size() if it is not
+        // one of them.
+        std::size_t worker_index() const;
+
+    private:
+        struct worker
+        {
+            std::mutex mutex;
+            std::deque<task> tasks;
+        };
+
+        void run(std::size_t index);
+        bool try_pop(std::size_t index, task &t);
+
+        std::vector<std::unique_ptr<worker>> m_workers;
+        std::vector<std::thread> m_threads;
+        std::atomic<std::size_t> m_queued{ 0 };
+        std::atomic<std::size_t> m_next{ 0 };
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_stop = false;
+    };
+
+    // Runs tasks on a pool and waits for all of them. wait() runs queued tasks while it
+    // waits, so groups may be nested inside pool tasks without deadlock. The first exception
+    // thrown by a task is rethrown by wait().
+    class task_group final
+    {
+    public:
+        explicit task_group(thread_pool &pool = thread_pool::instance()) : m_pool(pool) {}
+        ~task_group();
+
+        task_group(const task_group &) = delete;
+        task_group &operator=(const task_group &) = delete;
+
+        template <class Fn> void run(Fn fn)
+        {
+            ++m_pending;
+            m_pool.submit([this, fn]() {
+                try
+                {
+                    fn();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_error) m_error = std::current_exception();
+                }
+                --m_pending;
+            });
+        }
+
+        void wait();
+
+        thread_pool &pool() const { return m_pool; }
+
+    private:
+        thread_pool &m_pool;
+        std::atomic<std::size_t> m_pending{ 0 };
+        std::mutex m_mutex;
+        std::exception_ptr m_error;
+    };
+} // namespace ltc
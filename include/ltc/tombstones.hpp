@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include <ltc/range.hpp>
+
+namespace ltc
+{
+    // How erase(key) removes an element from a sorted vector container.
+    enum class erase_mode
+    {
+        immediate, // shift the tail down right away
+        deferred   // mark a tombstone and compact once enough have accumulated
+    };
+
+    // Tracks which positions of a sorted storage are erased but not yet removed.
+    // The bitmap is allocated on the first tombstone and dropped on compaction.
+    class tombstones final
+    {
+    public:
+        using size_type = std::size_t;
+
+        bool empty() const { return m_dead == 0; }
+        size_type count() const { return m_dead; }
+
+        bool is_dead(size_type index) const { return m_dead != 0 && m_bits[index]; }
+
+        // Number of dead positions in [first, last)
+        size_type count(size_type first, size_type last) const
+        {
+            if (m_dead == 0) return 0;
+            return std::count(m_bits.begin() + first, m_bits.begin() + last, true);
+        }
+
+        void mark(size_type index, size_type storage_size)
+        {
+            if (m_bits.empty()) m_bits.assign(storage_size, false);
+            m_bits[index] = true;
+            ++m_dead;
+        }
+
+        void revive(size_type index)
+        {
+            m_bits[index] = false;
+            if (--m_dead == 0) m_bits.clear();
+        }
+
+        // Keeps the bitmap in step with a live element inserted at index
+        void insert(size_type index)
+        {
+            if (!m_bits.empty()) m_bits.insert(m_bits.begin() + index, false);
+        }
+
+        // Keeps the bitmap in step with a physical erase of [first, last)
+        void erase(size_type first, size_type last)
+        {
+            if (m_bits.empty()) return;
+            m_dead -= std::count(m_bits.begin() + first, m_bits.begin() + last, true);
+            m_bits.erase(m_bits.begin() + first, m_bits.begin() + last);
+            if (m_dead == 0) m_bits.clear();
+        }
+
+        void clear()
+        {
+            m_bits.clear();
+            m_dead = 0;
+        }
+
+        bool over(double max_ratio, size_type storage_size) const
+        {
+            return m_dead > max_ratio * storage_size;
+        }
+
+        // Removes every element of storage that is dead or matches pred in one pass, keeping
+        // the order of the rest. Returns the number of elements matching pred.
+        template <class Storage, class Pred> size_type remove_if(Storage &storage, Pred pred)
+        {
+            size_type matched = 0;
+            size_type index = 0;
+            auto out = storage.begin();
+            for (auto it = storage.begin(); it != storage.end(); ++it, ++index)
+            {
+                if (is_dead(index)) continue;
+                if (pred(*it))
+                {
+                    ++matched;
+                    continue;
+                }
+                if (out != it) *out = std::move(*it);
+                ++out;
+            }
+            storage.erase(out, storage.end());
+            clear();
+            return matched;
+        }
+
+        template <class Storage> void compact(Storage &storage)
+        {
+            if (m_dead == 0) return;
+            remove_if(storage, [](const typename Storage::value_type &) { return false; });
+        }
+
+    private:
+        std::vector<bool> m_bits;
+        size_type m_dead = 0;
+    };
+
+    // Iterates a sorted storage through its iterator It, stepping over dead positions, so
+    // lookups and traversal skip deferred erases without compacting. Positions count live
+    // elements: without tombstones every operation costs what It's does, with them
+    // advancing and measuring distances walk the bitmap.
+    template <class It>
+    class live_iterator final
+    : public iterator_facade<live_iterator<It>,
+                             std::random_access_iterator_tag,
+                             typename std::iterator_traits<It>::reference>
+    {
+        friend iterator_access;
+        template <class> friend class live_iterator;
+
+    public:
+        live_iterator() = default;
+
+        // it is moved forward past any dead positions
+        live_iterator(It it, It first, It last, const tombstones *dead)
+        : m_it(it), m_first(first), m_last(last), m_dead(dead)
+        {
+            skip();
+        }
+
+        // iterator converts to const_iterator
+        template <class Other, class = std::enable_if_t<std::is_convertible<Other, It>::value>>
+        live_iterator(const live_iterator<Other> &other)
+        : m_it(other.m_it), m_first(other.m_first), m_last(other.m_last), m_dead(other.m_dead)
+        {
+        }
+
+        // The position in the storage
+        It base() const { return m_it; }
+
+    private:
+        typename std::iterator_traits<It>::reference dereference() const { return *m_it; }
+
+        void increment()
+        {
+            ++m_it;
+            skip();
+        }
+
+        void decrement()
+        {
+            do
+                --m_it;
+            while (dead(m_it));
+        }
+
+        void advance(std::ptrdiff_t n)
+        {
+            if (m_dead->empty())
+            {
+                m_it += n;
+                return;
+            }
+            for (; n > 0; --n)
+                increment();
+            for (; n < 0; ++n)
+                decrement();
+        }
+
+        std::ptrdiff_t distance_to(const live_iterator &other) const
+        {
+            const auto a = static_cast<size_t>(m_it - m_first);
+            const auto b = static_cast<size_t>(other.m_it - m_first);
+            if (a <= b) return static_cast<std::ptrdiff_t>(b - a - m_dead->count(a, b));
+            return -static_cast<std::ptrdiff_t>(a - b - m_dead->count(b, a));
+        }
+
+        bool equal(const live_iterator &other) const { return m_it == other.m_it; }
+
+        bool dead(It it) const { return m_dead->is_dead(static_cast<size_t>(it - m_first)); }
+
+        void skip()
+        {
+            while (m_it != m_last && dead(m_it))
+                ++m_it;
+        }
+
+        It m_it{};
+        It m_first{};
+        It m_last{};
+        const tombstones *m_dead = nullptr;
+    };
+} // namespace ltc
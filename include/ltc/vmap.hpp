@@ -13,12 +13,16 @@
 namespace ltc
 {
 
-    template <class Key, class T, class Compare = std::less<Key>, class Allocator = std::allocator<std::pair<Key, T>>>
-    class vmap : public vmap_base<std::vector<std::pair<Key, T>, Allocator>, Compare>
+    template <class Key,
+              class T,
+              class Compare = std::less<Key>,
+              class Allocator = std::allocator<std::pair<Key, T>>,
+              class Stats = no_stats>
+    class vmap : public vmap_base<std::vector<std::pair<Key, T>, Allocator>, Compare, Stats>
     {
     public:
         using storage_type = std::vector<std::pair<Key, T>, Allocator>;
-        using base_type = vmap_base<storage_type, Compare>;
+        using base_type = vmap_base<storage_type, Compare, Stats>;
         using allocator_type = Allocator;
 
         // Construction
@@ -49,7 +53,7 @@ namespace ltc
         vmap(std::initializer_list<typename base_type::value_type> init,
              const Compare &comp = Compare(),
              const Allocator &alloc = Allocator())
-        : base_type(storage_type(std::move(init), alloc))
+        : base_type(comp, storage_type(std::move(init), alloc))
         {
         }
 
@@ -70,6 +74,21 @@ namespace ltc
         {
         }
 
+        vmap(sorted_unique_t, storage_type &&storage, const Compare &comp = Compare())
+        : base_type(sorted_unique, comp, std::move(storage))
+        {
+        }
+
+        template <class InputIt>
+        vmap(sorted_unique_t,
+             InputIt first,
+             InputIt last,
+             const Compare &comp = Compare(),
+             const Allocator &alloc = Allocator())
+        : base_type(sorted_unique, comp, storage_type(first, last, alloc))
+        {
+        }
+
         allocator_type get_allocator() const noexcept { return this->m_storage.get_allocator(); }
 
         vmap &operator=(const vmap &other)
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <ltc/vmap_base.hpp>
+
+namespace ltc
+{
+    // A sorted vector map that keeps duplicate keys. Elements with equivalent keys stay in
+    // insertion order and form a contiguous run, so equal_range is two binary searches and
+    // a key's values need no allocation of their own. insert returns only the position,
+    // erase(key) removes the whole run and count(key) is its length; there is no at() or
+    // operator[].
+    template <class Key,
+              class T,
+              class Compare = std::less<Key>,
+              class Allocator = std::allocator<std::pair<Key, T>>,
+              class Stats = no_stats>
+    class vmultimap
+    : public vmap_base<std::vector<std::pair<Key, T>, Allocator>, Compare, Stats, false>
+    {
+    public:
+        using storage_type = std::vector<std::pair<Key, T>, Allocator>;
+        using base_type = vmap_base<storage_type, Compare, Stats, false>;
+        using allocator_type = Allocator;
+
+        // Construction
+        vmultimap() : base_type() {}
+
+        explicit vmultimap(const Compare &comp, const Allocator &alloc = Allocator())
+        : base_type(comp, storage_type(alloc))
+        {
+        }
+
+        explicit vmultimap(const Allocator &alloc) : base_type(storage_type(alloc)) {}
+
+        vmultimap(const vmultimap &other) : base_type(other) {}
+
+        vmultimap(vmultimap &&other) : base_type(std::move(other)) {}
+
+        vmultimap(std::initializer_list<typename base_type::value_type> init,
+                  const Compare &comp = Compare(),
+                  const Allocator &alloc = Allocator())
+        : base_type(comp, storage_type(std::move(init), alloc))
+        {
+        }
+
+        template <class InputIt>
+        vmultimap(InputIt first,
+                  InputIt last,
+                  const Compare &comp = Compare(),
+                  const Allocator &alloc = Allocator())
+        : base_type(comp, storage_type(first, last, alloc))
+        {
+        }
+
+        allocator_type get_allocator() const noexcept { return this->m_storage.get_allocator(); }
+
+        vmultimap &operator=(const vmultimap &other)
+        {
+            *static_cast<base_type *>(this) = other;
+            return *this;
+        }
+
+        vmultimap &operator=(vmultimap &&other)
+        {
+            *static_cast<base_type *>(this) = std::move(other);
+            return *this;
+        }
+
+        vmultimap &operator=(std::initializer_list<typename base_type::value_type> ilist)
+        {
+            *static_cast<base_type *>(this) = std::move(ilist);
+            return *this;
+        }
+    };
+
+    template <class Key, class T, class Compare, class Allocator, class Stats>
+    void swap(vmultimap<Key, T, Compare, Allocator, Stats> &a,
+              vmultimap<Key, T, Compare, Allocator, Stats> &b)
+    {
+        a.swap(b);
+    }
+} // namespace ltc
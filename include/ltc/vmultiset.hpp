@@ -0,0 +1,25 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include <ltc/vset.hpp>
+
+namespace ltc
+{
+    // A sorted vector set that keeps duplicates. Equivalent elements stay in insertion order
+    // and form a contiguous run, so equal_range is two binary searches. insert returns only
+    // the position, erase(key) removes the whole run and count(key) is its length.
+    template <class Key,
+              class Compare = std::less<Key>,
+              class Allocator = std::allocator<Key>,
+              class Stats = no_stats>
+    using vmultiset = vset<Key, Compare, Allocator, Stats, false>;
+
+    template <class Key, class Compare, class Allocator, class Stats>
+    void swap(vmultiset<Key, Compare, Allocator, Stats> &a,
+              vmultiset<Key, Compare, Allocator, Stats> &b)
+    {
+        a.swap(b);
+    }
+} // namespace ltc
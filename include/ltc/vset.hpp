@@ -1,18 +1,37 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <functional>
 #include <initializer_list>
+#include <iterator>
+#include <numeric>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include <ltc/bounds.hpp>
+#include <ltc/exponential_search.hpp>
+#include <ltc/radix_sort.hpp>
+#include <ltc/sorted_unique.hpp>
+#include <ltc/span.hpp>
+#include <ltc/stats.hpp>
+#include <ltc/tombstones.hpp>
+
 namespace ltc
 {
 
-    template <class Key, class Compare = std::less<Key>, class Allocator = std::allocator<Key>>
-    class vset
+    // Stats is a compile-time stats policy, no_stats or counting_stats, see stats.hpp.
+    // With Unique false, equivalent elements are all kept, in insertion order, as a
+    // contiguous run (see vmultiset).
+    template <class Key,
+              class Compare = std::less<Key>,
+              class Allocator = std::allocator<Key>,
+              class Stats = no_stats,
+              bool Unique = true>
+    class vset : public stats_holder<Stats>
     {
     public:
         using key_type = Key;
@@ -22,17 +41,20 @@ namespace ltc
         using key_compare = Compare;
         using value_compare = Compare;
         using storage_type = std::vector<value_type, Allocator>;
-        using iterator = typename storage_type::iterator;
-        using const_iterator = typename storage_type::const_iterator;
-        using reverse_iterator = typename storage_type::reverse_iterator;
-        using const_reverse_iterator = typename storage_type::const_reverse_iterator;
+        using iterator = live_iterator<typename storage_type::iterator>;
+        using const_iterator = live_iterator<typename storage_type::const_iterator>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
         using allocator_type = Allocator;
+        // What insert(value) returns: the position and whether it was inserted for unique
+        // keys, only the position otherwise
+        using insert_result = std::conditional_t<Unique, std::pair<iterator, bool>, iterator>;
 
         // Construction
         vset() : m_key_comp(key_compare()), m_value_comp(key_compare()), m_storage(Allocator()) {}
 
         explicit vset(const Compare &comp, const Allocator &alloc = Allocator())
-        : m_key_comp(comp), m_value_comp(comp), m_storage(Allocator())
+        : m_key_comp(comp), m_value_comp(comp), m_storage(alloc)
         {
         }
 
@@ -42,23 +64,33 @@ namespace ltc
         }
 
         vset(const vset &other)
-        : m_key_comp(key_compare()), m_value_comp(key_compare()), m_storage(other.m_storage)
+        : stats_holder<Stats>(other), m_key_comp(other.m_key_comp),
+          m_value_comp(other.m_value_comp), m_storage(other.m_storage),
+          m_tombstones(other.m_tombstones), m_erase_mode(other.m_erase_mode),
+          m_max_tombstone_ratio(other.m_max_tombstone_ratio)
         {
         }
         vset(const vset &other, const Allocator &alloc)
-        : m_key_comp(key_compare()), m_value_comp(key_compare()), m_storage(other.m_storage, alloc)
+        : m_key_comp(other.m_key_comp), m_value_comp(other.m_value_comp),
+          m_storage(other.m_storage, alloc), m_tombstones(other.m_tombstones),
+          m_erase_mode(other.m_erase_mode), m_max_tombstone_ratio(other.m_max_tombstone_ratio)
         {
         }
 
         vset(vset &&other)
-        : m_key_comp(key_compare()), m_value_comp(key_compare()), m_storage(std::move(other.m_storage))
+        : m_key_comp(other.m_key_comp), m_value_comp(other.m_value_comp),
+          m_storage(std::move(other.m_storage)), m_tombstones(std::move(other.m_tombstones)),
+          m_erase_mode(other.m_erase_mode), m_max_tombstone_ratio(other.m_max_tombstone_ratio)
         {
+            other.m_tombstones.clear();
         }
 
         vset(vset &&other, const Allocator &alloc)
-        : m_key_comp(key_compare()), m_value_comp(key_compare()),
-          m_storage(std::move(other.m_storage), alloc)
+        : m_key_comp(other.m_key_comp), m_value_comp(other.m_value_comp),
+          m_storage(std::move(other.m_storage), alloc), m_tombstones(std::move(other.m_tombstones)),
+          m_erase_mode(other.m_erase_mode), m_max_tombstone_ratio(other.m_max_tombstone_ratio)
         {
+            other.m_tombstones.clear();
         }
 
         vset(std::initializer_list<value_type> init,
@@ -66,225 +98,423 @@ namespace ltc
              const Allocator &alloc = Allocator())
         : m_key_comp(comp), m_value_comp(comp), m_storage(std::move(init), alloc)
         {
-            std::sort(m_storage.begin(), m_storage.end(), m_value_comp);
+            sort_storage();
         }
 
         vset(std::initializer_list<value_type> init, const Allocator &alloc)
         : m_key_comp(key_compare()), m_value_comp(key_compare()), m_storage(std::move(init), alloc)
         {
-            std::sort(m_storage.begin(), m_storage.end(), m_value_comp);
+            sort_storage();
         }
 
         template <class InputIt>
         vset(InputIt first, InputIt last, const Compare &comp = Compare(), const Allocator &alloc = Allocator())
         : m_key_comp(comp), m_value_comp(comp), m_storage(first, last, alloc)
         {
-            std::sort(m_storage.begin(), m_storage.end(), m_value_comp);
-            m_storage.erase(std::unique(m_storage.begin(), m_storage.end()), m_storage.end());
+            sort_storage();
         }
 
         template <class InputIt>
         vset(InputIt first, InputIt last, const Allocator &alloc)
         : m_key_comp(key_compare()), m_value_comp(key_compare()), m_storage(first, last, alloc)
         {
-            std::sort(m_storage.begin(), m_storage.end(), m_value_comp);
-            m_storage.erase(std::unique(m_storage.begin(), m_storage.end()), m_storage.end());
+            sort_storage();
+        }
+
+        vset(sorted_unique_t, storage_type &&storage, const Compare &comp = Compare())
+        : m_key_comp(comp), m_value_comp(comp), m_storage(std::move(storage))
+        {
+            assert(is_sorted_storage(m_storage));
+        }
+
+        template <class InputIt>
+        vset(sorted_unique_t,
+             InputIt first,
+             InputIt last,
+             const Compare &comp = Compare(),
+             const Allocator &alloc = Allocator())
+        : m_key_comp(comp), m_value_comp(comp), m_storage(first, last, alloc)
+        {
+            assert(is_sorted_storage(m_storage));
         }
 
         allocator_type get_allocator() const noexcept { return m_storage.get_allocator(); }
 
         vset &operator=(const vset &other)
         {
+            m_key_comp = other.m_key_comp;
+            m_value_comp = other.m_value_comp;
             m_storage = other.m_storage;
+            m_tombstones = other.m_tombstones;
+            m_erase_mode = other.m_erase_mode;
+            m_max_tombstone_ratio = other.m_max_tombstone_ratio;
             return *this;
         }
 
         vset &operator=(vset &&other)
         {
+            m_key_comp = other.m_key_comp;
+            m_value_comp = other.m_value_comp;
             m_storage = std::move(other.m_storage);
+            m_tombstones = std::move(other.m_tombstones);
+            m_erase_mode = other.m_erase_mode;
+            m_max_tombstone_ratio = other.m_max_tombstone_ratio;
+            other.m_tombstones.clear();
             return *this;
         }
 
         vset &operator=(std::initializer_list<value_type> ilist)
         {
             m_storage = std::move(ilist);
+            m_tombstones.clear();
+            sort_storage();
             return *this;
         }
 
-        // Iterators
-        iterator begin() noexcept { return m_storage.begin(); }
-
-        const_iterator begin() const noexcept { return m_storage.begin(); }
-
-        const_iterator cbegin() const noexcept { return m_storage.cbegin(); }
-
-        reverse_iterator rbegin() noexcept { return m_storage.rbegin(); }
+        // Iterators. Iteration steps over elements erased in erase_mode::deferred.
+        iterator begin() noexcept { return wrap(m_storage.begin()); }
+        const_iterator begin() const noexcept { return wrap(m_storage.begin()); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
 
-        const_reverse_iterator rbegin() const noexcept { return m_storage.rbegin(); }
-
-        const_reverse_iterator crbegin() const noexcept { return m_storage.crbegin(); }
-
-        iterator end() noexcept { return m_storage.end(); }
-        const_iterator end() const noexcept { return m_storage.end(); }
-        const_iterator cend() const noexcept { return m_storage.cend(); }
-        reverse_iterator rend() noexcept { return m_storage.rend(); }
-        const_reverse_iterator rend() const noexcept { return m_storage.rend(); }
-        const_reverse_iterator crend() const noexcept { return m_storage.crend(); }
+        iterator end() noexcept { return wrap(m_storage.end()); }
+        const_iterator end() const noexcept { return wrap(m_storage.end()); }
+        const_iterator cend() const noexcept { return end(); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const noexcept { return rend(); }
 
         // Modifiers
-        void clear() { m_storage.clear(); }
-
-        std::pair<iterator, bool> insert(const value_type &value)
+        void clear()
         {
-            auto it = std::lower_bound(m_storage.begin(), m_storage.end(), value, m_value_comp);
-            if (it != m_storage.end() && !m_key_comp(value, *it))
-                return std::make_pair(it, false);
-            return std::make_pair(m_storage.insert(it, value), true);
+            m_storage.clear();
+            m_tombstones.clear();
         }
 
-        std::pair<iterator, bool> insert(value_type &&value)
+        // With duplicates allowed, value goes after the elements equivalent to it
+        insert_result insert(const value_type &value) { return insert_value(value, is_unique()); }
+
+        insert_result insert(value_type &&value)
         {
-            auto it = std::lower_bound(m_storage.begin(), m_storage.end(), value, m_value_comp);
-            if (it != m_storage.end() && !m_key_comp(value, *it))
-                return std::make_pair(it, false);
-            return std::make_pair(m_storage.insert(it, std::move(value)), true);
+            return insert_value(std::move(value), is_unique());
         }
 
         iterator insert(const_iterator hint, const value_type &value)
         {
             // TODO: Make use of hint
-            auto it = std::lower_bound(m_storage.begin(), m_storage.end(), value, m_value_comp);
-            if (it != m_storage.end() && !m_key_comp(value, *it)) return it;
-            return m_storage.insert(it, value);
+            return position(insert(value));
         }
 
         iterator insert(const_iterator hint, value_type &&value)
         {
             // TODO: Make use of hint
-            auto it = std::lower_bound(m_storage.begin(), m_storage.end(), value, m_value_comp);
-            if (it != m_storage.end() && !m_key_comp(value, *it)) return it;
-            return m_storage.insert(it, std::move(value));
+            return position(insert(std::move(value)));
         }
 
-        template <class InputIt> void insert(InputIt first, InputIt last)
+        template <class... Args> insert_result emplace(Args &&... args)
         {
-            const auto insertValue = [&](const auto &value) { this->insert(value); };
-            std::for_each(first, last, insertValue);
+            return insert(value_type(std::forward<Args>(args)...));
         }
 
-        void insert(std::initializer_list<value_type> ilist)
+        // Bulk insert. The new keys are sorted on their own and merged in, which costs
+        // O(n + k log k), or O(n + k) for radix sortable keys, instead of O(n k). With
+        // duplicates allowed, the new keys follow the equivalent ones already present.
+        template <class InputIt> void insert(InputIt first, InputIt last)
         {
-            const auto insertValue = [&](auto &&value) { this->insert(std::move(value)); };
-            std::for_each(ilist.begin(), ilist.end(), insertValue);
+            merge_in(std::vector<value_type>(first, last));
         }
 
-        iterator erase(const_iterator pos) { return m_storage.erase(pos); }
+        void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        iterator erase(const_iterator pos)
+        {
+            const auto index = pos.base() - m_storage.cbegin();
+            m_tombstones.erase(index, index + 1);
+            this->stats().on_erase(1, m_storage.size() - index - 1);
+            return wrap(m_storage.erase(pos.base()));
+        }
 
         iterator erase(const_iterator first, const_iterator last)
         {
-            return m_storage.erase(first, last);
+            const auto index = first.base() - m_storage.cbegin();
+            const auto count = last.base() - first.base();
+            m_tombstones.erase(index, index + count);
+            this->stats().on_erase(count, m_storage.size() - index - count);
+            return wrap(m_storage.erase(first.base(), last.base()));
         }
 
+        // Erases the elements equivalent to key and returns their number. In
+        // erase_mode::deferred they are only marked as erased; the storage is compacted once
+        // the tombstones exceed max_tombstone_ratio() of it.
         size_type erase(const key_type &key)
         {
-            const auto it = find(key);
-            if (it == end()) return 0;
-            m_storage.erase(it);
-            return 1;
+            const auto first = search(m_storage.begin(), m_storage.end(), key);
+            const auto last = run_end(first, m_storage.end(), key);
+            const auto index = static_cast<size_type>(first - m_storage.begin());
+            const auto run = static_cast<size_type>(last - first);
+            const auto erased = run - m_tombstones.count(index, index + run);
+            if (erased == 0) return 0;
+            if (m_erase_mode == erase_mode::immediate)
+            {
+                m_tombstones.erase(index, index + run);
+                this->stats().on_erase(erased, m_storage.size() - index - run);
+                m_storage.erase(first, last);
+                return erased;
+            }
+            this->stats().on_erase(erased, 0);
+            for (auto i = index; i != index + run; ++i)
+                if (!m_tombstones.is_dead(i)) m_tombstones.mark(i, m_storage.size());
+            if (m_tombstones.over(m_max_tombstone_ratio, m_storage.size())) compact();
+            return erased;
+        }
+
+        // Removes all elements for which pred(value) is true in a single pass.
+        template <class Pred> size_type erase_if(Pred pred)
+        {
+            const auto erased = m_tombstones.remove_if(m_storage, pred);
+            this->stats().on_erase(erased, 0);
+            return erased;
+        }
+
+        // Removes the elements marked by deferred erases. Lookups and iteration skip them
+        // without this; erase(key) calls it once they exceed max_tombstone_ratio().
+        void compact() { m_tombstones.compact(m_storage); }
+
+        // Moves the sorted storage out, leaving the set empty.
+        storage_type extract()
+        {
+            compact();
+            storage_type storage(std::move(m_storage));
+            m_storage.clear();
+            return storage;
+        }
+
+        // Replaces the contents with storage that is already sorted, and free of duplicates
+        // if they are not allowed, without sorting it again.
+        void adopt_sorted(storage_type &&storage)
+        {
+            assert(is_sorted_storage(storage));
+            m_storage = std::move(storage);
+            m_tombstones.clear();
+        }
+
+        void swap(vset &other) noexcept
+        {
+            using std::swap;
+            swap(m_key_comp, other.m_key_comp);
+            swap(m_value_comp, other.m_value_comp);
+            m_storage.swap(other.m_storage);
+            swap(m_tombstones, other.m_tombstones);
+            swap(m_erase_mode, other.m_erase_mode);
+            swap(m_max_tombstone_ratio, other.m_max_tombstone_ratio);
         }
 
-        void swap(vset &other) noexcept { m_storage.swap(other.m_storage); }
+        erase_mode get_erase_mode() const { return m_erase_mode; }
+        void set_erase_mode(erase_mode mode) { m_erase_mode = mode; }
+        double max_tombstone_ratio() const { return m_max_tombstone_ratio; }
+        void max_tombstone_ratio(double ratio) { m_max_tombstone_ratio = ratio; }
+        size_type tombstone_count() const { return m_tombstones.count(); }
 
         // Capacity
         void reserve(size_type size) { m_storage.reserve(size); }
-        bool empty() const { return m_storage.empty(); }
-        size_type size() const { return m_storage.size(); }
+        bool empty() const { return size() == 0; }
+        size_type size() const { return m_storage.size() - m_tombstones.count(); }
         size_type max_size() const { return m_storage.max_size(); }
 
         // Lookup
-        size_type count(const Key &key) const { return find(key) != end() ? 1 : 0; }
-
-        bool contains(const Key &key) const { return count(key) == 1; }
+        size_type count(const Key &key) const
+        {
+            const auto first = search(m_storage.begin(), m_storage.end(), key);
+            const auto index = static_cast<size_type>(first - m_storage.begin());
+            const auto run = static_cast<size_type>(run_end(first, m_storage.end(), key) - first);
+            const auto live = run - m_tombstones.count(index, index + run);
+            this->stats().on_find(live != 0);
+            return live;
+        }
+
+        bool contains(const Key &key) const { return find(key) != end(); }
+
+        // Batched lookup. Writes each element that is among the probe keys [first, last) to
+        // out, in order and once per distinct key. The probes are sorted and the storage
+        // walked once, each search starting from the previous hit.
+        template <class InputIt, class OutputIt>
+        OutputIt find_many(InputIt first, InputIt last, OutputIt out) const
+        {
+            std::vector<Key> keys(first, last);
+            std::sort(keys.begin(), keys.end(), m_key_comp);
+            const auto same_key = [this](const Key &a, const Key &b) { return !m_key_comp(a, b); };
+            keys.erase(std::unique(keys.begin(), keys.end(), same_key), keys.end());
+            return find_many(presorted, keys.begin(), keys.end(), out);
+        }
+
+        // As above for probe keys already sorted by key_comp(). Writes an element once per
+        // probe, so repeated probe keys repeat it.
+        template <class ForwardIt, class OutputIt>
+        OutputIt find_many(presorted_t, ForwardIt first, ForwardIt last, OutputIt out) const
+        {
+            auto pos = m_storage.begin();
+            for (; first != last; ++first)
+            {
+                pos = seek_live(pos, *first);
+                if (pos == m_storage.end()) break;
+                // pos stays at the start of the run for the next probe
+                const auto run_last = run_end(pos, m_storage.end(), *first);
+                for (auto it = pos; it != run_last; ++it)
+                    if (!m_tombstones.is_dead(it - m_storage.begin())) *out++ = *it;
+            }
+            return out;
+        }
+
+        // Batched contains. Writes one bool per probe key to out, in the order of the probes.
+        template <class InputIt, class OutputIt>
+        OutputIt contains_many(InputIt first, InputIt last, OutputIt out) const
+        {
+            const std::vector<Key> keys(first, last);
+            std::vector<size_type> order(keys.size());
+            std::iota(order.begin(), order.end(), size_type(0));
+            std::sort(order.begin(), order.end(), [this, &keys](size_type a, size_type b) {
+                return m_key_comp(keys[a], keys[b]);
+            });
+
+            std::vector<char> found(keys.size(), false);
+            auto pos = m_storage.begin();
+            for (const auto i : order)
+            {
+                pos = seek_live(pos, keys[i]);
+                if (pos == m_storage.end()) break;
+                found[i] = !m_key_comp(keys[i], *pos);
+            }
+            for (const auto f : found)
+                *out++ = f != 0;
+            return out;
+        }
+
+        template <class ForwardIt, class OutputIt>
+        OutputIt contains_many(presorted_t, ForwardIt first, ForwardIt last, OutputIt out) const
+        {
+            auto pos = m_storage.begin();
+            for (; first != last; ++first)
+            {
+                if (pos != m_storage.end()) pos = seek_live(pos, *first);
+                *out++ = pos != m_storage.end() && !m_key_comp(*first, *pos);
+            }
+            return out;
+        }
 
         iterator find(const Key &key)
         {
-            auto it = std::lower_bound(m_storage.begin(), m_storage.end(),
-                                       key, m_value_comp);
-            if (it != m_storage.end() && !m_key_comp(key, *it)) return it;
-            return m_storage.end();
+            const auto it = find_live(key);
+            this->stats().on_find(it != m_storage.end());
+            return wrap(it);
         }
 
         const_iterator find(const Key &key) const
         {
-            auto it = std::lower_bound(m_storage.begin(), m_storage.end(),
-                                       key, m_value_comp);
-            if (it != m_storage.end() && !m_key_comp(key, *it)) return it;
-            return m_storage.end();
+            const auto it = find_live(key);
+            this->stats().on_find(it != m_storage.end());
+            return wrap(it);
         }
 
         std::pair<iterator, iterator> equal_range(const Key &key)
         {
-            return std::equal_range(m_storage.begin(), m_storage.end(),
-                                    key, m_value_comp);
+            return wrap(std::equal_range(m_storage.begin(), m_storage.end(), key, m_value_comp));
         }
 
         std::pair<const_iterator, const_iterator> equal_range(const Key &key) const
         {
-            return std::equal_range(m_storage.begin(), m_storage.end(),
-                                    key, m_value_comp);
+            return wrap(std::equal_range(m_storage.begin(), m_storage.end(), key, m_value_comp));
         }
 
         template <class K> std::pair<iterator, iterator> equal_range(const K &x)
         {
-            return std::equal_range(m_storage.begin(), m_storage.end(), x, m_value_comp);
+            return wrap(std::equal_range(m_storage.begin(), m_storage.end(), x, m_value_comp));
         }
 
         template <class K> std::pair<const_iterator, const_iterator> equal_range(const K &x) const
         {
-            return std::equal_range(m_storage.begin(), m_storage.end(), x, m_value_comp);
+            return wrap(std::equal_range(m_storage.begin(), m_storage.end(), x, m_value_comp));
         }
 
         iterator lower_bound(const Key &key)
         {
-            return std::lower_bound(m_storage.begin(), m_storage.end(),
-                                    key, m_value_comp);
+            return wrap(std::lower_bound(m_storage.begin(), m_storage.end(), key, m_value_comp));
         }
 
         const_iterator lower_bound(const Key &key) const
         {
-            return std::lower_bound(m_storage.begin(), m_storage.end(),
-                                    key, m_value_comp);
+            return wrap(std::lower_bound(m_storage.begin(), m_storage.end(), key, m_value_comp));
         }
 
         template <class K> iterator lower_bound(const K &x)
         {
-            return std::lower_bound(m_storage.begin(), m_storage.end(), x, m_value_comp);
+            return wrap(std::lower_bound(m_storage.begin(), m_storage.end(), x, m_value_comp));
         }
 
         template <class K> const_iterator lower_bound(const K &x) const
         {
-            return std::lower_bound(m_storage.begin(), m_storage.end(), x, m_value_comp);
+            return wrap(std::lower_bound(m_storage.begin(), m_storage.end(), x, m_value_comp));
         }
 
-        iterator upper_bound( const Key& key )
+        iterator upper_bound(const Key &key)
         {
-            return std::upper_bound(m_storage.begin(), m_storage.end(), key, m_value_comp);
+            return wrap(std::upper_bound(m_storage.begin(), m_storage.end(), key, m_value_comp));
         }
 
         const_iterator upper_bound(const Key &key) const
         {
-            return std::upper_bound(m_storage.begin(), m_storage.end(),
-                                    key, m_value_comp);
+            return wrap(std::upper_bound(m_storage.begin(), m_storage.end(), key, m_value_comp));
         }
 
         template <class K> iterator upper_bound(const K &x)
         {
-            return std::upper_bound(m_storage.begin(), m_storage.end(), x, m_value_comp);
+            return wrap(std::upper_bound(m_storage.begin(), m_storage.end(), x, m_value_comp));
         }
 
         template <class K> const_iterator upper_bound(const K &x) const
         {
-            return std::upper_bound(m_storage.begin(), m_storage.end(), x, m_value_comp);
+            return wrap(std::upper_bound(m_storage.begin(), m_storage.end(), x, m_value_comp));
+        }
+
+        // The elements between lo and hi, which ends included as given by b, as a view of the
+        // sorted storage. Needs no deferred erases pending: call compact() first. The view is
+        // invalidated by any modification of the set.
+        span<const Key> range(const Key &lo, const Key &hi, bounds b = bounds::right_open) const
+        {
+            assert(m_tombstones.empty());
+            const auto r = range_offsets(lo, hi, b);
+            return span<const Key>(m_storage.data() + r.first, m_storage.data() + r.second);
+        }
+
+        // Order statistics. Positions count live elements in order, from 0. With deferred
+        // erases pending they cost an extra pass over the tombstone bitmap.
+
+        // Number of elements less than key
+        size_type rank(const Key &key) const
+        {
+            const auto index = static_cast<size_type>(
+                std::lower_bound(m_storage.begin(), m_storage.end(), key, m_key_comp) -
+                m_storage.begin());
+            return index - m_tombstones.count(0, index);
+        }
+
+        // The element at position i, or end() if there is none
+        const_iterator select(size_type i) const { return i < size() ? begin() + i : end(); }
+
+        const Key &nth_key(size_type i) const
+        {
+            if (i >= size()) throw std::out_of_range("index");
+            return *select(i);
+        }
+
+        // Number of elements between lo and hi, which ends included as given by b
+        size_type count_range(const Key &lo, const Key &hi, bounds b = bounds::right_open) const
+        {
+            const auto r = range_offsets(lo, hi, b);
+            const auto first = static_cast<size_type>(r.first);
+            const auto last = static_cast<size_type>(r.second);
+            return last - first - m_tombstones.count(first, last);
         }
 
         // Observers
@@ -296,6 +526,218 @@ namespace ltc
         value_compare m_value_comp;
 
     private:
+        using storage_iterator = typename storage_type::iterator;
+        using storage_const_iterator = typename storage_type::const_iterator;
+
+        iterator wrap(storage_iterator it)
+        {
+            return iterator(it, m_storage.begin(), m_storage.end(), &m_tombstones);
+        }
+
+        const_iterator wrap(storage_const_iterator it) const
+        {
+            return const_iterator(it, m_storage.begin(), m_storage.end(), &m_tombstones);
+        }
+
+        std::pair<iterator, iterator> wrap(std::pair<storage_iterator, storage_iterator> r)
+        {
+            return std::make_pair(wrap(r.first), wrap(r.second));
+        }
+
+        std::pair<const_iterator, const_iterator>
+        wrap(std::pair<storage_const_iterator, storage_const_iterator> r) const
+        {
+            return std::make_pair(wrap(r.first), wrap(r.second));
+        }
+
+        // The first live element equivalent to key, or the end of the storage
+        storage_iterator find_live(const Key &key)
+        {
+            auto it = search(m_storage.begin(), m_storage.end(), key);
+            const auto last = run_end(it, m_storage.end(), key);
+            while (it != last && m_tombstones.is_dead(it - m_storage.begin()))
+                ++it;
+            return it != last ? it : m_storage.end();
+        }
+
+        storage_const_iterator find_live(const Key &key) const
+        {
+            auto it = search(m_storage.begin(), m_storage.end(), key);
+            const auto last = run_end(it, m_storage.end(), key);
+            while (it != last && m_tombstones.is_dead(it - m_storage.begin()))
+                ++it;
+            return it != last ? it : m_storage.end();
+        }
+
+        // lower_bound of key in [first, last), reporting the comparisons to the stats policy
+        template <class It> It search(It first, It last, const Key &key) const
+        {
+            size_t comparisons = 0;
+            const auto less = [this, &comparisons](const Key &a, const Key &b) {
+                ++comparisons;
+                return m_key_comp(a, b);
+            };
+            const auto it = std::lower_bound(first, last, key, less);
+            this->stats().on_search(comparisons);
+            return it;
+        }
+
+        // As search, for the upper_bound
+        template <class It> It search_upper(It first, It last, const Key &key) const
+        {
+            size_t comparisons = 0;
+            const auto less = [this, &comparisons](const Key &a, const Key &b) {
+                ++comparisons;
+                return m_key_comp(a, b);
+            };
+            const auto it = std::upper_bound(first, last, key, less);
+            this->stats().on_search(comparisons);
+            return it;
+        }
+
+        // End of the run of elements equivalent to key that starts at it, dead ones included.
+        // Without duplicates the run has at most one element and needs no search.
+        template <class It> It run_end(It it, It last, const Key &key) const
+        {
+            if (it == last || m_key_comp(key, *it)) return it;
+            if (Unique) return std::next(it);
+            return std::upper_bound(std::next(it), last, key, m_key_comp);
+        }
+
+        bool is_sorted_storage(const storage_type &storage) const
+        {
+            return Unique ? is_sorted_unique(storage.begin(), storage.end(), m_value_comp)
+                          : std::is_sorted(storage.begin(), storage.end(), m_value_comp);
+        }
+
+        struct identity
+        {
+            const Key &operator()(const Key &key) const { return key; }
+        };
+
+        // Sorts the storage, keeping equivalent keys in their order. Without duplicates,
+        // drops keys equivalent to the one before.
+        void sort_storage()
+        {
+            sort_by_key(m_storage.begin(), m_storage.end(), identity(), m_key_comp);
+            if (!Unique) return;
+            const auto same = [this](const Key &a, const Key &b) { return !m_key_comp(a, b); };
+            m_storage.erase(std::unique(m_storage.begin(), m_storage.end(), same),
+                            m_storage.end());
+        }
+
+        void merge_in(std::vector<value_type> &&keys)
+        {
+            // A few keys are cheaper to insert one at a time than to merge
+            if (keys.size() < 4)
+            {
+                for (auto &k : keys)
+                    insert(std::move(k));
+                return;
+            }
+            sort_by_key(keys.begin(), keys.end(), identity(), m_key_comp);
+            const auto old_size = size();
+            storage_type merged(m_storage.get_allocator());
+            merged.reserve(old_size + keys.size());
+            // Elements erased in erase_mode::deferred are dropped on the way
+            if (!Unique)
+            {
+                // Stable: existing keys go before equivalent new ones
+                std::merge(std::make_move_iterator(begin()),
+                           std::make_move_iterator(end()),
+                           std::make_move_iterator(keys.begin()),
+                           std::make_move_iterator(keys.end()),
+                           std::back_inserter(merged), m_key_comp);
+                this->stats().on_insert(keys.size(), old_size, true);
+                m_storage = std::move(merged);
+                m_tombstones.clear();
+                return;
+            }
+            std::set_union(std::make_move_iterator(begin()),
+                           std::make_move_iterator(end()),
+                           std::make_move_iterator(keys.begin()),
+                           std::make_move_iterator(keys.end()),
+                           std::back_inserter(merged), m_key_comp);
+            // set_union keeps every duplicate within the new keys past the first
+            const auto same = [this](const Key &a, const Key &b) { return !m_key_comp(a, b); };
+            merged.erase(std::unique(merged.begin(), merged.end(), same), merged.end());
+            this->stats().on_insert(merged.size() - old_size, old_size, true);
+            m_storage = std::move(merged);
+            m_tombstones.clear();
+        }
+
+        // Inserts value before it, reporting the shifted tail and any reallocation
+        template <class V> storage_iterator store(storage_iterator it, V &&value)
+        {
+            const auto index = static_cast<size_t>(it - m_storage.begin());
+            const auto moved = m_storage.size() - index;
+            const auto capacity = m_storage.capacity();
+            it = m_storage.insert(it, std::forward<V>(value));
+            m_tombstones.insert(index);
+            this->stats().on_insert(1, moved, m_storage.capacity() != capacity);
+            return it;
+        }
+
+        using is_unique = std::integral_constant<bool, Unique>;
+
+        template <class V> std::pair<iterator, bool> insert_value(V &&value, std::true_type)
+        {
+            return insert_unique(std::forward<V>(value));
+        }
+
+        template <class V> iterator insert_value(V &&value, std::false_type)
+        {
+            return insert_equal(std::forward<V>(value));
+        }
+
+        static iterator position(const std::pair<iterator, bool> &r) { return r.first; }
+        static iterator position(const iterator &it) { return it; }
+
+        // Inserts value after every element equivalent to it
+        template <class V> iterator insert_equal(V &&value)
+        {
+            const auto it = search_upper(m_storage.begin(), m_storage.end(), value);
+            return wrap(store(it, std::forward<V>(value)));
+        }
+
+        // Inserts value unless a live element is equivalent to it. An equivalent element
+        // erased in erase_mode::deferred is revived instead.
+        template <class V> std::pair<iterator, bool> insert_unique(V &&value)
+        {
+            const auto it = search(m_storage.begin(), m_storage.end(), value);
+            if (it == m_storage.end() || m_key_comp(value, *it))
+                return std::make_pair(wrap(store(it, std::forward<V>(value))), true);
+            const auto index = static_cast<size_t>(it - m_storage.begin());
+            if (!m_tombstones.is_dead(index)) return std::make_pair(wrap(it), false);
+            m_tombstones.revive(index);
+            return std::make_pair(wrap(it), true);
+        }
+
+        std::pair<difference_type, difference_type>
+        range_offsets(const Key &lo, const Key &hi, bounds b) const
+        {
+            const auto first = m_storage.begin();
+            const auto last = m_storage.end();
+            const auto lo_it = includes_lower(b) ? std::lower_bound(first, last, lo, m_key_comp)
+                                                 : std::upper_bound(first, last, lo, m_key_comp);
+            // Searching from lo_it keeps the range empty rather than inverted when hi < lo
+            const auto hi_it = includes_upper(b) ? std::upper_bound(lo_it, last, hi, m_key_comp)
+                                                 : std::lower_bound(lo_it, last, hi, m_key_comp);
+            return std::make_pair(lo_it - first, hi_it - first);
+        }
+
+        // First live element at or after pos that is not less than key
+        storage_const_iterator seek_live(storage_const_iterator pos, const Key &key) const
+        {
+            pos = exponential_lower_bound(pos, m_storage.end(), key, m_value_comp);
+            while (pos != m_storage.end() && m_tombstones.is_dead(pos - m_storage.begin()))
+                ++pos;
+            return pos;
+        }
+
         storage_type m_storage;
+        tombstones m_tombstones;
+        erase_mode m_erase_mode = erase_mode::immediate;
+        double m_max_tombstone_ratio = 0.25;
     };
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <ltc/mapped_file.hpp>
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ltc
+{
+    namespace
+    {
+        // An empty file maps to this, as zero length mappings are not allowed
+        const char empty_file[1] = {};
+    } // namespace
+
+#ifdef _WIN32
+    mapped_file::mapped_file(const std::string &path)
+    {
+        const auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("cannot open " + path);
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("cannot stat " + path);
+        }
+        if (size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            m_data = empty_file;
+            return;
+        }
+        const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) throw std::runtime_error("cannot map " + path);
+        const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view) throw std::runtime_error("cannot map " + path);
+        m_data = static_cast<const char *>(view);
+        m_size = static_cast<std::size_t>(size.QuadPart);
+    }
+
+    void mapped_file::close()
+    {
+        if (m_data && m_data != empty_file) UnmapViewOfFile(m_data);
+        m_data = nullptr;
+        m_size = 0;
+    }
+#else
+    mapped_file::mapped_file(const std::string &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + path);
+        }
+        if (st.st_size == 0)
+        {
+            ::close(fd);
+            m_data = empty_file;
+            return;
+        }
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void *p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+        m_data = static_cast<const char *>(p);
+        m_size = size;
+    }
+
+    void mapped_file::close()
+    {
+        if (m_data && m_data != empty_file) ::munmap(const_cast<char *>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+#endif
+
+    mapped_file::~mapped_file() { close(); }
+
+    mapped_file::mapped_file(mapped_file &&other) noexcept
+    : m_data(other.m_data), m_size(other.m_size)
+    {
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+
+    mapped_file &mapped_file::operator=(mapped_file &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+        }
+        return *this;
+    }
+} // namespace ltc
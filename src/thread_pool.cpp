@@ -0,0 +1,144 @@
+#include <ltc/thread_pool.hpp>
+
+namespace ltc
+{
+    namespace
+    {
+        // The pool and index of the calling worker thread, if any
+        thread_local const thread_pool *t_pool = nullptr;
+        thread_local std::size_t t_index = 0;
+    } // namespace
+
+    thread_pool::thread_pool(std::size_t threads)
+    {
+        if (threads == 0) threads = 1;
+        for (std::size_t i = 0; i < threads; ++i)
+            m_workers.emplace_back(new worker);
+        m_threads.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+            m_threads.emplace_back([this, i]() { run(i); });
+    }
+
+    thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto &t : m_threads)
+            t.join();
+    }
+
+    thread_pool &thread_pool::instance()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    std::size_t thread_pool::default_size()
+    {
+        const auto n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+    std::size_t thread_pool::worker_index() const
+    {
+        return t_pool == this ? t_index : m_workers.size();
+    }
+
+    void thread_pool::submit(task t)
+    {
+        auto index = worker_index();
+        if (index == m_workers.size()) index = m_next++ % m_workers.size();
+        {
+            auto &w = *m_workers[index];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            w.tasks.push_back(std::move(t));
+        }
+        ++m_queued;
+        // Taking the lock orders this wake up after a worker's check of m_queued
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_wake.notify_one();
+    }
+
+    bool thread_pool::try_run_one()
+    {
+        task t;
+        const auto index = worker_index();
+        if (!try_pop(index == m_workers.size() ? 0 : index, t)) return false;
+        t();
+        return true;
+    }
+
+    bool thread_pool::try_pop(std::size_t index, task &t)
+    {
+        if (m_queued.load() == 0) return false;
+
+        // Newest task of our own deque first, for locality
+        {
+            auto &w = *m_workers[index];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            if (!w.tasks.empty() && t_pool == this && t_index == index)
+            {
+                t = std::move(w.tasks.back());
+                w.tasks.pop_back();
+                --m_queued;
+                return true;
+            }
+        }
+
+        // Then the oldest task of any deque, which tends to be the largest piece of work
+        const auto n = m_workers.size();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto &w = *m_workers[(index + i) % n];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            if (w.tasks.empty()) continue;
+            t = std::move(w.tasks.front());
+            w.tasks.pop_front();
+            --m_queued;
+            return true;
+        }
+        return false;
+    }
+
+    void thread_pool::run(std::size_t index)
+    {
+        t_pool = this;
+        t_index = index;
+        for (;;)
+        {
+            task t;
+            if (try_pop(index, t))
+            {
+                t();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stop || m_queued.load() > 0; });
+            if (m_stop && m_queued.load() == 0) return;
+        }
+    }
+
+    task_group::~task_group()
+    {
+        // Tasks refer to this group, so they must finish before it goes away
+        while (m_pending.load() > 0)
+            if (!m_pool.try_run_one()) std::this_thread::yield();
+    }
+
+    void task_group::wait()
+    {
+        while (m_pending.load() > 0)
+            if (!m_pool.try_run_one()) std::this_thread::yield();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(error, m_error);
+        }
+        if (error) std::rethrow_exception(error);
+    }
+} // namespace ltc
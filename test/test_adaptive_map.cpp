@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/adaptive_map.hpp>
+
+using namespace ltc;
+
+class Test_adaptive_map : public ::testing::Test
+{
+};
+
+using small_map = adaptive_map<int, int, std::less<int>, 4>;
+
+TEST_F(Test_adaptive_map, promotion)
+{
+    small_map m(16);
+    ASSERT_EQ(m.current_layout(), small_map::layout::inline_array);
+    ASSERT_EQ(m.tree_threshold(), 16);
+
+    for (int i = 0; i < 4; ++i)
+        ASSERT_TRUE(m.insert(std::make_pair(i, i)).second);
+    ASSERT_EQ(m.current_layout(), small_map::layout::inline_array);
+
+    // A duplicate does not promote, a new key does
+    ASSERT_FALSE(m.insert(std::make_pair(0, 0)).second);
+    ASSERT_EQ(m.current_layout(), small_map::layout::inline_array);
+    m[4] = 4;
+    ASSERT_EQ(m.current_layout(), small_map::layout::flat);
+
+    for (int i = 5; i < 17; ++i)
+        m.insert(std::make_pair(i, i));
+    ASSERT_EQ(m.current_layout(), small_map::layout::tree);
+    ASSERT_EQ(m.size(), 17);
+    for (int i = 0; i < 17; ++i)
+        ASSERT_EQ(m.at(i), i);
+
+    m.clear();
+    ASSERT_TRUE(m.empty());
+    ASSERT_EQ(m.current_layout(), small_map::layout::inline_array);
+}
+
+TEST_F(Test_adaptive_map, iterators)
+{
+    for (const int n : { 3, 10, 40 })
+    {
+        small_map m(16);
+        for (int i = n; i > 0; --i)
+            m[i * 2] = i;
+
+        std::vector<int> keys;
+        for (const auto &v : m)
+            keys.push_back(v.first);
+        ASSERT_EQ(keys.size(), static_cast<size_t>(n));
+        ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+        const small_map &cm = m;
+        ASSERT_EQ(std::distance(cm.begin(), cm.end()), n);
+        ASSERT_EQ(cm.rbegin()->first, 2 * n);
+
+        auto it = m.lower_bound(3);
+        ASSERT_EQ(it->first, 4);
+        it->second = 100;
+        ASSERT_EQ(m.at(4), 100);
+        ASSERT_EQ(m.upper_bound(4)->first, 6);
+        ASSERT_EQ(m.find(5), m.end());
+
+        small_map::const_iterator cit = m.find(2);
+        ASSERT_EQ(cit, m.begin());
+        it = m.erase(cit);
+        ASSERT_EQ(it->first, 4);
+        ASSERT_EQ(m.size(), static_cast<size_t>(n - 1));
+    }
+}
+
+TEST_F(Test_adaptive_map, random_against_map)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> key(0, 500);
+    small_map m(64);
+    std::map<int, int> ref;
+    for (int i = 0; i < 5000; ++i)
+    {
+        const auto k = key(rng);
+        if (rng() % 3 == 0)
+        {
+            ASSERT_EQ(m.erase(k), ref.erase(k));
+        }
+        else
+        {
+            m[k] = i;
+            ref[k] = i;
+        }
+    }
+    ASSERT_EQ(m.current_layout(), small_map::layout::tree);
+    ASSERT_EQ(m.size(), ref.size());
+    ASSERT_TRUE(std::equal(m.begin(), m.end(), ref.begin(), ref.end(),
+                           [](const std::pair<int, int> &a, const std::pair<const int, int> &b) {
+                               return a.first == b.first && a.second == b.second;
+                           }));
+}
+
+TEST_F(Test_adaptive_map, copy_move)
+{
+    adaptive_map<std::string, int, std::less<std::string>, 2> a(4);
+    for (int i = 0; i < 10; ++i)
+        a[std::to_string(i)] = i;
+
+    auto b = a;
+    b["0"] = 42;
+    ASSERT_EQ(a.at("0"), 0);
+    ASSERT_EQ(b.at("0"), 42);
+
+    auto c = std::move(b);
+    ASSERT_EQ(c.size(), 10);
+    ASSERT_EQ(c.at("0"), 42);
+    ASSERT_TRUE(b.empty());
+    ASSERT_THROW(b.at("0"), std::out_of_range);
+}
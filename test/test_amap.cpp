@@ -231,6 +231,24 @@ TEST_F(Test_amap, count)
     ASSERT_EQ(m.count("4"), 0);
 }
 
+TEST_F(Test_amap, extract_adopt_sorted)
+{
+    using map_t = amap<std::string, int, 10>;
+    map_t m = { { "3", 3 }, { "2", 2 }, { "1", 1 } };
+    auto storage = m.extract();
+    ASSERT_TRUE(m.empty());
+    ASSERT_EQ(storage.size(), 3);
+    ASSERT_EQ(storage.front().first, "1");
+
+    map_t m2(sorted_unique, std::move(storage));
+    ASSERT_EQ(m2.size(), 3);
+    ASSERT_EQ(m2.at("3"), 3);
+
+    m.adopt_sorted(m2.extract());
+    ASSERT_EQ(m.size(), 3);
+    ASSERT_TRUE(m2.empty());
+}
+
 TEST_F(Test_amap, contains)
 {
     using map_t = amap<std::string, int, 50>;
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/art_map.hpp>
+
+using namespace ltc;
+
+class Test_art_map : public ::testing::Test
+{
+protected:
+    template <class Key, class T>
+    static void check(const art_map<Key, T> &m, const std::map<Key, T> &expected)
+    {
+        ASSERT_EQ(m.size(), expected.size());
+        ASSERT_TRUE((std::equal(m.begin(), m.end(), expected.begin(), expected.end())));
+        ASSERT_TRUE((std::equal(std::make_reverse_iterator(m.end()),
+                                std::make_reverse_iterator(m.begin()), expected.rbegin(),
+                                expected.rend())));
+    }
+
+    // Keys over a small alphabet, so many share prefixes and many are prefixes of others
+    static std::string random_key(std::mt19937 &rng)
+    {
+        std::string key(rng() % 6, 'a');
+        for (auto &c : key)
+            c = static_cast<char>(rng() % 5 == 0 ? 0xf0 + rng() % 3 : 'a' + rng() % 3);
+        return key;
+    }
+};
+
+TEST_F(Test_art_map, strings_match_std_map)
+{
+    std::mt19937 rng(5);
+    art_map<std::string, int> m;
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        const auto key = random_key(rng);
+        switch (rng() % 4)
+        {
+        case 0:
+            ASSERT_EQ(m.erase(key), expected.erase(key));
+            break;
+        case 1:
+            m.insert_or_assign(key, i);
+            expected[key] = i;
+            break;
+        default:
+        {
+            const auto r = m.insert({ key, i });
+            ASSERT_EQ(r.second, expected.insert({ key, i }).second);
+            ASSERT_EQ(r.first->first, key);
+        }
+        }
+        const auto probe = random_key(rng);
+        const auto lb = m.lower_bound(probe);
+        const auto exp = expected.lower_bound(probe);
+        ASSERT_EQ(lb == m.end(), exp == expected.end());
+        if (exp != expected.end())
+        {
+            ASSERT_EQ(lb->first, exp->first);
+        }
+        ASSERT_EQ(m.contains(probe), expected.count(probe) == 1);
+    }
+    check(m, expected);
+
+    for (const auto &e : expected)
+    {
+        ASSERT_EQ(m.at(e.first), e.second);
+        const auto ub = m.upper_bound(e.first);
+        const auto exp = expected.upper_bound(e.first);
+        ASSERT_EQ(ub == m.end(), exp == expected.end());
+        if (exp != expected.end())
+        {
+            ASSERT_EQ(ub->first, exp->first);
+        }
+    }
+    ASSERT_THROW(m.at("zzzzzzz"), std::out_of_range);
+}
+
+TEST_F(Test_art_map, integers_grow_and_shrink)
+{
+    // Dense keys fill every node kind up to 256 children, erasing empties them again
+    art_map<int32_t, int> m;
+    std::map<int32_t, int> expected;
+    for (int32_t i = -70000; i < 70000; i += 3)
+    {
+        m[i] = i;
+        expected[i] = i;
+    }
+    check(m, expected);
+    ASSERT_EQ(m.lower_bound(-70001)->first, -70000);
+    ASSERT_EQ(m.lower_bound(-2)->first, -1);
+    ASSERT_EQ(m.lower_bound(69999), m.end());
+    ASSERT_EQ(std::prev(m.end())->first, 69998);
+
+    std::mt19937 rng(9);
+    std::vector<int32_t> keys;
+    for (const auto &e : expected)
+        keys.push_back(e.first);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        ASSERT_EQ(m.erase(keys[i]), 1u);
+        expected.erase(keys[i]);
+        if (i % 5000 == 0) check(m, expected);
+    }
+    ASSERT_TRUE(m.empty());
+    ASSERT_EQ(m.begin(), m.end());
+
+    const art_map<uint64_t, int> big = { { uint64_t(-1), 1 }, { 0, 2 }, { 1u << 31, 3 } };
+    ASSERT_EQ(big.begin()->second, 2);
+    ASSERT_EQ(std::prev(big.end())->second, 1);
+    ASSERT_EQ(big.lower_bound(5)->second, 3);
+}
+
+TEST_F(Test_art_map, prefix_range)
+{
+    art_map<std::string, int> m = { { "10.0.0.0/8", 1 },    { "10.1.0.0/16", 2 },
+                                    { "10.1.2.0/24", 3 },   { "10.10.0.0/16", 4 },
+                                    { "192.168.0.0/16", 5 }, { "10", 6 } };
+    const auto values = [](auto r) {
+        std::vector<int> v;
+        for (; r.first != r.second; ++r.first)
+            v.push_back(r.first->second);
+        return v;
+    };
+    ASSERT_EQ(values(m.prefix_range("10.1")), (std::vector<int>{ 2, 3, 4 }));
+    ASSERT_EQ(values(m.prefix_range("10.1.")), (std::vector<int>{ 2, 3 }));
+    ASSERT_EQ(values(m.prefix_range("10")), (std::vector<int>{ 6, 1, 2, 3, 4 }));
+    ASSERT_EQ(values(m.prefix_range("")), (std::vector<int>{ 6, 1, 2, 3, 4, 5 }));
+    ASSERT_EQ(values(m.prefix_range("192.168.0.0/16")), (std::vector<int>{ 5 }));
+    ASSERT_TRUE(values(m.prefix_range("11")).empty());
+    ASSERT_TRUE(values(m.prefix_range("192.168.0.0/160")).empty());
+    ASSERT_EQ(m.prefix_range("11").first->second, 5);
+
+    std::mt19937 rng(2);
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 3000; ++i)
+        m[random_key(rng)] = i;
+    for (const auto &e : m)
+        expected[e.first] = e.second;
+    for (int i = 0; i < 500; ++i)
+    {
+        const auto p = random_key(rng);
+        std::vector<int> exp;
+        for (auto it = expected.lower_bound(p);
+             it != expected.end() && it->first.compare(0, p.size(), p) == 0; ++it)
+            exp.push_back(it->second);
+        ASSERT_EQ(values(m.prefix_range(p)), exp);
+    }
+}
+
+TEST_F(Test_art_map, copy_and_erase_iterator)
+{
+    art_map<std::string, int> m = { { "b", 2 }, { "a", 1 }, { "c", 3 }, { "a", 9 } };
+    ASSERT_EQ(m.at("a"), 1);
+    const auto copy = m;
+    auto it = m.erase(m.find("b"));
+    ASSERT_EQ(it->first, "c");
+    ASSERT_EQ(m.size(), 2u);
+    ASSERT_EQ(copy.size(), 3u);
+    ASSERT_EQ(copy.at("b"), 2);
+
+    art_map<std::string, int> moved = std::move(m);
+    ASSERT_EQ(moved.size(), 2u);
+    ASSERT_TRUE(m.empty());
+    moved.clear();
+    ASSERT_TRUE(moved.empty());
+    moved["x"] = 1;
+    ASSERT_EQ(moved.begin()->first, "x");
+}
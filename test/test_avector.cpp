@@ -181,16 +181,43 @@ TEST_F(Test_avector, access)
     ASSERT_EQ(v.at(0), 1);
     ASSERT_EQ(v.at(1), 2);
     ASSERT_EQ(v.at(2), 3);
+    ASSERT_THROW(v.at(3), std::out_of_range);
+    const auto &cv = v;
+    ASSERT_THROW(cv.at(5), std::out_of_range);
     ASSERT_EQ(v.front(), 1);
     ASSERT_EQ(v.back(), 3);
 }
 
 TEST_F(Test_avector, emplace)
 {
-    avector<std::string, 1> v = { "0" };
-    const auto it = v.emplace(v.begin(), "1");
-    ASSERT_EQ(*it, "1");
-    ASSERT_EQ(v.size(), 1);
+    avector<std::string, 3> v = { "0" };
+    auto it = v.emplace(v.begin(), 2, '1');
+    ASSERT_EQ(*it, "11");
+    it = v.emplace(v.end(), "2");
+    ASSERT_EQ(*it, "2");
+    ASSERT_EQ(v.size(), 3);
+    ASSERT_EQ(to_str(v.begin(), v.end()), "1102");
+    ASSERT_THROW(v.emplace(v.begin(), "3"), std::length_error);
+}
+
+TEST_F(Test_avector, emplace_element)
+{
+    // Arguments that refer to the vector itself are read before anything moves
+    avector<std::string, 3> v = { "a", "b" };
+    v.emplace(v.begin(), v[1]);
+    ASSERT_EQ(to_str(v.begin(), v.end()), "bab");
+}
+
+TEST_F(Test_avector, insert_element)
+{
+    // As with emplace, a value that is an element of the vector is copied before it moves
+    avector<int, 4> v{ 1, 2, 3 };
+    v.insert(v.begin(), v[1]);
+    ASSERT_EQ(to_str(v.begin(), v.end()), "2123");
+
+    avector<int, 6> w{ 1, 2, 3 };
+    w.insert(w.begin(), 2, w[0]);
+    ASSERT_EQ(to_str(w.begin(), w.end()), "11123");
 }
 
 TEST_F(Test_avector, emplace_back)
@@ -256,6 +283,52 @@ TEST_F(Test_avector, push_back_2)
     ASSERT_EQ(cval, "");
 }
 
+TEST_F(Test_avector, try_push_back)
+{
+    avector<std::string, 2> v;
+    const std::string cval = "1";
+    ASSERT_EQ(*v.try_push_back(cval), "1");
+    ASSERT_EQ(*v.try_emplace_back(2, '2'), "22");
+    ASSERT_EQ(v.try_push_back(cval), nullptr);
+    ASSERT_EQ(v.try_push_back("3"), nullptr);
+    ASSERT_EQ(v.try_emplace_back("3"), nullptr);
+    ASSERT_EQ(to_str(v.begin(), v.end()), "122");
+    ASSERT_THROW(v.push_back(cval), std::length_error);
+}
+
+TEST_F(Test_avector, unchecked_push_back)
+{
+    avector<int, 3> v;
+    v.unchecked_push_back(1);
+    const int two = 2;
+    v.unchecked_push_back(two);
+    ASSERT_EQ(v.unchecked_emplace_back(3), 3);
+    ASSERT_EQ(to_str(v.begin(), v.end()), "123");
+}
+
+TEST_F(Test_avector, reserve)
+{
+    avector<int, 3> v;
+    v.reserve(3);
+    ASSERT_THROW(v.reserve(4), std::length_error);
+}
+
+TEST_F(Test_avector, insert_erase_trivial)
+{
+    // Trivially copyable elements take the memmove path
+    avector<int, 8> v = { 1, 2, 3, 4 };
+    v.insert(v.begin() + 1, { 7, 8 });
+    ASSERT_EQ(to_str(v.begin(), v.end()), "178234");
+    v.insert(v.end(), 2, 9);
+    ASSERT_EQ(to_str(v.begin(), v.end()), "17823499");
+    ASSERT_THROW(v.insert(v.begin(), 0), std::length_error);
+    v.erase(v.begin(), v.begin() + 3);
+    ASSERT_EQ(to_str(v.begin(), v.end()), "23499");
+    v.erase(v.end() - 1);
+    v.erase(v.begin());
+    ASSERT_EQ(to_str(v.begin(), v.end()), "349");
+}
+
 TEST_F(Test_avector, pop_back)
 {
     avector<int, 5> v = { 1, 2, 3 };
@@ -299,3 +372,22 @@ TEST_F(Test_avector, swap)
     ASSERT_EQ(v1.size(), 2);
     ASSERT_EQ(v2.size(), 3);
 }
+
+TEST_F(Test_avector, stats)
+{
+    // The default policy takes no space
+    ASSERT_EQ(sizeof(avector<int, 4>), sizeof(std::array<int, 4>) + sizeof(int *));
+
+    avector<int, 8, counting_stats> v;
+    v.push_back(2);
+    v.push_back(3);
+    v.insert(v.begin(), 1);
+    v.erase(v.begin());
+    v.erase(v.begin(), v.end());
+
+    const auto s = v.snapshot();
+    ASSERT_EQ(s.inserts, 3);
+    ASSERT_EQ(s.erases, 3);
+    ASSERT_EQ(s.moved, 2 + 2);
+    ASSERT_EQ(s.reallocations, 0);
+}
@@ -1,6 +1,13 @@
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include <ltc/bloom.hpp>
+#include <ltc/parallel_bloom.hpp>
+#include <ltc/thread_pool.hpp>
 
 using namespace ltc;
 
@@ -84,4 +91,154 @@ TEST_F(Test_bloom, calculator)
 {
     bloom_calculator c;
     ASSERT_EQ(c.items(), 4000);
-}
\ No newline at end of file
+}
+
+TEST_F(Test_bloom, stats)
+{
+    bloom_filter<int, std::hash<int>, counting_stats> filter(1024, 3);
+    ASSERT_EQ(filter.fill_ratio(), 0.0);
+    ASSERT_EQ(filter.estimated_fpp(), 0.0);
+
+    for (int i = 0; i < 100; ++i)
+        filter.add(i);
+    for (int i = 0; i < 100; ++i)
+        ASSERT_TRUE(filter.possibly_contains(i));
+
+    const auto s = filter.snapshot();
+    ASSERT_EQ(s.inserts, 100);
+    ASSERT_EQ(s.finds, 100);
+    ASSERT_EQ(s.hits, 100);
+    ASSERT_GT(s.fill_ratio, 0.0);
+    ASSERT_LE(s.fill_ratio, 300.0 / 1024);
+    ASSERT_DOUBLE_EQ(s.estimated_fpp, std::pow(s.fill_ratio, 3));
+    // Close to the expectation (1 - e^(-3 * 100 / 1024))^3
+    ASSERT_NEAR(s.estimated_fpp, 0.0168, 0.003);
+}
+
+TEST_F(Test_bloom, merge)
+{
+    bloom_filter<int> a(1 << 16, 5, 42), b(1 << 16, 5, 42);
+    for (int i = 0; i < 3000; ++i)
+        a.add(i);
+    for (int i = 2000; i < 5000; ++i)
+        b.add(i);
+    ASSERT_TRUE(a.compatible(b));
+    a.merge(b);
+    for (int i = 0; i < 5000; ++i)
+        ASSERT_TRUE(a.possibly_contains(i));
+    ASSERT_EQ(a.count(), 6000);
+    // The union holds 5000 distinct keys
+    ASSERT_NEAR(a.estimated_cardinality(), 5000, 100);
+}
+
+TEST_F(Test_bloom, intersect)
+{
+    bloom_filter<int> a(1 << 16, 5), b(1 << 16, 5);
+    for (int i = 0; i < 3000; ++i)
+        a.add(i);
+    for (int i = 2000; i < 5000; ++i)
+        b.add(i);
+    a.intersect(b);
+    for (int i = 2000; i < 3000; ++i)
+        ASSERT_TRUE(a.possibly_contains(i));
+    auto outside = 0;
+    for (int i = 0; i < 2000; ++i)
+        outside += a.possibly_contains(i) ? 1 : 0;
+    ASSERT_LT(outside, 200);
+    ASSERT_EQ(a.count(), 3000);
+}
+
+TEST_F(Test_bloom, incompatible)
+{
+    bloom_filter<int> a(1024, 3);
+    ASSERT_FALSE(a.compatible(bloom_filter<int>(1025, 3)));
+    ASSERT_FALSE(a.compatible(bloom_filter<int>(1024, 4)));
+    ASSERT_FALSE(a.compatible(bloom_filter<int>(1024, 3, 1)));
+    ASSERT_THROW(a.merge(bloom_filter<int>(1024, 3, 1)), std::invalid_argument);
+    ASSERT_THROW(a.intersect(bloom_filter<int>(2048, 3)), std::invalid_argument);
+}
+
+TEST_F(Test_bloom, build_from)
+{
+    std::vector<int> keys(100000);
+    for (int i = 0; i < 100000; ++i)
+        keys[i] = i * 3;
+    thread_pool pool(4);
+    bloom_filter<int> parallel(1 << 20, 4, 7), serial(1 << 20, 4, 7);
+    build_from(parallel, keys, 4, pool);
+    build_from(serial, keys, 1);
+    ASSERT_EQ(parallel.count(), keys.size());
+    ASSERT_EQ(parallel.fill_ratio(), serial.fill_ratio());
+    for (const auto key : keys)
+        ASSERT_TRUE(parallel.possibly_contains(key));
+    ASSERT_NEAR(parallel.estimated_cardinality(), 100000, 1000);
+
+    bloom_filter<int> empty(64, 2);
+    ASSERT_EQ(empty.estimated_cardinality(), 0.0);
+}
+
+TEST_F(Test_bloom, calculator_math)
+{
+    // 9999 / 1000 * ln 2 = 6.93; integer division would give 6
+    ASSERT_EQ(bloom_calculator::calc_hashes(9999, 1000), 7);
+    ASSERT_EQ(bloom_calculator::calc_hashes(1000, 0), 1);
+    ASSERT_EQ(bloom_calculator::calc_hashes(100000, 1), 255);
+    ASSERT_EQ(bloom_calculator::calc_bits(1000, 0.01), 9586u);
+    ASSERT_EQ(bloom_calculator::calc_probability(1000, 3, 0), 0.0);
+    ASSERT_THROW(bloom_calculator::calc_bits(1000, 0.0), std::invalid_argument);
+    ASSERT_THROW(bloom_calculator::calc_bits(1000, 1.0), std::invalid_argument);
+
+    // calc_items inverts calc_probability
+    const auto n = bloom_calculator::calc_items(9586, 7, 0.01);
+    ASSERT_NEAR(double(n), 1000, 5);
+    ASSERT_LE(bloom_calculator::calc_probability(9586, 7, n), 0.01);
+    ASSERT_EQ(bloom_calculator::calc_items(9586, 0, 0.01), 0u);
+}
+
+TEST_F(Test_bloom, calculator_setters)
+{
+    bloom_calculator c;
+    ASSERT_EQ(c.bits(), 134191u);
+    ASSERT_EQ(c.hashes(), 23);
+
+    c.items(1000000);
+    ASSERT_EQ(c.probability(), 0.0000001);
+    ASSERT_EQ(c.bits(), bloom_calculator::calc_bits(1000000, 0.0000001));
+    ASSERT_EQ(c.hashes(), 23);
+
+    c.probability(0.01);
+    ASSERT_EQ(c.items(), 1000000u);
+    ASSERT_EQ(c.bits(), bloom_calculator::calc_bits(1000000, 0.01));
+    ASSERT_EQ(c.hashes(), 7);
+
+    // Half the bits: fewer hashes and a worse probability for the same items
+    c.bits(c.bits() / 2);
+    ASSERT_EQ(c.items(), 1000000u);
+    ASSERT_EQ(c.hashes(), 3);
+    // (1 - e^(-3 / 4.79))^3
+    ASSERT_NEAR(c.probability(), 0.1007, 0.001);
+}
+
+TEST_F(Test_bloom, make_for_fpp_sweep)
+{
+    const int probes = 200000;
+    for (const uint64_t items : { 1000, 20000 })
+        for (const double fpp : { 0.1, 0.01, 0.001 })
+        {
+            auto filter = bloom_filter<uint64_t>::make_for(items, fpp, items);
+            ASSERT_EQ(filter.size() % 512, 0u);
+            ASSERT_GE(filter.size(), bloom_calculator::calc_bits(items, fpp));
+            for (uint64_t i = 0; i < items; ++i)
+                filter.add(i);
+
+            auto false_positives = 0;
+            for (int i = 0; i < probes; ++i)
+                false_positives += filter.possibly_contains(items + i) ? 1 : 0;
+            const double measured = double(false_positives) / probes;
+            const double predicted = filter.estimated_fpp();
+            ASSERT_LE(predicted, fpp * 1.1) << items << " " << fpp;
+            // Within sampling noise of the prediction: a few standard deviations
+            const double noise = 4 * std::sqrt(predicted * (1 - predicted) / probes);
+            ASSERT_NEAR(measured, predicted, predicted * 0.15 + noise) << items << " " << fpp;
+        }
+}
@@ -1,3 +1,9 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include <ltc/btree.hpp>
@@ -13,6 +19,8 @@ TEST_F(Test_btree, at)
 {
     btree t{20};
     EXPECT_THROW(t.at("test"), std::out_of_range);
+    t.insert(std::make_pair("test", "v"));
+    EXPECT_EQ(t.at("test"), "v");
 }
 
 TEST_F(Test_btree, insert)
@@ -22,5 +30,216 @@ TEST_F(Test_btree, insert)
     {
         t.insert(std::make_pair(std::to_string(i),"v"));
     }
-    EXPECT_THROW(t.insert(std::make_pair("21","v")), std::runtime_error);
+    // A full node splits instead of failing
+    EXPECT_TRUE(t.insert(std::make_pair("21","v")).second);
+    EXPECT_FALSE(t.insert(std::make_pair("21","w")).second);
+    EXPECT_EQ(t.size(), 21u);
+    EXPECT_EQ(t.height(), 2u);
+    EXPECT_TRUE(std::is_sorted(t.begin(), t.end(), t.value_comp()));
+}
+
+TEST_F(Test_btree, iterators)
+{
+    basic_btree<int, int> t(4);
+    for (int i = 99; i >= 0; --i)
+        t[i] = i * i;
+    ASSERT_EQ(t.size(), 100u);
+    ASSERT_GE(t.height(), 3u);
+
+    int expected = 0;
+    for (const auto &v : t)
+    {
+        ASSERT_EQ(v.first, expected);
+        ASSERT_EQ(v.second, expected * expected);
+        ++expected;
+    }
+    ASSERT_EQ(std::distance(t.rbegin(), t.rend()), 100);
+    ASSERT_EQ(t.rbegin()->first, 99);
+    auto it = t.end();
+    --it;
+    ASSERT_EQ(it->first, 99);
+
+    ASSERT_EQ(t.lower_bound(50)->first, 50);
+    ASSERT_EQ(t.upper_bound(50)->first, 51);
+    ASSERT_EQ(t.upper_bound(99), t.end());
+}
+
+TEST_F(Test_btree, erase)
+{
+    basic_btree<int, int> t(5);
+    for (int i = 0; i < 200; ++i)
+        t[i] = i;
+    for (int i = 0; i < 200; i += 2)
+        ASSERT_EQ(t.erase(i), 1u);
+    ASSERT_EQ(t.erase(0), 0u);
+    ASSERT_EQ(t.size(), 100u);
+    ASSERT_FALSE(t.contains(10));
+    ASSERT_TRUE(t.contains(11));
+
+    auto it = t.erase(t.find(11));
+    ASSERT_EQ(it->first, 13);
+
+    while (!t.empty())
+        t.erase(t.begin());
+    ASSERT_EQ(t.height(), 1u);
+    ASSERT_EQ(t.begin(), t.end());
+}
+
+TEST_F(Test_btree, random_against_map)
+{
+    for (size_t order : { 3, 4, 7, 32 })
+    {
+        basic_btree<int, int> t(order);
+        std::map<int, int> m;
+        std::mt19937 rng(static_cast<unsigned>(order));
+        for (int i = 0; i < 5000; ++i)
+        {
+            const int key = rng() % 500;
+            if (rng() % 3 == 0)
+                ASSERT_EQ(t.erase(key), m.erase(key));
+            else
+                ASSERT_EQ(t.insert(std::make_pair(key, i)).second,
+                          m.insert(std::make_pair(key, i)).second);
+        }
+        ASSERT_EQ(t.size(), m.size());
+        const auto same = [](const std::pair<int, int> &a, const std::pair<const int, int> &b) {
+            return a.first == b.first && a.second == b.second;
+        };
+        ASSERT_TRUE(std::equal(t.begin(), t.end(), m.begin(), m.end(), same));
+    }
+}
+
+TEST_F(Test_btree, copy_move)
+{
+    basic_btree<int, std::string> a(4);
+    for (int i = 0; i < 50; ++i)
+        a[i] = std::to_string(i);
+    auto b = a;
+    a.erase(7);
+    ASSERT_TRUE(b.contains(7));
+    ASSERT_EQ(b.size(), 50u);
+
+    auto c = std::move(b);
+    ASSERT_EQ(c.size(), 50u);
+    ASSERT_EQ(c.at(42), "42");
+    ASSERT_TRUE(b.empty());
+}
+
+TEST_F(Test_btree, range)
+{
+    basic_btree<int, int> t(4);
+    for (int i = 0; i < 100; i += 10)
+        t[i] = i;
+
+    std::vector<int> keys;
+    for (const auto &v : t.range(20, 50))
+        keys.push_back(v.first);
+    ASSERT_EQ(keys, (std::vector<int>{ 20, 30, 40 }));
+
+    keys.clear();
+    for (const auto &v : t.range(20, 50, bounds::left_open))
+        keys.push_back(v.first);
+    ASSERT_EQ(keys, (std::vector<int>{ 30, 40, 50 }));
+
+    auto r = t.range(21, 29, bounds::closed);
+    ASSERT_TRUE(r.empty());
+    r = t.range(50, 20, bounds::closed);
+    ASSERT_TRUE(r.empty());
+    r = t.range(50, 50, bounds::open);
+    ASSERT_TRUE(r.empty());
+}
+
+TEST_F(Test_btree, cursor)
+{
+    basic_btree<int, int> t(4);
+    for (int i = 0; i < 100; ++i)
+        t[i] = i;
+
+    auto c = t.seek(10, 20, bounds::closed);
+    std::vector<int> keys;
+    for (int i = 0; i < 3; ++i, ++c)
+        keys.push_back(c->first);
+
+    // The cursor resumes where it was after the tree changes under it
+    for (int i = 0; i < 100; i += 2)
+        t.erase(i);
+    for (int i = 100; i < 200; ++i)
+        t[i] = i;
+    for (; c; ++c)
+        keys.push_back(c->first);
+    ASSERT_EQ(keys, (std::vector<int>{ 10, 11, 12, 13, 15, 17, 19 }));
+
+    auto all = t.seek(195);
+    int count = 0;
+    for (; !all.done(); ++all)
+        ++count;
+    ASSERT_EQ(count, 5);
+}
+
+TEST_F(Test_btree, counted)
+{
+    for (size_t order : { 3, 4, 9 })
+    {
+        counted_btree<int, int> t(order);
+        std::map<int, int> m;
+        std::mt19937 rng(static_cast<unsigned>(order) + 1);
+        for (int i = 0; i < 3000; ++i)
+        {
+            const int key = rng() % 400;
+            if (rng() % 3 == 0)
+            {
+                t.erase(key);
+                m.erase(key);
+            }
+            else
+            {
+                t[key] = i;
+                m[key] = i;
+            }
+        }
+
+        std::vector<int> keys;
+        for (const auto &v : m)
+            keys.push_back(v.first);
+        ASSERT_EQ(t.size(), keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            ASSERT_EQ(t.nth_key(i), keys[i]);
+            ASSERT_EQ(t.select(i)->first, keys[i]);
+        }
+        ASSERT_EQ(t.select(keys.size()), t.end());
+        ASSERT_THROW(t.nth_key(keys.size()), std::out_of_range);
+
+        for (int key = -1; key <= 401; ++key)
+        {
+            const auto expected = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+            ASSERT_EQ(t.rank(key), static_cast<size_t>(expected));
+        }
+        ASSERT_EQ(t.count_range(100, 200), static_cast<size_t>(std::distance(
+                                               m.lower_bound(100), m.lower_bound(200))));
+        ASSERT_EQ(t.count_range(100, 200, bounds::closed),
+                  static_cast<size_t>(std::distance(m.lower_bound(100), m.upper_bound(200))));
+        ASSERT_EQ(t.count_range(200, 100), 0u);
+    }
+}
+
+TEST_F(Test_btree, stats)
+{
+    basic_btree<int, int, std::less<int>, false, counting_stats> t(4);
+    for (int i = 0; i < 100; ++i)
+        t.insert(std::make_pair(i, i));
+
+    auto s = t.snapshot();
+    ASSERT_EQ(s.inserts, 100);
+    ASSERT_EQ(s.searches, 100);
+    ASSERT_GT(s.reallocations, 100 / 4);
+    ASSERT_GT(s.comparisons_per_search(), 0.0);
+
+    ASSERT_EQ(t.count(50), 1);
+    ASSERT_EQ(t.count(500), 0);
+    t.erase(50);
+    s = t.snapshot();
+    ASSERT_EQ(s.finds, 2);
+    ASSERT_EQ(s.misses, 1);
+    ASSERT_EQ(s.erases, 1);
 }
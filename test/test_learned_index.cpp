@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/learned_index.hpp>
+#include <ltc/vmap.hpp>
+#include <ltc/vset.hpp>
+
+using namespace ltc;
+
+class Test_learned_index : public ::testing::Test
+{
+protected:
+    static vset<uint64_t> keys(int distribution, size_t n)
+    {
+        std::mt19937_64 rng(n + distribution);
+        std::uniform_int_distribution<uint64_t> uniform(0, uint64_t(1) << 40);
+        std::lognormal_distribution<double> lognormal(0, 2);
+        std::vector<uint64_t> v;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (distribution == 0)
+                v.push_back(uniform(rng));
+            else if (distribution == 1)
+                v.push_back(uint64_t(lognormal(rng) * 1e6));
+            else // a few dense clusters far apart
+                v.push_back((rng() % 8) * (uint64_t(1) << 50) + rng() % (n * 4));
+        }
+        return vset<uint64_t>(v.begin(), v.end());
+    }
+};
+
+TEST_F(Test_learned_index, matches_lower_bound)
+{
+    for (int distribution = 0; distribution < 3; ++distribution)
+    {
+        const auto s = keys(distribution, 20000);
+        const learned_index<uint64_t> index(s, 16);
+        ASSERT_EQ(index.size(), s.size());
+        ASSERT_GT(index.segment_count(), 0u);
+        ASSERT_LE(index.average_window(), 2 * 16 + 3);
+        ASSERT_EQ(index.model_bytes(), index.segment_count() * 24);
+
+        std::mt19937_64 rng(distribution);
+        for (const auto key : s)
+        {
+            ASSERT_EQ(index.find(s, key), s.find(key));
+            ASSERT_EQ(index.lower_bound(s, key + 1), s.lower_bound(key + 1));
+            const auto w = index.window(key);
+            ASSERT_LE(w.second - w.first, 2 * 16 + 3);
+        }
+        for (int i = 0; i < 10000; ++i)
+        {
+            const uint64_t key = rng() >> (rng() % 64);
+            ASSERT_EQ(index.lower_bound(s, key), s.lower_bound(key));
+        }
+        ASSERT_EQ(index.lower_bound(s, 0), s.begin());
+        ASSERT_EQ(index.lower_bound(s, uint64_t(-1)), s.lower_bound(uint64_t(-1)));
+    }
+}
+
+TEST_F(Test_learned_index, maps_and_signed_keys)
+{
+    vmap<int64_t, int> m;
+    for (int64_t i = -5000; i < 5000; ++i)
+        m[i * i * (i < 0 ? -1 : 1)] = int(i);
+    const learned_index<int64_t> index(m, 4);
+    for (int64_t key = -30000000; key < 30000000; key += 9973)
+        ASSERT_EQ(index.lower_bound(m, key), m.lower_bound(key));
+    ASSERT_EQ(index.find(m, 49)->second, 7);
+    ASSERT_EQ(index.find(m, 50), m.end());
+    ASSERT_EQ(index.find(m, std::numeric_limits<int64_t>::min()), m.end());
+}
+
+TEST_F(Test_learned_index, fallback)
+{
+    auto s = keys(0, 1000);
+    const learned_index<uint64_t> index(s);
+
+    // A container that no longer matches the model is searched in full
+    s.erase(s.begin(), s.begin() + 500);
+    for (int i = 0; i < 1000; ++i)
+    {
+        const uint64_t key = uint64_t(i) << 30;
+        ASSERT_EQ(index.lower_bound(s, key), s.lower_bound(key));
+    }
+
+    const vset<uint64_t> empty;
+    const learned_index<uint64_t> none(empty);
+    ASSERT_EQ(none.segment_count(), 0u);
+    ASSERT_EQ(none.find(empty, 1), empty.end());
+}
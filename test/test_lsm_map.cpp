@@ -0,0 +1,93 @@
+#include <map>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <ltc/lsm_map.hpp>
+
+using namespace ltc;
+
+class Test_lsm_map : public ::testing::Test
+{
+};
+
+TEST_F(Test_lsm_map, insert_find)
+{
+    lsm_map<std::string, int> m(4);
+    m.insert_or_assign("one", 1);
+    m.insert_or_assign("two", 2);
+    ASSERT_EQ(m.at("one"), 1);
+    ASSERT_EQ(m.at("two"), 2);
+    ASSERT_FALSE(m.contains("three"));
+    ASSERT_THROW(m.at("three"), std::out_of_range);
+
+    m.insert_or_assign("one", 11);
+    ASSERT_EQ(m.at("one"), 11);
+}
+
+TEST_F(Test_lsm_map, flush_and_compact)
+{
+    lsm_map<int, int> m(8, 2);
+    for (int i = 0; i < 1000; ++i)
+        m.insert_or_assign(i, i);
+    ASSERT_LT(m.memtable_size(), 8);
+    ASSERT_GT(m.run_count(), 0);
+    ASSERT_LT(m.run_count(), 20);
+
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_EQ(m.at(i), i);
+
+    m.compact();
+    ASSERT_EQ(m.run_count(), 1);
+    ASSERT_EQ(m.memtable_size(), 0);
+    ASSERT_EQ(m.record_count(), 1000);
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_EQ(m.at(i), i);
+}
+
+TEST_F(Test_lsm_map, erase)
+{
+    lsm_map<int, int> m(16);
+    for (int i = 0; i < 100; ++i)
+        m.insert_or_assign(i, i);
+    for (int i = 0; i < 100; i += 2)
+        m.erase(i);
+    for (int i = 0; i < 100; ++i)
+        ASSERT_EQ(m.contains(i), i % 2 == 1);
+
+    m.compact();
+    ASSERT_EQ(m.record_count(), 50);
+    for (int i = 0; i < 100; ++i)
+        ASSERT_EQ(m.contains(i), i % 2 == 1);
+}
+
+TEST_F(Test_lsm_map, ordered_for_each)
+{
+    lsm_map<int, int> m(32);
+    std::map<int, int> reference;
+    std::mt19937 rng(7);
+    for (int i = 0; i < 5000; ++i)
+    {
+        const int key = rng() % 1000;
+        if (rng() % 4 == 0)
+        {
+            m.erase(key);
+            reference.erase(key);
+        }
+        else
+        {
+            m.insert_or_assign(key, i);
+            reference[key] = i;
+        }
+    }
+
+    auto it = reference.begin();
+    m.for_each([&](int key, int value) {
+        ASSERT_NE(it, reference.end());
+        ASSERT_EQ(key, it->first);
+        ASSERT_EQ(value, it->second);
+        ++it;
+    });
+    ASSERT_EQ(it, reference.end());
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/amap.hpp>
+#include <ltc/merge_view.hpp>
+#include <ltc/vmap.hpp>
+#include <ltc/vset.hpp>
+
+using namespace ltc;
+
+class Test_merge_view : public ::testing::Test
+{
+};
+
+TEST_F(Test_merge_view, keep_all)
+{
+    std::vector<vset<int>> sets{ { 1, 4, 7 }, {}, { 2, 4, 8, 9 }, { 0 }, { 3, 5, 6 } };
+    std::vector<int> merged;
+    for (const auto &v : merge_containers(sets))
+        merged.push_back(v);
+    ASSERT_EQ(merged, (std::vector<int>{ 0, 1, 2, 3, 4, 4, 5, 6, 7, 8, 9 }));
+
+    std::vector<vset<int>> none;
+    ASSERT_EQ(merge_containers(none).begin(), merge_containers(none).end());
+}
+
+TEST_F(Test_merge_view, duplicates)
+{
+    using map_type = vmap<int, std::string>;
+    std::vector<map_type> maps{ { { 1, "a1" }, { 2, "a2" } },
+                                { { 2, "b2" }, { 3, "b3" } },
+                                { { 1, "c1" }, { 2, "c2" } } };
+    const auto to_vector = [](const auto &view) {
+        return std::vector<std::pair<int, std::string>>(view.begin(), view.end());
+    };
+    using result = std::vector<std::pair<int, std::string>>;
+
+    ASSERT_EQ(to_vector(merge_containers(maps, keep_first())),
+              (result{ { 1, "a1" }, { 2, "a2" }, { 3, "b3" } }));
+    ASSERT_EQ(to_vector(merge_containers(maps, keep_last())),
+              (result{ { 1, "c1" }, { 2, "c2" }, { 3, "b3" } }));
+    const auto concat = [](const std::string &a, const std::string &b) { return a + b; };
+    ASSERT_EQ(to_vector(merge_containers(maps, combine(concat))),
+              (result{ { 1, "a1c1" }, { 2, "a2b2c2" }, { 3, "b3" } }));
+}
+
+TEST_F(Test_merge_view, runs)
+{
+    const std::vector<int> a{ 5, 3, 1 };
+    const std::vector<int> b{ 6, 4, 2 };
+    using It = std::vector<int>::const_iterator;
+    const auto view = merge_runs(std::vector<std::pair<It, It>>{ { a.begin(), a.end() },
+                                                                 { b.begin(), b.end() } },
+                                 keep_all(), std::greater<int>());
+    ASSERT_EQ(view.input_size(), 6u);
+    ASSERT_EQ(std::vector<int>(view.begin(), view.end()), (std::vector<int>{ 6, 5, 4, 3, 2, 1 }));
+
+    // Iterators are forward: a copy continues independently
+    auto it = view.begin();
+    ++it;
+    auto copy = it;
+    ++it;
+    ASSERT_EQ(*copy, 5);
+    ASSERT_EQ(*it, 4);
+}
+
+TEST_F(Test_merge_view, random_against_map)
+{
+    std::mt19937 rng(42);
+    std::vector<vmap<int, int>> maps(7);
+    std::map<int, int> sums;
+    for (int i = 0; i < 7; ++i)
+        for (int j = 0; j < 500; ++j)
+        {
+            const int key = rng() % 2000;
+            if (maps[i].insert(std::make_pair(key, i + 1)).second) sums[key] += i + 1;
+        }
+
+    vmap<int, int> merged;
+    merge_into(merge_containers(maps, combine(std::plus<int>())), merged);
+    ASSERT_EQ(merged.size(), sums.size());
+    ASSERT_TRUE(std::equal(merged.begin(), merged.end(), sums.begin(), [](auto a, auto b) {
+        return a.first == b.first && a.second == b.second;
+    }));
+
+    amap<int, int, 8> small;
+    std::vector<amap<int, int, 8>> parts{ { { 1, 1 }, { 3, 3 } }, { { 1, 2 }, { 2, 2 } } };
+    merge_into(merge_containers(parts, keep_last()), small);
+    ASSERT_EQ(small.size(), 3u);
+    ASSERT_EQ(small.at(1), 2);
+}
@@ -0,0 +1,77 @@
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/amap.hpp>
+#include <ltc/padded.hpp>
+#include <ltc/vset.hpp>
+
+using namespace ltc;
+
+class Test_padded : public ::testing::Test
+{
+protected:
+    static bool aligned(const void *p)
+    {
+        return reinterpret_cast<std::uintptr_t>(p) % cache_line_size == 0;
+    }
+};
+
+static_assert(alignof(padded<char>) == cache_line_size, "");
+static_assert(sizeof(padded<char>) == cache_line_size, "");
+static_assert(sizeof(padded<char[100]>) == 2 * cache_line_size, "");
+
+TEST_F(Test_padded, padded)
+{
+    padded<std::string> p(3, 'x');
+    ASSERT_EQ(*p, "xxx");
+    ASSERT_EQ(p->size(), 3u);
+    padded<std::string> copy(p);
+    ASSERT_EQ(copy.value, "xxx");
+
+    std::vector<padded<int>, cache_aligned_allocator<padded<int>>> v(5);
+    for (const auto &e : v)
+        ASSERT_TRUE(aligned(&e));
+}
+
+TEST_F(Test_padded, per_thread)
+{
+    per_thread<amap<int, int, 16>> counters(4);
+    ASSERT_EQ(counters.size(), 4u);
+    for (const auto &c : counters)
+        ASSERT_TRUE(aligned(&c));
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < counters.size(); ++t)
+        threads.emplace_back([&counters, t]() {
+            auto &local = counters[t];
+            for (int i = 0; i < 10000; ++i)
+                ++local[i % 16];
+        });
+    for (auto &t : threads)
+        t.join();
+
+    const auto total = counters.combine([](amap<int, int, 16> &result, const auto &part) {
+        for (const auto &e : part)
+            result[e.first] += e.second;
+    });
+    ASSERT_EQ(total.size(), 16u);
+    ASSERT_EQ(total.at(0), 4 * 625);
+}
+
+TEST_F(Test_padded, combine_sets)
+{
+    per_thread<vset<int>> sets(3);
+    for (int i = 0; i < 30; ++i)
+        sets[i % 3].insert(i / 2);
+    const auto all = sets.combine([](vset<int> &result, const vset<int> &part) {
+        result.insert(part.begin(), part.end());
+    });
+    ASSERT_EQ(all.size(), 15u);
+    ASSERT_EQ(*all.begin(), 0);
+    ASSERT_EQ(per_thread<int>(0).size(), 1u);
+    ASSERT_GE(per_thread<int>().size(), 1u);
+}
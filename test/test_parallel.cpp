@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/parallel.hpp>
+#include <ltc/range.hpp>
+#include <ltc/vmap.hpp>
+#include <ltc/vset.hpp>
+
+using namespace ltc;
+
+class Test_parallel : public ::testing::Test
+{
+};
+
+TEST_F(Test_parallel, parallel_for_range)
+{
+    thread_pool pool(4);
+    std::vector<std::atomic<int>> hits(10000);
+    parallel_for(range<size_t>(0, hits.size()), [&hits](size_t i) { ++hits[i]; }, 64, pool);
+    ASSERT_TRUE(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int> &h) {
+        return h.load() == 1;
+    }));
+
+    // Default grain, and the process wide pool
+    std::atomic<uint64_t> sum{ 0 };
+    parallel_for(range<uint64_t>(0, 1000), [&sum](uint64_t i) { sum += i; });
+    ASSERT_EQ(sum.load(), 499500u);
+
+    parallel_for(range<int>(5, 5), [](int) { FAIL(); });
+}
+
+TEST_F(Test_parallel, parallel_for_containers)
+{
+    thread_pool pool(3);
+    vmap<int, int> m;
+    for (int i = 0; i < 1000; ++i)
+        m[i] = 0;
+    parallel_for(m, [](std::pair<int, int> &p) { p.second = p.first * 2; }, 10, pool);
+    for (const auto &p : m)
+        ASSERT_EQ(p.second, p.first * 2);
+
+    std::vector<int> v(777, 1);
+    parallel_for(v.begin(), v.end(), [](int &i) { i += 1; }, 0, pool);
+    ASSERT_EQ(std::count(v.begin(), v.end(), 2), 777);
+}
+
+TEST_F(Test_parallel, parallel_reduce)
+{
+    thread_pool pool(4);
+    ASSERT_EQ(parallel_reduce(range<uint64_t>(1, 100001), uint64_t(0), std::plus<uint64_t>(), 100,
+                              pool),
+              5000050000u);
+
+    const vset<int> s{ 4, 8, 15, 16, 23, 42 };
+    ASSERT_EQ(parallel_reduce(s, 0), 108);
+    ASSERT_EQ(parallel_reduce(s, 0, [](int a, int b) { return std::max(a, b); }, 1, pool), 42);
+
+    // Non-commutative reduce: pieces are combined in order
+    const auto append = [](std::string a, const std::string &b) { return a + b; };
+    const auto letter = [](int i) { return std::string(1, char('a' + i % 26)); };
+    const auto concat =
+        parallel_transform_reduce(range<int>(0, 200), std::string(), append, letter, 7, pool);
+    std::string expected;
+    for (int i = 0; i < 200; ++i)
+        expected += char('a' + i % 26);
+    ASSERT_EQ(concat, expected);
+
+    ASSERT_EQ(parallel_reduce(range<int>(0, 0), 17), 17);
+}
+
+TEST_F(Test_parallel, parallel_sort)
+{
+    thread_pool pool(4);
+    std::mt19937 rng(7);
+    for (size_t n : { 0, 1, 1000, 5000, 100000 })
+    {
+        std::vector<uint32_t> v(n);
+        for (auto &x : v)
+            x = rng();
+        auto expected = v;
+        std::sort(expected.begin(), expected.end());
+        parallel_sort(v, std::less<uint32_t>(), 0, pool);
+        ASSERT_EQ(v, expected);
+    }
+
+    std::vector<int> v(50000);
+    for (auto &x : v)
+        x = rng() % 1000;
+    auto first = v.begin(), last = v.end();
+    parallel_sort(first, last, std::greater<int>(), 3000, pool);
+    ASSERT_TRUE(std::is_sorted(v.begin(), v.end(), std::greater<int>()));
+}
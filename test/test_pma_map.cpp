@@ -0,0 +1,63 @@
+#include <map>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <ltc/pma_map.hpp>
+
+using namespace ltc;
+
+class Test_pma_map : public ::testing::Test
+{
+};
+
+TEST_F(Test_pma_map, initializer_list_construct)
+{
+    pma_map<std::string, int> m = { { "3", 3 }, { "2", 2 }, { "1", 1 }, { "2", 2 } };
+    ASSERT_EQ(m.size(), 3);
+    ASSERT_EQ(m.at("1"), 1);
+    ASSERT_EQ(m.at("2"), 2);
+    ASSERT_EQ(m.at("3"), 3);
+    ASSERT_EQ(m.begin()->first, "1");
+}
+
+TEST_F(Test_pma_map, insert_find_erase)
+{
+    pma_map<std::string, int> m;
+    ASSERT_TRUE(m.insert(std::make_pair("one", 1)).second);
+    ASSERT_FALSE(m.insert(std::make_pair("one", 1)).second);
+    m["two"] = 2;
+    ASSERT_EQ(m.size(), 2);
+    ASSERT_NE(m.find("two"), m.end());
+    ASSERT_EQ(m.find("three"), m.end());
+    ASSERT_EQ(m.erase("one"), 1);
+    ASSERT_EQ(m.erase("one"), 0);
+    ASSERT_EQ(m.size(), 1);
+}
+
+TEST_F(Test_pma_map, random_against_map)
+{
+    pma_map<int, int> m;
+    std::map<int, int> ref;
+    std::mt19937 rng(5);
+    for (int i = 0; i < 20000; ++i)
+    {
+        const int key = rng() % 5000;
+        if (rng() % 3 == 0)
+        {
+            ASSERT_EQ(m.erase(key), ref.erase(key));
+        }
+        else
+        {
+            m[key] = i;
+            ref[key] = i;
+        }
+    }
+    ASSERT_EQ(m.size(), ref.size());
+    ASSERT_TRUE(std::equal(m.begin(), m.end(), ref.begin(), ref.end(),
+                           [](const std::pair<int, int> &a, const std::pair<const int, int> &b) {
+                               return a.first == b.first && a.second == b.second;
+                           }));
+    ASSERT_EQ(m.lower_bound(2500)->first, ref.lower_bound(2500)->first);
+}
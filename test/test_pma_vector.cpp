@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/pma_vector.hpp>
+
+using namespace ltc;
+
+class Test_pma_vector : public ::testing::Test
+{
+protected:
+    template <typename T> void expect_equal(const pma_vector<T> &v, const std::vector<T> &ref)
+    {
+        ASSERT_EQ(v.size(), ref.size());
+        ASSERT_TRUE(std::equal(v.begin(), v.end(), ref.begin(), ref.end()));
+        for (size_t i = 0; i < ref.size(); ++i)
+            ASSERT_EQ(v[i], ref[i]);
+    }
+};
+
+TEST_F(Test_pma_vector, constructor)
+{
+    pma_vector<int> v;
+    ASSERT_TRUE(v.empty());
+    ASSERT_EQ(v.size(), 0);
+    ASSERT_EQ(v.begin(), v.end());
+}
+
+TEST_F(Test_pma_vector, constructor_initializer_list)
+{
+    pma_vector<int> v = { 1, 2, 3 };
+    expect_equal(v, { 1, 2, 3 });
+    ASSERT_GE(v.capacity(), 2 * v.size());
+}
+
+TEST_F(Test_pma_vector, iterators)
+{
+    pma_vector<int> v = { 1, 2, 3, 4, 5 };
+    ASSERT_EQ(*v.begin(), 1);
+    ASSERT_EQ(*v.rbegin(), 5);
+    ASSERT_EQ(*(v.begin() + 3), 4);
+    ASSERT_EQ(*(v.end() - 2), 4);
+    ASSERT_EQ(v.end() - v.begin(), 5);
+    ASSERT_EQ(std::accumulate(v.rbegin(), v.rend(), 0), 15);
+    ASSERT_TRUE(v.begin() < v.end());
+}
+
+TEST_F(Test_pma_vector, insert_erase)
+{
+    pma_vector<int> v;
+    std::vector<int> ref;
+    std::mt19937 rng(1);
+    for (int i = 0; i < 5000; ++i)
+    {
+        const auto pos = ref.empty() ? 0 : rng() % (ref.size() + 1);
+        const auto it = v.insert(v.begin() + pos, i);
+        ASSERT_EQ(*it, i);
+        ref.insert(ref.begin() + pos, i);
+    }
+    expect_equal(v, ref);
+
+    for (int i = 0; i < 4000; ++i)
+    {
+        const auto pos = rng() % ref.size();
+        const auto it = v.erase(v.begin() + pos);
+        ref.erase(ref.begin() + pos);
+        ASSERT_EQ(it - v.begin(), pos);
+    }
+    expect_equal(v, ref);
+}
+
+TEST_F(Test_pma_vector, erase_range)
+{
+    std::vector<std::string> ref;
+    for (int i = 0; i < 200; ++i)
+        ref.push_back(std::to_string(i));
+    pma_vector<std::string> v(ref.begin(), ref.end());
+
+    v.erase(v.begin() + 10, v.begin() + 13);
+    ref.erase(ref.begin() + 10, ref.begin() + 13);
+    expect_equal(v, ref);
+
+    v.erase(v.begin() + 20, v.begin() + 150);
+    ref.erase(ref.begin() + 20, ref.begin() + 150);
+    expect_equal(v, ref);
+}
+
+TEST_F(Test_pma_vector, sort)
+{
+    std::vector<int> ref(1000);
+    std::iota(ref.begin(), ref.end(), 0);
+    std::shuffle(ref.begin(), ref.end(), std::mt19937(3));
+    pma_vector<int> v(ref.begin(), ref.end());
+    std::sort(v.begin(), v.end());
+    std::sort(ref.begin(), ref.end());
+    expect_equal(v, ref);
+}
+
+TEST_F(Test_pma_vector, copy_move_swap)
+{
+    pma_vector<int> v = { 1, 2, 3 };
+    pma_vector<int> c(v);
+    expect_equal(c, { 1, 2, 3 });
+    pma_vector<int> m(std::move(v));
+    expect_equal(m, { 1, 2, 3 });
+    ASSERT_TRUE(v.empty());
+    pma_vector<int> s = { 4 };
+    s.swap(m);
+    expect_equal(s, { 1, 2, 3 });
+    expect_equal(m, { 4 });
+    m.clear();
+    ASSERT_TRUE(m.empty());
+}
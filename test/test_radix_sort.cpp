@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/radix_sort.hpp>
+
+using namespace ltc;
+
+class Test_radix_sort : public ::testing::Test
+{
+protected:
+    struct first_of
+    {
+        template <class P> const auto &operator()(const P &p) const { return p.first; }
+    };
+
+    // Sorts pairs of (key, input position) and checks the order against std::stable_sort
+    template <class Key, class Compare = std::less<Key>>
+    static void check(const std::vector<Key> &keys, Compare comp = Compare())
+    {
+        std::vector<std::pair<Key, size_t>> v;
+        for (size_t i = 0; i < keys.size(); ++i)
+            v.emplace_back(keys[i], i);
+        auto expected = v;
+        std::stable_sort(expected.begin(), expected.end(),
+                         [&](const auto &a, const auto &b) { return comp(a.first, b.first); });
+        sort_by_key(v.begin(), v.end(), first_of(), comp);
+        ASSERT_EQ(v, expected);
+    }
+};
+
+static_assert(radix_key_traits<int, std::less<int>>::enabled, "");
+static_assert(radix_key_traits<uint64_t, std::less<>>::enabled, "");
+static_assert(radix_key_traits<std::string, std::less<std::string>>::enabled, "");
+static_assert(!radix_key_traits<int, std::greater<int>>::enabled, "");
+static_assert(!radix_key_traits<double, std::less<double>>::enabled, "");
+static_assert(!radix_key_traits<bool, std::less<bool>>::enabled, "");
+
+TEST_F(Test_radix_sort, integers)
+{
+    std::mt19937_64 rng(7);
+    for (const size_t n : { 0, 1, 63, 64, 1000, 50000 })
+    {
+        std::vector<uint64_t> u(n);
+        std::vector<int32_t> s(n);
+        std::vector<int8_t> small(n);
+        std::vector<uint32_t> narrow(n); // only the low bytes differ
+        for (size_t i = 0; i < n; ++i)
+        {
+            u[i] = rng();
+            s[i] = static_cast<int32_t>(rng() % 2001) - 1000;
+            small[i] = static_cast<int8_t>(rng());
+            narrow[i] = 0x12340000 + rng() % 300;
+        }
+        check(u);
+        check(s);
+        check(small);
+        check(narrow);
+        check(s, std::greater<int32_t>());
+    }
+    check(std::vector<int64_t>{ INT64_MIN, -1, 0, INT64_MAX, INT64_MIN, 1 });
+}
+
+TEST_F(Test_radix_sort, strings)
+{
+    std::mt19937 rng(11);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::string s(rng() % 12, 'a');
+        for (auto &c : s)
+            c = static_cast<char>(rng() % 4 == 0 ? 0xe0 + rng() % 4 : 'a' + rng() % 3);
+        keys.push_back(i % 3 == 0 ? "common/prefix/" + s : s);
+    }
+    keys.push_back("");
+    keys.push_back("");
+    check(keys);
+    check(std::vector<std::string>(1000, "same"));
+    check(keys, std::greater<std::string>());
+}
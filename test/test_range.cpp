@@ -1,13 +1,18 @@
 #include <algorithm>
 #include <iostream>
+#include <list>
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include <ltc/ltc.hpp>
 #include <ltc/range.hpp>
+#include <ltc/vmap.hpp>
+#include <ltc/vset.hpp>
 
 using namespace ltc;
 
@@ -46,3 +51,192 @@ TEST_F(Test_range, transform_range_reverse)
                                                  [](int i) { return std::to_string(i); });
     ASSERT_EQ(std::accumulate(str_range.begin(), str_range.end(), std::string()), "987654321");
 }
+
+TEST_F(Test_range, range_random_access)
+{
+    range<size_t> r(10, 20);
+    ASSERT_EQ(r.size(), 10u);
+    ASSERT_EQ(std::distance(r.begin(), r.end()), 10);
+    ASSERT_EQ(r[3], 13u);
+    auto it = r.begin();
+    it += 5;
+    ASSERT_EQ(*it, 15u);
+    ASSERT_EQ(it[2], 17u);
+    ASSERT_EQ(it - r.begin(), 5);
+    ASSERT_TRUE(r.begin() < it);
+    ASSERT_EQ(*(it - 1), 14u);
+    ASSERT_TRUE(std::binary_search(r.begin(), r.end(), 18u));
+    ASSERT_TRUE(range<int>(4, 4).empty());
+}
+
+TEST_F(Test_range, reverse_range_random_access)
+{
+    reverse_range<int> r(0, 9);
+    ASSERT_EQ(r.size(), 9u);
+    ASSERT_EQ(r[0], 9);
+    ASSERT_EQ(r[8], 1);
+    auto it = r.begin() + 4;
+    ASSERT_EQ(*it, 5);
+    ASSERT_EQ(it - r.begin(), 4);
+    ASSERT_EQ(r.end() - it, 5);
+    ASSERT_TRUE(it < r.end());
+    ASSERT_EQ(*--it, 6);
+}
+
+TEST_F(Test_range, chunked)
+{
+    range<size_t> r(0, 10);
+    auto chunks = chunked(r, 4);
+    ASSERT_EQ(chunks.size(), 3u);
+    std::vector<size_t> sizes;
+    size_t sum = 0;
+    for (const auto &c : chunks)
+    {
+        sizes.push_back(c.size());
+        sum += std::accumulate(c.begin(), c.end(), size_t(0));
+    }
+    ASSERT_EQ(sizes, (std::vector<size_t>{ 4, 4, 2 }));
+    ASSERT_EQ(sum, 45u);
+    ASSERT_EQ(*chunks[2].begin(), 8u);
+    ASSERT_EQ(chunks.end() - chunks.begin(), 3);
+    ASSERT_TRUE(chunked(range<int>(0, 0), 8).empty());
+    ASSERT_THROW(chunked(r, 0), std::invalid_argument);
+
+    std::vector<int> v{ 1, 2, 3, 4, 5 };
+    auto vchunks = chunked(v.begin(), v.end(), 2);
+    ASSERT_EQ(vchunks.size(), 3u);
+    ASSERT_EQ(vchunks[1].size(), 2u);
+    ASSERT_EQ(*vchunks[1].begin(), 3);
+
+    // Iterators stay usable after the temporary chunked_range they came from is gone
+    const auto it = chunked(v.begin(), v.end(), 2).begin();
+    ASSERT_EQ(*(*it).begin(), 1);
+    ASSERT_EQ(it[2].size(), 1u);
+    ASSERT_EQ(*it[2].begin(), 5);
+}
+
+TEST_F(Test_range, pipeline_filter_transform)
+{
+    std::vector<int> v{ 1, 2, 3, 4, 5, 6, 7, 8 };
+    auto squares = v | filter([](int i) { return i % 2 == 0; }) |
+                   transform([](int i) { return i * i; });
+    ASSERT_EQ(std::vector<int>(squares.begin(), squares.end()),
+              (std::vector<int>{ 4, 16, 36, 64 }));
+
+    // filter is bidirectional
+    auto evens = v | filter([](int i) { return i % 2 == 0; });
+    auto last = evens.end();
+    ASSERT_EQ(*--last, 8);
+    ASSERT_EQ(*--last, 6);
+
+    // Elements are references into the base
+    for (auto &i : v | filter([](int i) { return i > 6; }))
+        i = 0;
+    ASSERT_EQ(v, (std::vector<int>{ 1, 2, 3, 4, 5, 6, 0, 0 }));
+}
+
+TEST_F(Test_range, pipeline_keeps_category)
+{
+    std::vector<int> v{ 1, 2, 3 };
+    auto t = v | transform([](int i) { return i + 1; });
+    using t_category = std::iterator_traits<decltype(t.begin())>::iterator_category;
+    static_assert(std::is_same<t_category, std::random_access_iterator_tag>::value, "");
+    ASSERT_EQ(t.end() - t.begin(), 3);
+    ASSERT_EQ(t.begin()[2], 4);
+
+    auto f = v | filter([](int) { return true; });
+    using f_category = std::iterator_traits<decltype(f.begin())>::iterator_category;
+    static_assert(std::is_same<f_category, std::bidirectional_iterator_tag>::value, "");
+
+    // Stateless functors take no space
+    auto fn = [](int i) { return i; };
+    static_assert(sizeof(transform_view<ref_view<std::vector<int>>, decltype(fn)>) ==
+                      sizeof(ref_view<std::vector<int>>),
+                  "");
+}
+
+TEST_F(Test_range, pipeline_take_stride)
+{
+    range<int> r(0, 10);
+    auto first = r | take(3);
+    ASSERT_EQ(std::vector<int>(first.begin(), first.end()), (std::vector<int>{ 0, 1, 2 }));
+    auto all = r | take(100);
+    ASSERT_EQ(std::distance(all.begin(), all.end()), 10);
+
+    auto s = r | stride(3);
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()), (std::vector<int>{ 0, 3, 6, 9 }));
+    ASSERT_EQ(s.end() - s.begin(), 4);
+    ASSERT_EQ(*(s.end() - 1), 9);
+
+    std::list<int> l{ 0, 1, 2, 3, 4, 5, 6 };
+    auto ls = l | stride(2) | take(3);
+    ASSERT_EQ(std::vector<int>(ls.begin(), ls.end()), (std::vector<int>{ 0, 2, 4 }));
+    auto lt = l | take(10);
+    ASSERT_EQ(std::distance(lt.begin(), lt.end()), 7);
+}
+
+TEST_F(Test_range, pipeline_enumerate_zip)
+{
+    std::vector<std::string> names{ "a", "b", "c" };
+    std::stringstream ss;
+    for (auto e : names | enumerate)
+        ss << e.first << e.second;
+    ASSERT_EQ(ss.str(), "0a1b2c");
+
+    auto e = names | enumerate;
+    ASSERT_EQ((e.end() - 1)->first, 2u);
+
+    std::vector<int> numbers{ 1, 2, 3, 4 };
+    ss.str("");
+    for (auto p : zip(names, numbers))
+        ss << p.first << p.second;
+    ASSERT_EQ(ss.str(), "a1b2c3");
+    auto z = zip(names, numbers);
+    ASSERT_EQ(z.end() - z.begin(), 3);
+
+    for (auto p : zip(numbers, range<int>(10, 20)))
+        p.first = p.second;
+    ASSERT_EQ(numbers, (std::vector<int>{ 10, 11, 12, 13 }));
+}
+
+TEST_F(Test_range, pipeline_chunk)
+{
+    range<int> r(0, 7);
+    std::vector<size_t> sizes;
+    for (auto c : r | chunk(3))
+        sizes.push_back(c.size());
+    ASSERT_EQ(sizes, (std::vector<size_t>{ 3, 3, 1 }));
+
+    auto chunks = r | chunk(3);
+    ASSERT_EQ(chunks.end() - chunks.begin(), 3);
+    ASSERT_EQ(*chunks.begin()[1].begin(), 3);
+    ASSERT_TRUE((std::is_same<decltype(chunks.begin()),
+                              chunked_range<range<int>::iterator>::iterator>::value));
+
+    std::list<int> l{ 1, 2, 3, 4, 5 };
+    std::vector<int> sums;
+    for (auto c : l | chunk(2))
+        sums.push_back(std::accumulate(c.begin(), c.end(), 0));
+    ASSERT_EQ(sums, (std::vector<int>{ 3, 7, 5 }));
+    ASSERT_THROW(r | chunk(0), std::invalid_argument);
+}
+
+TEST_F(Test_range, pipeline_vmap)
+{
+    vmap<int, std::string> m{ { 3, "c" }, { 1, "a" }, { 2, "b" }, { 4, "d" } };
+    auto keys = m | filter([](const std::pair<int, std::string> &p) { return p.first > 1; }) |
+                transform([](const std::pair<int, std::string> &p) { return p.second; }) | take(2);
+    ASSERT_EQ(std::accumulate(keys.begin(), keys.end(), std::string()), "bc");
+
+    const vset<int> s{ 5, 1, 3 };
+    auto doubled = s | transform([](int i) { return i * 2; });
+    ASSERT_EQ(std::vector<int>(doubled.begin(), doubled.end()), (std::vector<int>{ 2, 6, 10 }));
+}
+
+TEST_F(Test_range, make_transform_reverse_range)
+{
+    const reverse_range<int> int_range(0, 3);
+    auto str_range =
+        make_transform<std::string>(int_range, [](int i) { return std::to_string(i); });
+    ASSERT_EQ(std::accumulate(str_range.begin(), str_range.end(), std::string()), "321");
+}
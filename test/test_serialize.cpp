@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <ltc/amap.hpp>
+#include <ltc/mapped_vmap.hpp>
+#include <ltc/serialize.hpp>
+#include <ltc/vmap.hpp>
+#include <ltc/vset.hpp>
+
+using namespace ltc;
+
+class Test_serialize : public ::testing::Test
+{
+protected:
+    void TearDown() override { std::remove(m_path.c_str()); }
+
+    const std::string m_path = "test_serialize.ltcb";
+};
+
+TEST_F(Test_serialize, round_trip)
+{
+    vmap<int, double> m;
+    for (int i = 0; i < 1000; ++i)
+        m[i * 3] = i * 0.5;
+    std::stringstream ss;
+    write_binary(ss, m);
+    const auto rm = read_binary<decltype(m)>(ss);
+    ASSERT_TRUE(std::equal(rm.begin(), rm.end(), m.begin(), m.end()));
+
+    amap<int, int, 8> a{ { 3, 30 }, { 1, 10 }, { 2, 20 } };
+    std::stringstream sa;
+    write_binary(sa, a, 0);
+    const auto ra = read_binary<decltype(a)>(sa);
+    ASSERT_TRUE(std::equal(ra.begin(), ra.end(), a.begin(), a.end()));
+
+    vset<long> s{ 5, -1, 7 };
+    std::stringstream ssv;
+    write_binary(ssv, s);
+    const auto rs = read_binary<decltype(s)>(ssv);
+    ASSERT_TRUE(std::equal(rs.begin(), rs.end(), s.begin(), s.end()));
+
+    std::stringstream empty;
+    write_binary(empty, vmap<int, int>());
+    ASSERT_TRUE((read_binary<vmap<int, int>>(empty).empty()));
+}
+
+TEST_F(Test_serialize, rejects_mismatch)
+{
+    vmap<int, int> m{ { 1, 2 } };
+    std::stringstream ss;
+    write_binary(ss, m);
+    ASSERT_THROW((read_binary<vmap<int, double>>(ss)), std::runtime_error);
+
+    std::stringstream sv;
+    write_binary(sv, m);
+    ASSERT_THROW(read_binary<vset<int>>(sv), std::runtime_error);
+
+    std::stringstream junk("not a binary file at all, just some text that is long enough");
+    ASSERT_THROW((read_binary<vmap<int, int>>(junk)), std::runtime_error);
+}
+
+TEST_F(Test_serialize, rejects_corrupt_count)
+{
+    const auto header_only = [](const binary_header &h) {
+        return std::string(reinterpret_cast<const char *>(&h), sizeof(h));
+    };
+
+    // A consistent header claiming far more elements than the stream holds fails on the
+    // read instead of allocating for them
+    auto h = detail::make_header(uint64_t(1) << 40, sizeof(int), sizeof(int), true, 0);
+    std::stringstream huge(header_only(h));
+    ASSERT_THROW((read_binary<vmap<int, int>>(huge)), std::runtime_error);
+
+    // A count whose sections overflow 64 bits
+    h.count = uint64_t(1) << 62;
+    std::stringstream overflow(header_only(h));
+    ASSERT_THROW((read_binary<vmap<int, int>>(overflow)), std::runtime_error);
+    ASSERT_THROW(detail::make_header(uint64_t(-1), 8, 8, true, 64), std::runtime_error);
+}
+
+TEST_F(Test_serialize, mapped_vmap)
+{
+    vmap<int, double> m;
+    for (int i = 0; i < 1000; ++i)
+        m[i * 2] = i;
+    save_binary(m_path, m, 16);
+
+    mapped_vmap<int, double> mm(m_path);
+    ASSERT_EQ(mm.size(), m.size());
+    ASSERT_TRUE(std::equal(mm.begin(), mm.end(), m.begin(), [](auto a, const auto &b) {
+        return a.first == b.first && a.second == b.second;
+    }));
+    for (int k = -3; k < 2003; ++k)
+    {
+        ASSERT_EQ(mm.lower_bound(k) - mm.begin(), m.lower_bound(k) - m.begin());
+        ASSERT_EQ(mm.upper_bound(k) - mm.begin(), m.upper_bound(k) - m.begin());
+        ASSERT_EQ(mm.contains(k), m.contains(k));
+    }
+    ASSERT_EQ(mm.find(10)->second, 5);
+    ASSERT_EQ(mm.find(11), mm.end());
+    ASSERT_EQ(mm.at(1998), 999);
+    ASSERT_THROW(mm.at(1), std::out_of_range);
+    ASSERT_EQ(mm.keys()[3], 6);
+    ASSERT_EQ(mm.values()[3], 3);
+
+    ASSERT_THROW((mapped_vmap<int, int>(m_path)), std::runtime_error);
+    ASSERT_THROW((mapped_vset<int>(m_path)), std::runtime_error);
+
+    // Iterators point into the mapping, so they survive moving the map
+    const auto it = mm.find(10);
+    mapped_vmap<int, double> moved(std::move(mm));
+    ASSERT_EQ(it->second, 5);
+    ASSERT_EQ(moved.find(10), it);
+    ASSERT_EQ(moved.size(), m.size());
+    ASSERT_TRUE(mm.empty());
+    ASSERT_EQ(mm.find(10), mm.end());
+    mm = std::move(moved);
+    ASSERT_EQ(mm.at(1998), 999);
+}
+
+TEST_F(Test_serialize, mapped_vset)
+{
+    vset<int> s;
+    for (int i = 0; i < 500; ++i)
+        s.insert(i * 5);
+    save_binary(m_path, s, 8);
+
+    mapped_vset<int> ms(m_path);
+    ASSERT_TRUE(std::equal(ms.begin(), ms.end(), s.begin(), s.end()));
+    for (int k = -1; k < 2501; ++k)
+        ASSERT_EQ(ms.lower_bound(k) - ms.begin(), s.lower_bound(k) - s.begin());
+    ASSERT_EQ(*ms.find(25), 25);
+    ASSERT_EQ(ms.find(26), ms.end());
+
+    mapped_vset<int> moved(std::move(ms));
+    ASSERT_EQ(*moved.find(25), 25);
+    ASSERT_TRUE(ms.empty());
+
+    save_binary(m_path, vset<int>());
+    mapped_vset<int> empty(m_path);
+    ASSERT_TRUE(empty.empty());
+    ASSERT_EQ(empty.find(1), empty.end());
+}
@@ -0,0 +1,138 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/sharded_vmap.hpp>
+
+using namespace ltc;
+
+class Test_sharded_vmap : public ::testing::Test
+{
+protected:
+    // Orders ascending when default constructed, so a shard that ignores the map's
+    // comparator shows up as out of order
+    struct directed_less
+    {
+        bool descending = false;
+        bool operator()(int a, int b) const { return descending ? b < a : a < b; }
+    };
+};
+
+TEST_F(Test_sharded_vmap, default_construct)
+{
+    sharded_vmap<int, int, 8> m;
+    ASSERT_EQ(m.size(), 0);
+    ASSERT_TRUE(m.empty());
+    ASSERT_EQ(m.shard_count(), 8);
+}
+
+TEST_F(Test_sharded_vmap, insert_find_erase)
+{
+    sharded_vmap<std::string, int, 4> m;
+    ASSERT_TRUE(m.insert(std::make_pair("one", 1)));
+    ASSERT_FALSE(m.insert(std::make_pair("one", 2)));
+    ASSERT_TRUE(m.insert_or_assign("two", 2));
+    ASSERT_FALSE(m.insert_or_assign("two", 22));
+    ASSERT_EQ(m.size(), 2);
+
+    int value = 0;
+    ASSERT_TRUE(m.find("one", value));
+    ASSERT_EQ(value, 1);
+    ASSERT_TRUE(m.find("two", value));
+    ASSERT_EQ(value, 22);
+    ASSERT_FALSE(m.find("three", value));
+
+    ASSERT_TRUE(m.visit("one", [](int &v) { v = 11; }));
+    ASSERT_TRUE(m.find("one", value));
+    ASSERT_EQ(value, 11);
+
+    ASSERT_EQ(m.erase("one"), 1);
+    ASSERT_EQ(m.erase("one"), 0);
+    ASSERT_FALSE(m.contains("one"));
+    ASSERT_TRUE(m.contains("two"));
+
+    m.clear();
+    ASSERT_TRUE(m.empty());
+}
+
+TEST_F(Test_sharded_vmap, batched)
+{
+    sharded_vmap<int, int, 8> m;
+    std::vector<std::pair<int, int>> values;
+    for (int i = 0; i < 100; ++i)
+        values.emplace_back(i, i * 10);
+    ASSERT_EQ(m.insert(values.begin(), values.end()), 100);
+    ASSERT_EQ(m.insert(values.begin(), values.end()), 0);
+
+    std::vector<int> keys = { 5, 50, 500 };
+    std::vector<std::pair<int, int>> found;
+    m.find_many(keys.begin(), keys.end(), std::back_inserter(found));
+    ASSERT_EQ(found.size(), 2);
+
+    ASSERT_EQ(m.erase(keys.begin(), keys.end()), 2);
+    ASSERT_EQ(m.size(), 98);
+}
+
+TEST_F(Test_sharded_vmap, ordered_for_each)
+{
+    sharded_vmap<int, int, 16> m;
+    for (int i = 999; i >= 0; --i)
+        m.insert(std::make_pair(i, i));
+
+    int expected = 0;
+    m.for_each([&](const std::pair<int, int> &v) {
+        ASSERT_EQ(v.first, expected);
+        ++expected;
+    });
+    ASSERT_EQ(expected, 1000);
+}
+
+TEST_F(Test_sharded_vmap, range_partition)
+{
+    using map_t = sharded_vmap<int, int, 4, range_partition<int>>;
+    map_t m(range_partition<int>({ 100, 200, 300 }));
+    ASSERT_EQ(m.shard_of(50), 0);
+    ASSERT_EQ(m.shard_of(100), 1);
+    ASSERT_EQ(m.shard_of(250), 2);
+    ASSERT_EQ(m.shard_of(1000), 3);
+
+    for (int i = 0; i < 400; ++i)
+        m.insert(std::make_pair(i, i));
+    int expected = 0;
+    m.for_each([&](const std::pair<int, int> &v) { ASSERT_EQ(v.first, expected++); });
+    ASSERT_EQ(expected, 400);
+}
+
+TEST_F(Test_sharded_vmap, concurrent_insert)
+{
+    sharded_vmap<int, int, 16> m;
+    const int threads = 8;
+    const int per_thread = 5000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&m, t]() {
+            for (int i = 0; i < per_thread; ++i)
+                m.insert(std::make_pair(t * per_thread + i, t));
+        });
+    }
+    for (auto &w : workers)
+        w.join();
+    ASSERT_EQ(m.size(), threads * per_thread);
+}
+
+TEST_F(Test_sharded_vmap, stateful_compare)
+{
+    using map_t = sharded_vmap<int, int, 4, hash_partition<int>, directed_less>;
+    map_t m(hash_partition<int>(), directed_less{ true });
+    for (int i = 0; i < 100; ++i)
+        m.insert(std::make_pair(i, i));
+    ASSERT_EQ(m.size(), 100);
+    ASSERT_TRUE(m.contains(42));
+
+    int expected = 99;
+    m.for_each([&](const std::pair<int, int> &v) { ASSERT_EQ(v.first, expected--); });
+    ASSERT_EQ(expected, -1);
+}
@@ -0,0 +1,87 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/slot_map.hpp>
+
+using namespace ltc;
+
+class Test_slot_map : public ::testing::Test
+{
+};
+
+TEST_F(Test_slot_map, insert_get_erase)
+{
+    slot_map<std::string> m;
+    ASSERT_FALSE(slot_handle());
+
+    const auto a = m.insert("a");
+    const auto b = m.emplace(3, 'b');
+    ASSERT_TRUE(a);
+    ASSERT_EQ(m.size(), 2);
+    ASSERT_EQ(m[a], "a");
+    ASSERT_EQ(*m.get(b), "bbb");
+
+    ASSERT_TRUE(m.erase(a));
+    ASSERT_FALSE(m.erase(a));
+    ASSERT_EQ(m.get(a), nullptr);
+    ASSERT_FALSE(m.contains(a));
+    ASSERT_EQ(m.size(), 1);
+
+    // The slot is reused under a new generation, so the old handle stays stale
+    const auto c = m.insert("c");
+    ASSERT_EQ(c.index, a.index);
+    ASSERT_NE(c, a);
+    ASSERT_EQ(m.get(a), nullptr);
+    ASSERT_EQ(m[c], "c");
+}
+
+TEST_F(Test_slot_map, references_are_stable)
+{
+    slot_map<int> m;
+    const auto first = m.insert(42);
+    const int *p = m.get(first);
+    std::vector<slot_handle> handles;
+    for (int i = 0; i < 10000; ++i)
+        handles.push_back(m.insert(i));
+    for (int i = 0; i < 10000; i += 2)
+        m.erase(handles[i]);
+
+    ASSERT_EQ(m.get(first), p);
+    ASSERT_EQ(*p, 42);
+    ASSERT_EQ(m.size(), 5001);
+    ASSERT_GE(m.capacity(), m.size());
+
+    int sum = 0;
+    m.for_each([&](slot_handle, int v) { sum += v == 42 ? 0 : 1; });
+    ASSERT_EQ(sum, 5000);
+}
+
+TEST_F(Test_slot_map, copy_clear_and_destroy)
+{
+    auto value = std::make_shared<int>(1);
+    {
+        slot_map<std::shared_ptr<int>> m;
+        const auto a = m.insert(value);
+        const auto b = m.insert(value);
+        m.erase(b);
+        ASSERT_EQ(value.use_count(), 2);
+
+        auto copy = m;
+        ASSERT_EQ(value.use_count(), 3);
+        ASSERT_EQ(copy[a], value);
+        ASSERT_FALSE(copy.contains(b));
+
+        copy.clear();
+        ASSERT_TRUE(copy.empty());
+        ASSERT_FALSE(copy.contains(a));
+        ASSERT_EQ(value.use_count(), 2);
+
+        auto moved = std::move(m);
+        ASSERT_TRUE(m.empty());
+        ASSERT_EQ(moved[a], value);
+    }
+    ASSERT_EQ(value.use_count(), 1);
+}
@@ -0,0 +1,93 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/stable_vmap.hpp>
+
+using namespace ltc;
+
+class Test_stable_vmap : public ::testing::Test
+{
+};
+
+TEST_F(Test_stable_vmap, handles_survive_other_keys)
+{
+    stable_vmap<int, std::string> m;
+    const auto h = m.insert(500, "five hundred").first;
+    std::string &ref = *m.get(h);
+
+    for (int i = 0; i < 1000; ++i)
+        if (i != 500) m.insert(i, std::to_string(i));
+    for (int i = 0; i < 1000; i += 3)
+        if (i != 500) m.erase(i);
+
+    ASSERT_EQ(m.get(h), &ref);
+    ASSERT_EQ(ref, "five hundred");
+    ASSERT_EQ(*m.key_of(h), 500);
+    ASSERT_EQ(m.find(500), h);
+    ASSERT_EQ(m.at(1), "1");
+    ASSERT_THROW(m.at(3), std::out_of_range);
+}
+
+TEST_F(Test_stable_vmap, insert_and_erase)
+{
+    stable_vmap<std::string, int> m;
+    const auto r = m.insert("b", 2);
+    ASSERT_TRUE(r.second);
+    ASSERT_FALSE(m.insert("b", 3).second);
+    ASSERT_EQ(*m.get(r.first), 2);
+
+    ASSERT_EQ(m.insert_or_assign("b", 4), r.first);
+    ASSERT_EQ(*m.get(r.first), 4);
+    m["a"] = 1;
+    m["c"] = 3;
+
+    std::vector<std::string> keys;
+    m.for_each([&](const std::string &k, int &v) {
+        keys.push_back(k);
+        ++v;
+    });
+    ASSERT_EQ(keys, (std::vector<std::string>{ "a", "b", "c" }));
+    ASSERT_EQ(m.at("a"), 2);
+    ASSERT_EQ(m.index().size(), 3);
+
+    ASSERT_TRUE(m.erase(r.first));
+    ASSERT_FALSE(m.erase(r.first));
+    ASSERT_FALSE(m.valid(r.first));
+    ASSERT_EQ(m.get(r.first), nullptr);
+    ASSERT_FALSE(m.contains("b"));
+    ASSERT_FALSE(m.find("b"));
+    ASSERT_EQ(m.erase("c"), 1);
+    ASSERT_EQ(m.size(), 1);
+
+    m.clear();
+    ASSERT_TRUE(m.empty());
+}
+
+TEST_F(Test_stable_vmap, erase_by_handle_after_shifts)
+{
+    stable_vmap<std::string, int> m;
+    std::vector<stable_vmap<std::string, int>::handle> handles;
+    for (int i = 0; i < 200; ++i)
+        handles.push_back(m.insert(std::to_string((i * 37) % 200), i).first);
+
+    // Every other handle, so each erase shifts the keys after it
+    for (size_t i = 0; i < handles.size(); i += 2)
+        ASSERT_TRUE(m.erase(handles[i]));
+    ASSERT_EQ(m.size(), 100);
+    for (size_t i = 0; i < handles.size(); ++i)
+    {
+        if (i % 2 == 0)
+        {
+            ASSERT_EQ(m.key_of(handles[i]), nullptr);
+            continue;
+        }
+        const auto key = std::to_string((i * 37) % 200);
+        ASSERT_EQ(*m.key_of(handles[i]), key);
+        ASSERT_EQ(m.find(key), handles[i]);
+        ASSERT_EQ(*m.get(handles[i]), static_cast<int>(i));
+    }
+    ASSERT_TRUE(m.erase(handles[1]));
+    ASSERT_FALSE(m.contains(std::to_string(37)));
+}
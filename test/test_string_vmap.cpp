@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/string_vmap.hpp>
+
+using namespace ltc;
+
+class Test_string_vmap : public ::testing::Test
+{
+protected:
+    // Path-like keys that share long prefixes, some of them prefixes of others
+    static std::vector<std::string> paths(size_t n, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < n; ++i)
+        {
+            std::string key = "https://example.com/";
+            const auto depth = rng() % 5;
+            for (unsigned d = 0; d < depth; ++d)
+                key += "dir" + std::to_string(rng() % 7) + "/";
+            if (rng() % 2) key += "file" + std::to_string(rng() % 100);
+            if (rng() % 8 == 0) key += "\xe9"; // a byte above 0x7f
+            keys.push_back(key);
+        }
+        keys.push_back("");
+        return keys;
+    }
+
+    template <class T, size_t R>
+    static void check(const string_vmap<T, R> &m, const std::map<std::string, T> &expected)
+    {
+        ASSERT_EQ(m.size(), expected.size());
+        ASSERT_TRUE((std::equal(m.begin(), m.end(), expected.begin(), expected.end(),
+                                [](const auto &a, const auto &b) {
+                                    return a.first == b.first && a.second == b.second;
+                                })));
+    }
+};
+
+TEST_F(Test_string_vmap, construct_and_find)
+{
+    const auto keys = paths(5000, 1);
+    std::map<std::string, int> expected;
+    std::vector<std::pair<std::string, int>> values;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        expected.emplace(keys[i], int(i));
+        values.emplace_back(keys[i], int(i));
+    }
+    const string_vmap<int> m(values.begin(), values.end());
+    check(m, expected);
+
+    for (const auto &e : expected)
+    {
+        ASSERT_TRUE(m.contains(e.first));
+        ASSERT_EQ(m.at(e.first), e.second);
+        ASSERT_EQ(m.find(e.first)->first, e.first);
+        // Probes between keys land where std::map puts them
+        for (const auto &probe : { e.first + "!", e.first + "\xff", e.first.substr(0, 25) })
+        {
+            const auto it = m.lower_bound(probe);
+            const auto exp = expected.lower_bound(probe);
+            if (exp == expected.end())
+                ASSERT_EQ(it, m.end());
+            else
+                ASSERT_EQ(it->first, exp->first);
+        }
+    }
+    ASSERT_FALSE(m.contains("https://example.com/nowhere"));
+    ASSERT_EQ(m.find("zzz"), m.end());
+    ASSERT_THROW(m.at("missing"), std::out_of_range);
+    ASSERT_LT(m.key_bytes(), expected.size() * sizeof(std::string));
+}
+
+TEST_F(Test_string_vmap, insert_and_erase)
+{
+    std::mt19937 rng(3);
+    auto keys = paths(3000, 2);
+    string_vmap<int, 4> m;
+    std::map<std::string, int> expected;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const auto r = m.insert(keys[i], int(i));
+        const auto e = expected.emplace(keys[i], int(i));
+        ASSERT_EQ(r.second, e.second);
+        ASSERT_EQ(r.first->first, keys[i]);
+    }
+    check(m, expected);
+
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (size_t i = 0; i < keys.size(); i += 2)
+        ASSERT_EQ(m.erase(keys[i]), expected.erase(keys[i]));
+    check(m, expected);
+
+    m["new/key"] = 1;
+    m.insert_or_assign("new/key", 2);
+    expected["new/key"] = 2;
+    check(m, expected);
+
+    for (const auto &k : keys)
+        m.erase(k);
+    m.erase("new/key");
+    ASSERT_TRUE(m.empty());
+    ASSERT_EQ(m.begin(), m.end());
+    m["again"] = 3;
+    ASSERT_EQ(m.at("again"), 3);
+}
+
+TEST_F(Test_string_vmap, initializer_list)
+{
+    string_vmap<int> m = { { "b", 2 }, { "a", 1 }, { "b", 3 }, { "ab", 4 } };
+    ASSERT_EQ(m.size(), 3u);
+    ASSERT_EQ(m.at("b"), 2); // the first duplicate wins
+    auto it = m.begin();
+    ASSERT_EQ(it->first, "a");
+    ASSERT_EQ((++it)->first, "ab");
+    it->second = 5;
+    ASSERT_EQ(m.at("ab"), 5);
+#if __cplusplus >= 201703L
+    ASSERT_TRUE(m.contains(std::string_view("ab")));
+#endif
+}
+
+TEST_F(Test_string_vmap, vset)
+{
+    const auto keys = paths(2000, 4);
+    const std::set<std::string> expected(keys.begin(), keys.end());
+    string_vset<8> s(keys.begin(), keys.end());
+    ASSERT_TRUE((std::equal(s.begin(), s.end(), expected.begin(), expected.end())));
+    for (const auto &k : expected)
+        ASSERT_EQ(*s.find(k), k);
+
+    ASSERT_FALSE(s.insert(*expected.begin()).second);
+    ASSERT_TRUE(s.insert("~").second);
+    ASSERT_EQ(s.erase("~"), 1u);
+    ASSERT_EQ(s.erase("~"), 0u);
+    ASSERT_EQ(s.size(), expected.size());
+}
@@ -0,0 +1,82 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/thread_pool.hpp>
+
+using namespace ltc;
+
+class Test_thread_pool : public ::testing::Test
+{
+};
+
+TEST_F(Test_thread_pool, size)
+{
+    thread_pool pool(3);
+    ASSERT_EQ(pool.size(), 3u);
+    ASSERT_EQ(pool.worker_index(), 3u);
+    ASSERT_GE(thread_pool::instance().size(), 1u);
+    ASSERT_EQ(thread_pool(0).size(), 1u);
+}
+
+TEST_F(Test_thread_pool, task_group)
+{
+    thread_pool pool(4);
+    std::atomic<int> sum{ 0 };
+    task_group group(pool);
+    for (int i = 1; i <= 1000; ++i)
+        group.run([&sum, i]() { sum += i; });
+    group.wait();
+    ASSERT_EQ(sum.load(), 500500);
+}
+
+TEST_F(Test_thread_pool, nested)
+{
+    // Waiting inside a task runs other tasks, so nesting deeper than the pool is wide is fine
+    thread_pool pool(2);
+    std::atomic<int> leaves{ 0 };
+    task_group outer(pool);
+    for (int i = 0; i < 8; ++i)
+    {
+        outer.run([&pool, &leaves]() {
+            task_group inner(pool);
+            for (int j = 0; j < 8; ++j)
+                inner.run([&leaves]() { ++leaves; });
+            inner.wait();
+        });
+    }
+    outer.wait();
+    ASSERT_EQ(leaves.load(), 64);
+}
+
+TEST_F(Test_thread_pool, exception)
+{
+    thread_pool pool(2);
+    task_group group(pool);
+    std::atomic<int> ran{ 0 };
+    for (int i = 0; i < 10; ++i)
+    {
+        group.run([&ran, i]() {
+            ++ran;
+            if (i == 5) throw std::runtime_error("task");
+        });
+    }
+    ASSERT_THROW(group.wait(), std::runtime_error);
+    ASSERT_EQ(ran.load(), 10);
+    group.wait();
+}
+
+TEST_F(Test_thread_pool, worker_index)
+{
+    thread_pool pool(2);
+    std::vector<size_t> seen(100, pool.size());
+    task_group group(pool);
+    for (size_t i = 0; i < seen.size(); ++i)
+        group.run([&pool, &seen, i]() { seen[i] = pool.worker_index(); });
+    group.wait();
+    // The waiting thread runs tasks too, and reports size()
+    for (auto index : seen)
+        ASSERT_LE(index, pool.size());
+}
@@ -1,6 +1,8 @@
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -133,6 +135,45 @@ TEST_F(Test_vmap, get_allocator)
     ASSERT_EQ(m.get_allocator(), alloc);
 }
 
+// An allocator that carries an id, so tests can tell which instance a container uses
+template <class T> struct tagged_allocator : std::allocator<T>
+{
+    template <class U> struct rebind
+    {
+        using other = tagged_allocator<U>;
+    };
+
+    explicit tagged_allocator(int tag = 0) : tag(tag) {}
+    template <class U> tagged_allocator(const tagged_allocator<U> &o) : tag(o.tag) {}
+
+    int tag;
+};
+
+template <class T, class U>
+bool operator==(const tagged_allocator<T> &a, const tagged_allocator<U> &b)
+{
+    return a.tag == b.tag;
+}
+
+template <class T, class U>
+bool operator!=(const tagged_allocator<T> &a, const tagged_allocator<U> &b)
+{
+    return a.tag != b.tag;
+}
+
+TEST_F(Test_vmap, bulk_insert_keeps_allocator)
+{
+    using alloc_t = tagged_allocator<std::pair<int, int>>;
+    vmap<int, int, std::less<int>, alloc_t> m{ alloc_t(7) };
+    m.insert({ { 1, 1 }, { 2, 2 } });
+    std::vector<std::pair<int, int>> values;
+    for (int i = 0; i < 100; ++i)
+        values.emplace_back(i, i);
+    m.insert(values.begin(), values.end());
+    ASSERT_EQ(m.size(), 100);
+    ASSERT_EQ(m.get_allocator().tag, 7);
+}
+
 TEST_F(Test_vmap, at)
 {
     vmap<std::string, int> m;
@@ -239,6 +280,25 @@ TEST_F(Test_vmap, insert_initializer_list)
     ASSERT_EQ(m.size(), 9);
 }
 
+TEST_F(Test_vmap, insert_range_merges)
+{
+    vmap<int, int> m = { { 5, 50 }, { 1, 10 } };
+    std::vector<std::pair<int, int>> values;
+    for (int i = 1000; i > 0; --i)
+        values.emplace_back(i % 300, -i);
+    m.insert(values.begin(), values.end());
+    ASSERT_EQ(m.size(), 300);
+    ASSERT_TRUE(std::is_sorted(m.begin(), m.end()));
+    // Keys already present keep their value, new keys take the first inserted
+    ASSERT_EQ(m.at(5), 50);
+    ASSERT_EQ(m.at(1), 10);
+    ASSERT_EQ(m.at(0), -900);
+
+    m = { { 3, 3 }, { 1, 1 }, { 2, 2 }, { 1, 4 } };
+    ASSERT_EQ(m.size(), 3);
+    ASSERT_EQ(m.begin()->first, 1);
+}
+
 TEST_F(Test_vmap, erase)
 {
     using map_t = vmap<std::string, int>;
@@ -255,6 +315,154 @@ TEST_F(Test_vmap, erase)
     ASSERT_EQ(m.size(), 4);
 }
 
+TEST_F(Test_vmap, erase_deferred)
+{
+    using map_t = vmap<int, int>;
+    map_t m;
+    for (int i = 0; i < 100; ++i)
+        m[i] = i;
+    m.set_erase_mode(erase_mode::deferred);
+    m.max_tombstone_ratio(0.5);
+
+    for (int i = 0; i < 40; i += 2)
+        ASSERT_EQ(m.erase(i), 1);
+    ASSERT_EQ(m.erase(0), 0);
+    ASSERT_EQ(m.tombstone_count(), 20);
+    ASSERT_EQ(m.size(), 80);
+    ASSERT_FALSE(m.contains(0));
+    ASSERT_TRUE(m.contains(1));
+    ASSERT_EQ(m.count(2), 0);
+    ASSERT_THROW(m.at(2), std::out_of_range);
+
+    m[4] = 44;
+    ASSERT_EQ(m.at(4), 44);
+    ASSERT_EQ(m.tombstone_count(), 19);
+
+    int n = 0;
+    for (const auto &kv : m)
+    {
+        ASSERT_TRUE(kv.first % 2 == 1 || kv.first >= 40 || kv.first == 4);
+        ++n;
+    }
+    ASSERT_EQ(n, 81);
+    ASSERT_EQ(std::distance(m.begin(), m.end()), 81);
+    ASSERT_EQ(m.begin()->first, 1);
+    ASSERT_EQ(std::prev(m.end(), 81)->first, 1);
+    ASSERT_EQ(m.find(2), m.end());
+    ASSERT_EQ(m.lower_bound(2)->first, 3);
+    ASSERT_EQ(m.upper_bound(3)->first, 4);
+    ASSERT_EQ(m.tombstone_count(), 19);
+    m.compact();
+    ASSERT_EQ(m.tombstone_count(), 0);
+
+    m.max_tombstone_ratio(0.25);
+    for (int i = 41; i < 100; i += 2)
+        m.erase(i);
+    ASSERT_EQ(m.tombstone_count(), 9);
+    ASSERT_EQ(m.size(), 51);
+}
+
+TEST_F(Test_vmap, erase_deferred_lookups)
+{
+    using map_t = vmap<int, int>;
+    map_t m;
+    for (int i = 0; i < 10; ++i)
+        m[i * 10] = i;
+    m.set_erase_mode(erase_mode::deferred);
+    m.max_tombstone_ratio(1.0);
+    m.erase(0);
+    m.erase(40);
+    m.erase(90);
+
+    // Lookups and iteration skip the erased elements without compacting
+    const map_t &cm = m;
+    ASSERT_EQ(cm.begin()->first, 10);
+    ASSERT_EQ(std::prev(cm.end())->first, 80);
+    ASSERT_EQ(cm.rbegin()->first, 80);
+    ASSERT_EQ(cm.find(40), cm.end());
+    ASSERT_EQ(cm.lower_bound(35)->first, 50);
+    ASSERT_EQ(cm.equal_range(40).first, cm.equal_range(40).second);
+    ASSERT_EQ(cm.end() - cm.begin(), 7);
+    ASSERT_EQ(cm.begin() + 3, cm.find(50));
+    ASSERT_EQ(cm.rank(50), 3u);
+    ASSERT_EQ(cm.select(3)->first, 50);
+    ASSERT_EQ(cm.count_range(0, 100), 7u);
+    ASSERT_EQ(m.tombstone_count(), 3u);
+
+    // Inserts keep the tombstones in step and revive an erased key
+    ASSERT_TRUE(m.insert({ 45, 1 }).second);
+    ASSERT_TRUE(m.insert({ 40, 2 }).second);
+    ASSERT_FALSE(m.insert({ 40, 3 }).second);
+    ASSERT_EQ(m.at(40), 2);
+    ASSERT_EQ(m.tombstone_count(), 2u);
+    std::vector<int> keys;
+    for (const auto &kv : m)
+        keys.push_back(kv.first);
+    ASSERT_EQ(keys, (std::vector<int>{ 10, 20, 30, 40, 45, 50, 60, 70, 80 }));
+
+    // Assignment carries the erase policy along
+    map_t copy;
+    copy = m;
+    ASSERT_EQ(copy.get_erase_mode(), erase_mode::deferred);
+    ASSERT_EQ(copy.max_tombstone_ratio(), 1.0);
+    ASSERT_EQ(copy.size(), 9u);
+
+    const std::vector<map_t::value_type> more{ { 90, 9 }, { 0, 0 }, { 95, 1 }, { 10, 5 } };
+    m.insert(more.begin(), more.end());
+    ASSERT_EQ(m.tombstone_count(), 0u);
+    ASSERT_EQ(m.size(), 12u);
+    ASSERT_EQ(m.at(90), 9);
+    ASSERT_EQ(m.at(10), 1);
+}
+
+TEST_F(Test_vmap, erase_if)
+{
+    using map_t = vmap<int, int>;
+    map_t m;
+    for (int i = 0; i < 100; ++i)
+        m[i] = i;
+    m.set_erase_mode(erase_mode::deferred);
+    m.erase(1);
+    ASSERT_EQ(m.erase_if([](const map_t::value_type &kv) { return kv.first % 3 == 0; }), 34);
+    ASSERT_EQ(m.size(), 65);
+    ASSERT_EQ(m.tombstone_count(), 0);
+    ASSERT_FALSE(m.contains(1));
+    ASSERT_FALSE(m.contains(99));
+    ASSERT_TRUE(m.contains(98));
+}
+
+TEST_F(Test_vmap, extract_adopt_sorted)
+{
+    using map_t = vmap<std::string, int>;
+    map_t m = { { "3", 3 }, { "2", 2 }, { "1", 1 } };
+    auto storage = m.extract();
+    ASSERT_TRUE(m.empty());
+    ASSERT_EQ(storage.size(), 3);
+    ASSERT_EQ(storage.front().first, "1");
+
+    const auto *data = storage.data();
+    m.adopt_sorted(std::move(storage));
+    ASSERT_EQ(m.size(), 3);
+    ASSERT_EQ(&*m.begin(), data);
+    ASSERT_EQ(m.at("2"), 2);
+}
+
+TEST_F(Test_vmap, sorted_unique_construct)
+{
+    using map_t = vmap<int, int>;
+    map_t::storage_type sorted = { { 1, 1 }, { 2, 2 }, { 5, 5 } };
+    const auto *data = sorted.data();
+    map_t m(sorted_unique, std::move(sorted));
+    ASSERT_EQ(m.size(), 3);
+    ASSERT_EQ(&*m.begin(), data);
+    ASSERT_EQ(m.at(5), 5);
+
+    std::vector<std::pair<int, int>> v = { { 1, 10 }, { 3, 30 } };
+    map_t m2(sorted_unique, v.begin(), v.end());
+    ASSERT_EQ(m2.size(), 2);
+    ASSERT_EQ(m2.at(3), 30);
+}
+
 TEST_F(Test_vmap, swap)
 {
     using map_t = vmap<std::string, int>;
@@ -286,6 +494,144 @@ TEST_F(Test_vmap, contains)
     ASSERT_FALSE(m.contains("4"));
 }
 
+TEST_F(Test_vmap, find_many)
+{
+    using map_t = vmap<int, int>;
+    map_t m;
+    for (int i = 0; i < 1000; i += 2)
+        m[i] = i * 10;
+    m.set_erase_mode(erase_mode::deferred);
+    m.max_tombstone_ratio(1.0);
+    m.erase(40);
+
+    const std::vector<int> probes{ 998, 3, 40, 0, 500, 1001, 500, 42 };
+    std::vector<map_t::value_type> found;
+    m.find_many(probes.begin(), probes.end(), std::back_inserter(found));
+    const std::vector<map_t::value_type> expected{
+        { 0, 0 }, { 42, 420 }, { 500, 5000 }, { 998, 9980 }
+    };
+    ASSERT_EQ(found, expected);
+    ASSERT_EQ(m.tombstone_count(), 1u);
+
+    std::vector<int> sorted_probes{ 0, 40, 42, 500, 500, 998, 1001 };
+    found.clear();
+    m.find_many(presorted, sorted_probes.begin(), sorted_probes.end(), std::back_inserter(found));
+    ASSERT_EQ(found.size(), 5u);
+
+    std::vector<int> none;
+    found.clear();
+    m.find_many(none.begin(), none.end(), std::back_inserter(found));
+    ASSERT_TRUE(found.empty());
+}
+
+TEST_F(Test_vmap, contains_many)
+{
+    using map_t = vmap<std::string, int>;
+    map_t m = { { "3", 3 }, { "2", 2 }, { "1", 1 } };
+    const std::vector<std::string> probes{ "4", "2", "0", "3", "2" };
+    std::vector<bool> result;
+    m.contains_many(probes.begin(), probes.end(), std::back_inserter(result));
+    ASSERT_EQ(result, (std::vector<bool>{ false, true, false, true, true }));
+
+    const std::vector<std::string> sorted_probes{ "0", "1", "3", "9" };
+    result.clear();
+    m.contains_many(presorted, sorted_probes.begin(), sorted_probes.end(),
+                    std::back_inserter(result));
+    ASSERT_EQ(result, (std::vector<bool>{ false, true, true, false }));
+}
+
+TEST_F(Test_vmap, range)
+{
+    using map_t = vmap<int, std::string>;
+    map_t m;
+    for (int i = 0; i < 100; i += 10)
+        m[i] = std::to_string(i);
+
+    auto r = m.range(20, 50);
+    ASSERT_EQ(r.size(), 3u);
+    ASSERT_EQ(r.front().first, 20);
+    ASSERT_EQ(r.back().first, 40);
+    ASSERT_EQ(r.data(), &*m.find(20));
+    r[0].second = "twenty";
+    ASSERT_EQ(m.at(20), "twenty");
+
+    const map_t &cm = m;
+    ASSERT_EQ(cm.range(20, 50, bounds::closed).size(), 4u);
+    ASSERT_EQ(cm.range(20, 50, bounds::open).size(), 2u);
+    ASSERT_EQ(cm.range(20, 50, bounds::left_open).front().first, 30);
+    ASSERT_TRUE(cm.range(21, 29).empty());
+    ASSERT_TRUE(cm.range(50, 20, bounds::closed).empty());
+    ASSERT_EQ(cm.range(-5, 1000).size(), m.size());
+
+    // The view is of the storage, so deferred erases are compacted before it is taken
+    m.set_erase_mode(erase_mode::deferred);
+    m.max_tombstone_ratio(1.0);
+    m.erase(30);
+    m.compact();
+    ASSERT_EQ(m.range(20, 50).size(), 2u);
+}
+
+TEST_F(Test_vmap, order_statistics)
+{
+    vmap<int, int> m;
+    for (int i = 0; i < 100; i += 10)
+        m[i] = i;
+    ASSERT_EQ(m.rank(0), 0u);
+    ASSERT_EQ(m.rank(35), 4u);
+    ASSERT_EQ(m.rank(40), 4u);
+    ASSERT_EQ(m.rank(1000), 10u);
+    ASSERT_EQ(m.select(4)->first, 40);
+    ASSERT_EQ(m.select(10), m.end());
+    ASSERT_EQ(m.nth_key(9), 90);
+    ASSERT_THROW(m.nth_key(10), std::out_of_range);
+    ASSERT_EQ(m.count_range(10, 40), 3u);
+    ASSERT_EQ(m.count_range(10, 40, bounds::closed), 4u);
+    ASSERT_EQ(m.count_range(40, 10), 0u);
+
+    m.set_erase_mode(erase_mode::deferred);
+    m.max_tombstone_ratio(1.0);
+    m.erase(20);
+    ASSERT_EQ(m.rank(35), 3u);
+    ASSERT_EQ(m.nth_key(2), 30);
+}
+
+TEST_F(Test_vmap, stats)
+{
+    using pair_t = std::pair<int, int>;
+    vmap<int, int, std::less<int>, std::allocator<pair_t>, counting_stats> m;
+    for (int i = 10; i > 0; --i)
+        m.insert(pair_t(i, i));
+
+    auto s = m.snapshot();
+    ASSERT_EQ(s.inserts, 10);
+    ASSERT_EQ(s.moved, 45); // each insert shifts every larger key: 0 + 1 + ... + 9
+    ASSERT_EQ(s.searches, 10);
+    ASSERT_GT(s.reallocations, 0);
+
+    ASSERT_NE(m.find(5), m.end());
+    ASSERT_FALSE(m.contains(42));
+    ASSERT_EQ(m.at(1), 1);
+    s = m.snapshot();
+    ASSERT_EQ(s.finds, 3);
+    ASSERT_EQ(s.hits, 2);
+    ASSERT_EQ(s.misses, 1);
+    ASSERT_GT(s.comparisons_per_search(), 0.0);
+
+    m.erase(1);
+    s = m.snapshot();
+    ASSERT_EQ(s.erases, 1);
+    ASSERT_EQ(s.moved, 54);
+
+    std::vector<std::string> names;
+    s.for_each([&](const char *name, double) { names.push_back(name); });
+    ASSERT_EQ(names.front(), "finds");
+    ASSERT_EQ(names.back(), "estimated_fpp");
+
+    m.reset_stats();
+    ASSERT_EQ(m.snapshot().inserts, 0);
+    ASSERT_EQ((vmap<int, int>().snapshot().finds), 0);
+}
+
 TEST_F(Test_vmap, equal_range)
 {
     using map_t = vmap<std::string, int>;
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/vmultimap.hpp>
+
+using namespace ltc;
+
+class Test_vmultimap : public ::testing::Test
+{
+};
+
+TEST_F(Test_vmultimap, insert_keeps_order)
+{
+    vmultimap<int, std::string> m;
+    m.insert(std::make_pair(2, std::string("a")));
+    m.insert(std::make_pair(1, std::string("b")));
+    m.insert(std::make_pair(2, std::string("c")));
+    m.emplace(2, "d");
+    m.insert(std::make_pair(3, std::string("e")));
+
+    ASSERT_EQ(m.size(), 5);
+    ASSERT_EQ(m.count(2), 3);
+    ASSERT_EQ(m.count(4), 0);
+    ASSERT_EQ(m.find(2)->second, "a");
+    ASSERT_EQ(m.find(4), m.end());
+
+    const auto r = m.equal_range(2);
+    std::vector<std::string> values;
+    for (auto it = r.first; it != r.second; ++it)
+        values.push_back(it->second);
+    ASSERT_EQ(values, (std::vector<std::string>{ "a", "c", "d" }));
+}
+
+TEST_F(Test_vmultimap, construct_and_bulk_insert_are_stable)
+{
+    vmultimap<int, int> m{ { 1, 0 }, { 0, 1 }, { 1, 2 } };
+    m.insert({ { 1, 3 }, { 0, 4 }, { 2, 5 }, { 1, 6 } });
+
+    std::vector<std::pair<int, int>> expected{ { 0, 1 }, { 0, 4 }, { 1, 0 }, { 1, 2 },
+                                               { 1, 3 }, { 1, 6 }, { 2, 5 } };
+    ASSERT_TRUE(std::equal(m.begin(), m.end(), expected.begin(), expected.end()));
+}
+
+TEST_F(Test_vmultimap, erase)
+{
+    vmultimap<int, int> m{ { 1, 1 }, { 2, 2 }, { 2, 3 }, { 3, 4 } };
+    ASSERT_EQ(m.erase(2), 2);
+    ASSERT_EQ(m.erase(2), 0);
+    ASSERT_EQ(m.size(), 2);
+
+    m.erase(m.begin());
+    ASSERT_EQ(m.begin()->first, 3);
+
+    m.insert({ { 5, 0 }, { 6, 1 }, { 7, 2 } });
+    ASSERT_EQ(m.erase_if([](const std::pair<int, int> &v) { return v.second % 2 == 0; }), 3);
+    ASSERT_EQ(m.size(), 1);
+    ASSERT_FALSE(m.contains(3));
+    ASSERT_TRUE(m.contains(6));
+}
+
+TEST_F(Test_vmultimap, random_against_multimap)
+{
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> key(0, 50);
+    vmultimap<int, int> m;
+    std::multimap<int, int> ref;
+    for (int i = 0; i < 2000; ++i)
+    {
+        const auto k = key(rng);
+        if (i % 5 == 4)
+        {
+            ASSERT_EQ(m.erase(k), ref.erase(k));
+        }
+        else
+        {
+            m.insert(std::make_pair(k, i));
+            ref.insert(std::make_pair(k, i));
+        }
+    }
+    ASSERT_EQ(m.size(), ref.size());
+    auto it = ref.begin();
+    for (const auto &v : m)
+    {
+        ASSERT_EQ(v.first, it->first);
+        ASSERT_EQ(v.second, it->second);
+        ++it;
+    }
+    ASSERT_EQ(m.lower_bound(25)->first, ref.lower_bound(25)->first);
+    ASSERT_EQ(m.upper_bound(25) - m.lower_bound(25), static_cast<long>(ref.count(25)));
+}
+
+TEST_F(Test_vmultimap, erase_deferred)
+{
+    vmultimap<int, int> m{ { 1, 0 }, { 2, 1 }, { 2, 2 }, { 2, 3 }, { 3, 4 } };
+    m.set_erase_mode(erase_mode::deferred);
+    m.max_tombstone_ratio(1.0);
+    m.erase(m.find(2));
+    ASSERT_EQ(m.count(2), 2);
+    ASSERT_EQ(m.find(2)->second, 2);
+
+    ASSERT_EQ(m.erase(2), 2);
+    ASSERT_EQ(m.tombstone_count(), 2);
+    ASSERT_EQ(m.erase(2), 0);
+    ASSERT_EQ(m.count(2), 0);
+    ASSERT_EQ(m.find(2), m.end());
+    ASSERT_EQ(m.size(), 2);
+
+    // New elements go after the tombstones of the run and keep their insertion order
+    m.insert(std::make_pair(2, 5));
+    m.emplace(2, 6);
+    ASSERT_EQ(m.count(2), 2);
+    std::vector<std::pair<int, int>> expected{ { 1, 0 }, { 2, 5 }, { 2, 6 }, { 3, 4 } };
+    ASSERT_TRUE(std::equal(m.begin(), m.end(), expected.begin(), expected.end()));
+    m.compact();
+    ASSERT_EQ(m.tombstone_count(), 0);
+    ASSERT_TRUE(std::equal(m.begin(), m.end(), expected.begin(), expected.end()));
+}
+
+TEST_F(Test_vmultimap, order_statistics_and_find_many)
+{
+    const vmultimap<int, int> m{ { 3, 0 }, { 1, 1 }, { 3, 2 }, { 5, 3 }, { 3, 4 }, { 7, 5 } };
+    ASSERT_EQ(m.rank(3), 1);
+    ASSERT_EQ(m.rank(4), 4);
+    ASSERT_EQ(m.select(3)->second, 4);
+    ASSERT_EQ(m.count_range(3, 5, bounds::closed), 4);
+
+    const auto r = m.range(3, 5);
+    ASSERT_EQ(r.size(), 3);
+    ASSERT_EQ(r.begin()->second, 0);
+
+    const std::vector<int> probes{ 7, 3, 4, 3 };
+    std::vector<std::pair<int, int>> found;
+    m.find_many(probes.begin(), probes.end(), std::back_inserter(found));
+    std::vector<std::pair<int, int>> expected{ { 3, 0 }, { 3, 2 }, { 3, 4 }, { 7, 5 } };
+    ASSERT_EQ(found, expected);
+
+    // Repeated presorted probes repeat the whole run
+    const std::vector<int> sorted_probes{ 3, 3 };
+    found.clear();
+    m.find_many(presorted, sorted_probes.begin(), sorted_probes.end(), std::back_inserter(found));
+    ASSERT_EQ(found.size(), 6);
+}
+
+TEST_F(Test_vmultimap, stats)
+{
+    vmultimap<int, int, std::less<int>, std::allocator<std::pair<int, int>>, counting_stats> m;
+    for (int i = 0; i < 10; ++i)
+        m.insert(std::make_pair(i % 2, i));
+    ASSERT_EQ(m.snapshot().inserts, 10);
+    ASSERT_EQ(m.erase(1), 5);
+    ASSERT_EQ(m.snapshot().erases, 5);
+}
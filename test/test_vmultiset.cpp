@@ -0,0 +1,78 @@
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ltc/vmultiset.hpp>
+
+using namespace ltc;
+
+class Test_vmultiset : public ::testing::Test
+{
+};
+
+TEST_F(Test_vmultiset, duplicates)
+{
+    vmultiset<int> s{ 3, 1, 2, 3, 1 };
+    s.insert(3);
+    s.insert({ 0, 2 });
+
+    ASSERT_EQ(s.size(), 8);
+    ASSERT_EQ(s.count(3), 3);
+    ASSERT_EQ(s.count(1), 2);
+    ASSERT_EQ(s.count(4), 0);
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()), (std::vector<int>{ 0, 1, 1, 2, 2, 3, 3, 3 }));
+
+    const auto r = s.equal_range(2);
+    ASSERT_EQ(r.second - r.first, 2);
+    ASSERT_EQ(*s.upper_bound(2), 3);
+
+    ASSERT_EQ(s.erase(3), 3);
+    ASSERT_FALSE(s.contains(3));
+    ASSERT_EQ(s.size(), 5);
+}
+
+TEST_F(Test_vmultiset, stable_among_equivalent)
+{
+    // Compares by length only, so the strings of one length are equivalent
+    const auto by_length = [](const std::string &a, const std::string &b) {
+        return a.size() < b.size();
+    };
+    vmultiset<std::string, decltype(by_length)> s({ "bb", "a", "cc" }, by_length);
+    s.insert("dd");
+    s.insert("e");
+    s.insert({ "ff", "g" });
+
+    ASSERT_EQ(std::vector<std::string>(s.begin(), s.end()),
+              (std::vector<std::string>{ "a", "e", "g", "bb", "cc", "dd", "ff" }));
+    ASSERT_EQ(*s.find("xx"), "bb");
+}
+
+TEST_F(Test_vmultiset, erase_deferred_and_lookups)
+{
+    vmultiset<int> s{ 5, 1, 3, 3, 3, 7 };
+    s.set_erase_mode(erase_mode::deferred);
+    s.max_tombstone_ratio(1.0);
+    ASSERT_EQ(s.erase(3), 3);
+    ASSERT_EQ(s.tombstone_count(), 3);
+    ASSERT_EQ(s.count(3), 0);
+    ASSERT_FALSE(s.contains(3));
+    ASSERT_EQ(s.rank(5), 1);
+
+    s.insert(3);
+    s.insert({ 3, 9, 9, 9, 0 });
+    ASSERT_EQ(s.count(3), 2);
+    ASSERT_EQ(s.count(9), 3);
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()),
+              (std::vector<int>{ 0, 1, 3, 3, 5, 7, 9, 9, 9 }));
+    ASSERT_EQ(s.tombstone_count(), 0);
+    ASSERT_EQ(s.count_range(3, 9), 4);
+    ASSERT_EQ(s.range(9, 10).size(), 3);
+    ASSERT_EQ(s.nth_key(3), 3);
+
+    const std::vector<int> probes{ 9, 4, 3 };
+    std::vector<int> found;
+    s.find_many(probes.begin(), probes.end(), std::back_inserter(found));
+    ASSERT_EQ(found, (std::vector<int>{ 3, 3, 9, 9, 9 }));
+}
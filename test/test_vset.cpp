@@ -1,6 +1,8 @@
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -112,9 +114,10 @@ TEST_F(Test_vset, assignment_move)
 
 TEST_F(Test_vset, assignment_initializer_list)
 {
-    vset<std::string, int> m;
-    m = { "3", "2", "1" };
+    vset<std::string> m;
+    m = { "3", "2", "1", "2" };
     ASSERT_EQ(m.size(), 3);
+    ASSERT_EQ(*m.begin(), "1");
 }
 
 TEST_F(Test_vset, get_allocator)
@@ -199,6 +202,19 @@ TEST_F(Test_vset, insert_initializer_list)
     ASSERT_EQ(m.size(), 9);
 }
 
+TEST_F(Test_vset, insert_range_merges)
+{
+    vset<int> m = { 5, 1, 5 };
+    ASSERT_EQ(m.size(), 2);
+    std::vector<int> keys;
+    for (int i = 1000; i > 0; --i)
+        keys.push_back(i % 300 - 100);
+    m.insert(keys.begin(), keys.end());
+    ASSERT_EQ(m.size(), 300);
+    ASSERT_TRUE(std::is_sorted(m.begin(), m.end()));
+    ASSERT_EQ(*m.begin(), -100);
+}
+
 TEST_F(Test_vset, erase)
 {
     using set_t = vset<std::string>;
@@ -215,6 +231,84 @@ TEST_F(Test_vset, erase)
     ASSERT_EQ(m.size(), 4);
 }
 
+TEST_F(Test_vset, erase_deferred)
+{
+    vset<int> s;
+    for (int i = 0; i < 100; ++i)
+        s.insert(i);
+    s.set_erase_mode(erase_mode::deferred);
+
+    for (int i = 0; i < 20; ++i)
+        ASSERT_EQ(s.erase(i * 5), 1);
+    ASSERT_EQ(s.erase(0), 0);
+    ASSERT_EQ(s.tombstone_count(), 20);
+    ASSERT_EQ(s.size(), 80);
+    ASSERT_FALSE(s.contains(5));
+    ASSERT_TRUE(s.contains(6));
+
+    // Lookups and iteration skip the erased elements without compacting
+    ASSERT_EQ(std::distance(s.begin(), s.end()), 80);
+    ASSERT_EQ(s.tombstone_count(), 20);
+    ASSERT_EQ(*s.find(6), 6);
+    ASSERT_EQ(s.find(5), s.end());
+    ASSERT_EQ(*s.begin(), 1);
+    ASSERT_EQ(*s.lower_bound(95), 96);
+    ASSERT_EQ(*s.rbegin(), 99);
+    ASSERT_EQ(s.rank(10), 8u);
+    ASSERT_EQ(*s.select(8), 11);
+    ASSERT_EQ(s.count_range(0, 10), 8u);
+
+    s.erase(6);
+    s.erase(7);
+    ASSERT_TRUE(s.insert(6).second);
+    ASSERT_FALSE(s.insert(6).second);
+    ASSERT_EQ(s.size(), 79);
+
+    vset<int> copy;
+    copy = s;
+    ASSERT_EQ(copy.get_erase_mode(), erase_mode::deferred);
+    const std::vector<int> more{ 5, 7, 100, 6 };
+    s.insert(more.begin(), more.end());
+    ASSERT_EQ(s.tombstone_count(), 0);
+    ASSERT_EQ(s.size(), 82);
+}
+
+TEST_F(Test_vset, erase_if)
+{
+    vset<int> s;
+    for (int i = 0; i < 100; ++i)
+        s.insert(i);
+    ASSERT_EQ(s.erase_if([](int i) { return i % 2 == 0; }), 50);
+    ASSERT_EQ(s.size(), 50);
+    ASSERT_EQ(*s.begin(), 1);
+}
+
+TEST_F(Test_vset, extract_adopt_sorted)
+{
+    vset<int> s = { 3, 1, 2 };
+    auto storage = s.extract();
+    ASSERT_TRUE(s.empty());
+    ASSERT_EQ(storage, std::vector<int>({ 1, 2, 3 }));
+
+    storage.push_back(7);
+    s.adopt_sorted(std::move(storage));
+    ASSERT_EQ(s.size(), 4);
+    ASSERT_TRUE(s.contains(7));
+}
+
+TEST_F(Test_vset, sorted_unique_construct)
+{
+    std::vector<int> sorted = { 1, 4, 9 };
+    const auto *data = sorted.data();
+    vset<int> s(sorted_unique, std::move(sorted));
+    ASSERT_EQ(s.size(), 3);
+    ASSERT_EQ(&*s.begin(), data);
+
+    vset<int> s2(sorted_unique, s.begin(), s.end());
+    ASSERT_EQ(s2.size(), 3);
+    ASSERT_TRUE(s2.contains(4));
+}
+
 TEST_F(Test_vset, swap)
 {
     using set_t = vset<std::string>;
@@ -246,6 +340,76 @@ TEST_F(Test_vset, contains)
     ASSERT_FALSE(m.contains("4"));
 }
 
+TEST_F(Test_vset, find_many)
+{
+    vset<int> s;
+    for (int i = 0; i < 1000; i += 3)
+        s.insert(i);
+    s.set_erase_mode(erase_mode::deferred);
+    s.max_tombstone_ratio(1.0);
+    s.erase(300);
+
+    const std::vector<int> probes{ 999, 1, 300, 0, 303, 303, 4 };
+    std::vector<int> found;
+    s.find_many(probes.begin(), probes.end(), std::back_inserter(found));
+    ASSERT_EQ(found, (std::vector<int>{ 0, 303, 999 }));
+
+    const std::vector<int> sorted_probes{ 0, 300, 301, 303, 999, 2000 };
+    std::vector<bool> result;
+    s.contains_many(presorted, sorted_probes.begin(), sorted_probes.end(),
+                    std::back_inserter(result));
+    ASSERT_EQ(result, (std::vector<bool>{ true, false, false, true, true, false }));
+}
+
+TEST_F(Test_vset, contains_many)
+{
+    const vset<std::string> s = { "3", "2", "1" };
+    const std::vector<std::string> probes{ "4", "2", "0", "3", "2" };
+    std::vector<bool> result;
+    s.contains_many(probes.begin(), probes.end(), std::back_inserter(result));
+    ASSERT_EQ(result, (std::vector<bool>{ false, true, false, true, true }));
+}
+
+TEST_F(Test_vset, range)
+{
+    const vset<int> s{ 1, 3, 5, 7, 9 };
+    const auto r = s.range(3, 7);
+    ASSERT_EQ(std::vector<int>(r.begin(), r.end()), (std::vector<int>{ 3, 5 }));
+    ASSERT_EQ(s.range(3, 7, bounds::closed).size(), 3u);
+    ASSERT_EQ(s.range(3, 7, bounds::open).size(), 1u);
+    ASSERT_EQ(s.range(2, 4, bounds::left_open)[0], 3);
+    ASSERT_TRUE(s.range(7, 3).empty());
+}
+
+TEST_F(Test_vset, order_statistics)
+{
+    const vset<int> s{ 9, 1, 5, 3, 7 };
+    ASSERT_EQ(s.rank(5), 2u);
+    ASSERT_EQ(s.rank(6), 3u);
+    ASSERT_EQ(*s.select(0), 1);
+    ASSERT_EQ(s.select(5), s.end());
+    ASSERT_EQ(s.nth_key(4), 9);
+    ASSERT_THROW(s.nth_key(5), std::out_of_range);
+    ASSERT_EQ(s.count_range(3, 9), 3u);
+    ASSERT_EQ(s.count_range(3, 9, bounds::open), 2u);
+}
+
+TEST_F(Test_vset, stats)
+{
+    vset<int, std::less<int>, std::allocator<int>, counting_stats> s{ 1, 2, 3, 4 };
+    s.insert(0);
+    s.insert(2);
+    s.erase(s.find(1));
+
+    const auto snap = s.snapshot();
+    ASSERT_EQ(snap.inserts, 1);
+    ASSERT_EQ(snap.erases, 1);
+    ASSERT_EQ(snap.moved, 4 + 3);
+    ASSERT_EQ(snap.finds, 1);
+    ASSERT_EQ(snap.hits, 1);
+    ASSERT_EQ(snap.searches, 3);
+}
+
 TEST_F(Test_vset, equal_range)
 {
     using set_t = vset<std::string>;